@@ -0,0 +1,205 @@
+"""
+Fleet analytics over a directory of exported runs
+Scans binary (.hsrun) and JSON exports in parallel, builds a mergeable
+log-bucketed histogram per metric for each run, and reports per-metric
+quantiles grouped by host manifest fields (CPU model, kernel, firmware)
+
+Usage:
+    python stress_tool.py analytics runs/ --group-by cpu_model,kernel
+"""
+
+import argparse
+import json
+import math
+import os
+import time
+from concurrent.futures import ThreadPoolExecutor
+
+import numpy as np
+from rich.console import Console
+from rich.table import Table
+
+from report import first_byte, load_json
+from runfile import MAGIC, RunFile
+
+DEFAULT_GROUP_BY = ('cpu_model', 'kernel', 'firmware')
+DEFAULT_QUANTILES = (0.5, 0.9, 0.99)
+
+# Relative-error histogram: bucket i > 0 holds values in
+# (SKETCH_MIN * GAMMA^(i-1), SKETCH_MIN * GAMMA^i]; bucket 0 holds values <= SKETCH_MIN
+SKETCH_GAMMA = 1.02
+SKETCH_MIN = 1e-3
+SKETCH_BUCKETS = 2048
+_LOG_GAMMA = math.log(SKETCH_GAMMA)
+
+
+class Sketch:
+    """Mergeable quantile sketch with ~1% relative error, plus exact count/sum/max"""
+
+    def __init__(self):
+        self.counts = np.zeros(SKETCH_BUCKETS, dtype=np.int64)
+        self.total = 0
+        self.sum = 0.0
+        self.max = -math.inf
+
+    def add(self, values):
+        values = values[np.isfinite(values)]
+        if not len(values):
+            return
+        index = np.zeros(len(values), dtype=np.int64)
+        positive = values > SKETCH_MIN
+        index[positive] = np.ceil(np.log(values[positive] / SKETCH_MIN) / _LOG_GAMMA)
+        self.counts += np.bincount(np.minimum(index, SKETCH_BUCKETS - 1), minlength=SKETCH_BUCKETS)
+        self.total += len(values)
+        self.sum += float(values.sum())
+        self.max = max(self.max, float(values.max()))
+
+    def merge(self, other):
+        self.counts += other.counts
+        self.total += other.total
+        self.sum += other.sum
+        self.max = max(self.max, other.max)
+
+    def quantile(self, q):
+        if not self.total:
+            return math.nan
+        bucket = int(np.searchsorted(np.cumsum(self.counts), q * self.total, side='left'))
+        if bucket == 0:
+            return 0.0
+        # Midpoint of the bucket in relative terms
+        return min(SKETCH_MIN * SKETCH_GAMMA ** bucket * 2 / (1 + SKETCH_GAMMA), self.max)
+
+    @property
+    def mean(self):
+        return self.sum / self.total if self.total else math.nan
+
+
+def _scan_bin(path, metrics):
+    with RunFile(path) as run:
+        wanted = [m for m in run.metrics if metrics is None or m in metrics]
+        sketches = {m: Sketch() for m in wanted}
+        for i in range(run.block_count):
+            _, columns = run.block(i)
+            for metric in wanted:
+                sketches[metric].add(columns[metric])
+            del columns
+        return run.manifest, sketches
+
+
+def _scan_json(path, metrics):
+    meta, chunks = load_json(path)
+    sketches = {}
+    for _, columns in chunks:
+        for metric, values in columns.items():
+            if metrics is None or metric in metrics:
+                sketches.setdefault(metric, Sketch()).add(values)
+    return meta.get('manifest') or {}, sketches
+
+
+def scan_run(path, metrics=None):
+    """
+    Per-metric sketches of one exported run; JSON exports (object or legacy
+    list form, the latter without a manifest) are parsed in Python under the GIL
+    Returns: (manifest dict, {metric: Sketch}); raises ValueError for unreadable files
+    """
+    with open(path, 'rb') as f:
+        head = f.read(len(MAGIC))
+    if head == MAGIC:
+        return _scan_bin(path, metrics)
+    if first_byte(path) in (b'{', b'['):
+        return _scan_json(path, metrics)
+    raise ValueError(f"{path}: not a binary or JSON run export")
+
+
+def find_runs(directory):
+    """Run exports under directory, recursively"""
+    runs = []
+    for root, _, files in os.walk(directory):
+        runs.extend(os.path.join(root, name) for name in files if name.endswith(('.hsrun', '.json')))
+    return sorted(runs)
+
+
+def analyze(paths, group_by=DEFAULT_GROUP_BY, metrics=None, workers=None):
+    """
+    Scan runs on a thread pool (NumPy releases the GIL on the heavy parts)
+    and merge their sketches per manifest group. Only binary runs scale with
+    workers: JSON exports are decoded sample by sample while holding the GIL
+    Returns: ({group key tuple: {'runs': n, 'metrics': {metric: Sketch}}}, [(path, error)])
+    """
+    groups, errors = {}, []
+
+    def scan(path):
+        try:
+            return path, scan_run(path, metrics), None
+        except (OSError, ValueError, KeyError) as e:
+            return path, None, e
+
+    with ThreadPoolExecutor(max_workers=workers or min(32, (os.cpu_count() or 1) * 2)) as pool:
+        for path, scanned, error in pool.map(scan, paths):
+            if error is not None:
+                errors.append((path, error))
+                continue
+            manifest, sketches = scanned
+            key = tuple(str(manifest.get(field, '')) or '?' for field in group_by)
+            group = groups.setdefault(key, {'runs': 0, 'metrics': {}})
+            group['runs'] += 1
+            for metric, sketch in sketches.items():
+                if metric in group['metrics']:
+                    group['metrics'][metric].merge(sketch)
+                else:
+                    group['metrics'][metric] = sketch
+    return groups, errors
+
+
+def summarize(groups, group_by, quantiles=DEFAULT_QUANTILES):
+    """Flat rows (one per group and metric) for printing or JSON export"""
+    rows = []
+    for key, group in sorted(groups.items()):
+        for metric, sketch in sorted(group['metrics'].items()):
+            if not sketch.total:
+                continue
+            row = dict(zip(group_by, key))
+            row.update(runs=group['runs'], metric=metric, samples=sketch.total, mean=sketch.mean, max=sketch.max)
+            row.update({f'p{q * 100:g}': sketch.quantile(q) for q in quantiles})
+            rows.append(row)
+    return rows
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(prog='stress_tool.py analytics',
+                                     description='Per-metric quantiles over a directory of run exports, grouped by host')
+    parser.add_argument('directory', help='Directory of --export-bin / --export-json files (searched recursively)')
+    parser.add_argument('--group-by', type=str, default=','.join(DEFAULT_GROUP_BY),
+                        help='Comma-separated manifest fields (cpu_model, kernel, firmware, microcode, hostname)')
+    parser.add_argument('--metrics', type=str, default=None, help='Comma-separated metrics (default: all)')
+    parser.add_argument('--quantiles', type=str, default=','.join(str(q) for q in DEFAULT_QUANTILES),
+                        help='Comma-separated quantiles to report')
+    parser.add_argument('--workers', type=int, default=None, help='Scan threads (default: 2x CPUs, at most 32)')
+    parser.add_argument('--export-json', type=str, default=None, help='Also write the table rows to a JSON file')
+    args = parser.parse_args(argv)
+
+    group_by = tuple(f.strip() for f in args.group_by.split(',') if f.strip())
+    metrics = set(args.metrics.split(',')) if args.metrics else None
+    quantiles = tuple(float(q) for q in args.quantiles.split(','))
+    start = time.time()
+    paths = find_runs(args.directory)
+    groups, errors = analyze(paths, group_by, metrics, args.workers)
+    rows = summarize(groups, group_by, quantiles)
+
+    table = Table(title=f"{len(paths) - len(errors)} runs in {len(groups)} groups ({time.time() - start:.1f}s)")
+    columns = list(group_by) + ['runs', 'metric', 'samples', 'mean'] + [f'p{q * 100:g}' for q in quantiles] + ['max']
+    for column in columns:
+        table.add_column(column, justify='left' if column in group_by or column == 'metric' else 'right')
+    for row in rows:
+        table.add_row(*(f'{row[c]:.2f}' if isinstance(row[c], float) else str(row[c]) for c in columns))
+    Console().print(table)
+    for path, error in errors:
+        print(f"[!] Skipped {path}: {error}")
+    if args.export_json:
+        with open(args.export_json, 'w') as f:
+            json.dump(rows, f, indent=2)
+        print(f"[INFO] Analytics exported to {args.export_json}")
+
+
+if __name__ == '__main__':
+    main()
@@ -194,7 +194,53 @@ class GPUBenchmark:
             data.free()
         
         return throughput_gb_s
-    
+
+    def benchmark_roofline(self, intensities, size_mb=256, seconds_per_point=0.5):
+        """
+        Sweep arithmetic intensity with memory_bandwidth_kernel: each element is
+        read, updated `iterations` times (2 FLOPs each) and written back, so
+        intensity = iterations / 4 FLOP/byte; points below 1/4 are skipped
+        Returns: list of dicts with intensity (FLOP/byte), gflops and gb_s
+        """
+        n = size_mb * 1024 * 1024 // 4
+        block_size = 256
+        grid_size = (n + block_size - 1) // block_size
+
+        host_data = np.ones(n, dtype=np.float32)
+        device_data = cuda.mem_alloc(host_data.nbytes)
+        cuda.memcpy_htod(device_data, host_data)
+
+        points = []
+        for intensity in intensities:
+            iterations = int(round(intensity * 4))
+            if iterations < 1:
+                continue
+            # Warmup
+            self.memory_bandwidth(device_data, np.int32(n), np.int32(iterations),
+                                  block=(block_size, 1, 1), grid=(grid_size, 1))
+            cuda.Context.synchronize()
+
+            launches = 0
+            start_time = time.time()
+            while time.time() - start_time < seconds_per_point:
+                self.memory_bandwidth(device_data, np.int32(n), np.int32(iterations),
+                                      block=(block_size, 1, 1), grid=(grid_size, 1))
+                cuda.Context.synchronize()
+                launches += 1
+            elapsed = time.time() - start_time
+
+            bytes_moved = n * 8 * launches  # read + write
+            points.append({
+                'intensity': iterations / 4,
+                'gflops': n * 2 * iterations * launches / elapsed / 1e9,
+                'gb_s': bytes_moved / elapsed / 1e9,
+                'seconds': elapsed,
+                'bytes': bytes_moved,
+            })
+
+        device_data.free()
+        return points
+
     def thermal_stress_test(self, duration=60):
         """
         Thermal stress test using compute-intensive Mandelbrot kernel
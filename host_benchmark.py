@@ -0,0 +1,1043 @@
+"""
+Host Benchmarking Module using native C++ code via ctypes
+Tests OS and CPU paths (IPC, scheduling, memory) that the GPU kernels don't cover
+"""
+
+import ctypes
+import errno
+import os
+import platform
+
+from topology import Topology
+
+IPC_TRANSPORTS = {
+    'pipe': 0,
+    'unix_stream': 1,
+    'unix_dgram': 2,
+    'socketpair': 3,
+    'shm_futex': 4,
+}
+IPC_MESSAGE_SIZES = [64, 4096, 65536]
+SYNC_LOCKS = {
+    'mutex': 0,
+    'spinlock': 1,
+    'rwlock': 2,
+    'futex': 3,
+    'condvar': 4,
+}
+SYSCALL_BENCHES = {
+    # name: (id, calls per timed batch)
+    'getpid': (0, 100000),
+    'clock_gettime': (1, 1000000),
+    'pipe_rw': (2, 50000),
+    'mmap_munmap': (3, 20000),
+    'page_fault': (4, 16384),
+}
+# FLOP per byte, 1/8 to 1024 in powers of two (roofline_run supports 1 or an even number of FLOPs per 8 bytes)
+ROOFLINE_INTENSITIES = [2.0 ** k for k in range(-3, 11)]
+# Load-thread traffic as 'lines read:lines written' per group, and injection delays after each group
+LOADED_LATENCY_RATIOS = ['1:0', '2:1', '1:1']
+LOADED_LATENCY_DELAYS_NS = [0, 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000]
+# Concurrent sequential streams per thread, and the share of them written back
+PREFETCH_STREAM_COUNTS = [1, 2, 4, 6, 8, 12, 16, 20, 24, 32]
+PREFETCH_STREAM_MIXES = {'read': 0.0, 'half': 0.5, 'rmw': 1.0}
+MEMCPY_IMPLS = {
+    'libc': 0,
+    'rep_movsb': 1,
+    'avx2': 2,
+    'avx512': 3,
+    'nontemporal': 4,
+}
+MEMCPY_SIZES = [64, 256, 1024, 4096, 16384, 65536, 262144, 1 << 20, 4 << 20, 16 << 20, 64 << 20]
+# (source offset, destination offset) from page-aligned buffers
+MEMCPY_ALIGNMENTS = {'aligned': (0, 0), 'src+1': (1, 0), 'dst+1': (0, 1)}
+PAGE_FAULT_MODES = {
+    'touch': 0,           # one write per page, faulted on first touch
+    'map_populate': 1,    # mmap(MAP_POPULATE)
+    'madv_populate': 2,   # madvise(MADV_POPULATE_WRITE), Linux 5.14+
+}
+PAGE_FAULT_PAGES = {'4k': 0, 'thp': 1}
+MIXED_PRECISIONS = {
+    'fp64': 0,
+    'fp32': 1,
+    'bf16': 2,
+    'int8': 3,
+}
+# ISA tier -> instructions used per precision (None: no kernel at that tier)
+MIXED_PRECISION_ISAS = {
+    0: {'fp64': 'scalar', 'fp32': 'scalar', 'bf16': 'scalar (emulated)', 'int8': 'scalar'},
+    1: {'fp64': 'avx2_fma', 'fp32': 'avx2_fma', 'bf16': None, 'int8': 'avx_vnni'},
+    2: {'fp64': 'avx512f', 'fp32': 'avx512f', 'bf16': 'avx512_bf16', 'int8': 'avx512_vnni'},
+}
+MATH_FUNCTIONS = {
+    'exp': 0,
+    'log': 1,
+    'sin': 2,
+    'cos': 3,
+    'sqrt': 4,
+}
+# Scalar libm calls, or the polynomial versions vectorized for each target
+MATH_IMPLS = {
+    'libm': 0,
+    'poly_sse2': 1,
+    'poly_avx2': 2,
+    'poly_avx512': 3,
+}
+SPMV_FORMATS = {
+    'csr': 0,
+    'ell': 1,    # rows padded to the longest row
+    'sell': 2,   # SELL-C-sigma, C = 8 rows per chunk, sorted within 256-row windows
+}
+SPMV_PATTERNS = {
+    'banded': 0,     # columns near the diagonal (stencil/FEM-like)
+    'power_law': 1,  # Pareto row lengths, random columns (graph-like)
+    'random': 2,     # fixed row length, uniformly random columns
+}
+STENCILS = {
+    '2d5': 0,    # 2D 5-point
+    '3d7': 1,    # 3D 7-point
+    '3d27': 2,   # 3D 27-point
+}
+# Default (nx, ny, nz) per stencil: two 128 MB double grids, far larger than the caches
+STENCIL_GRIDS = {'2d5': (4096, 4096, 1), '3d7': (256, 256, 256), '3d27': (256, 256, 256)}
+# Spatial tile per stencil: columns in 2D, rows of each plane in 3D
+STENCIL_TILES = {'2d5': 1024, '3d7': 16, '3d27': 16}
+STENCIL_VARIANTS = ['scalar', 'simd', 'tiled', 'temporal']
+# Keys per radix sort (8 bytes each) and build rows per hash join (16-byte tuples,
+# probed by PROBE_RATIO x as many): from cache-resident to far past the LLC
+RADIX_SORT_SIZES = [1 << 16, 1 << 20, 1 << 24]
+HASH_JOIN_SIZES = [1 << 16, 1 << 20, 1 << 22]
+HASH_JOIN_PROBE_RATIO = 4
+# Partitioned joins aim for this many build tuples per piece (a 256 KB table)
+HASH_JOIN_PARTITION_ROWS = 1 << 13
+HASH_JOIN_MAX_PARTITION_BITS = 12
+THP_ENABLED = '/sys/kernel/mm/transparent_hugepage/enabled'
+VULNERABILITIES_DIR = '/sys/devices/system/cpu/vulnerabilities'
+SCHED_LATENCY_BUCKETS = 10000  # 1 us buckets up to 10 ms, last bucket collects overflows
+SCHED_LATENCY_BUCKET_NS = 1000
+
+
+class IpcResult(ctypes.Structure):
+    _fields_ = [
+        ('bandwidth_mb_s', ctypes.c_double),
+        ('messages_per_sec', ctypes.c_double),
+        ('rtt_avg_ns', ctypes.c_double),
+        ('rtt_p50_ns', ctypes.c_double),
+        ('rtt_p99_ns', ctypes.c_double),
+        ('round_trips', ctypes.c_uint64),
+    ]
+
+
+class SchedLatencyResult(ctypes.Structure):
+    _fields_ = [
+        ('samples', ctypes.c_uint64),
+        ('overflows', ctypes.c_uint64),
+        ('min_ns', ctypes.c_double),
+        ('avg_ns', ctypes.c_double),
+        ('max_ns', ctypes.c_double),
+        ('realtime', ctypes.c_int),
+    ]
+
+
+class SyncResult(ctypes.Structure):
+    _fields_ = [
+        ('total_acquisitions', ctypes.c_uint64),
+        ('acquisitions_per_sec', ctypes.c_double),
+        ('fairness_jain', ctypes.c_double),
+        ('min_share', ctypes.c_double),
+        ('max_share', ctypes.c_double),
+        ('handoffs', ctypes.c_uint64),
+        ('handoff_avg_ns', ctypes.c_double),
+        ('handoff_p50_ns', ctypes.c_double),
+        ('handoff_p99_ns', ctypes.c_double),
+    ]
+
+
+class SyscallBenchResult(ctypes.Structure):
+    _fields_ = [
+        ('ns_per_call_min', ctypes.c_double),
+        ('ns_per_call_median', ctypes.c_double),
+        ('tsc_ghz', ctypes.c_double),
+        ('calls', ctypes.c_uint64),
+    ]
+
+
+class TimingInfo(ctypes.Structure):
+    _fields_ = [
+        ('invariant_tsc', ctypes.c_int),
+        ('rdtscp', ctypes.c_int),
+        ('using_tsc', ctypes.c_int),
+        ('tsc_ghz', ctypes.c_double),
+        ('ticks_overhead_ns', ctypes.c_double),
+    ]
+
+
+class RooflineResult(ctypes.Structure):
+    _fields_ = [
+        ('intensity', ctypes.c_double),
+        ('gflops', ctypes.c_double),
+        ('gb_s', ctypes.c_double),
+        ('seconds', ctypes.c_double),
+        ('bytes', ctypes.c_uint64),
+    ]
+
+
+class LoadedLatencyResult(ctypes.Structure):
+    _fields_ = [
+        ('latency_ns', ctypes.c_double),
+        ('bandwidth_gb_s', ctypes.c_double),
+        ('read_gb_s', ctypes.c_double),
+        ('write_gb_s', ctypes.c_double),
+        ('probe_loads', ctypes.c_uint64),
+    ]
+
+
+class StreamBenchResult(ctypes.Structure):
+    _fields_ = [
+        ('gb_s', ctypes.c_double),
+        ('read_gb_s', ctypes.c_double),
+        ('write_gb_s', ctypes.c_double),
+        ('seconds', ctypes.c_double),
+    ]
+
+
+class MemcpyFeatures(ctypes.Structure):
+    _fields_ = [
+        ('erms', ctypes.c_int),
+        ('fsrm', ctypes.c_int),
+        ('avx2', ctypes.c_int),
+        ('avx512f', ctypes.c_int),
+    ]
+
+
+class MemcpyBenchResult(ctypes.Structure):
+    _fields_ = [
+        ('ns_per_copy_min', ctypes.c_double),
+        ('ns_per_copy_median', ctypes.c_double),
+        ('gb_s', ctypes.c_double),
+        ('copies', ctypes.c_uint64),
+    ]
+
+
+class PageFaultResult(ctypes.Structure):
+    _fields_ = [
+        ('gb_s', ctypes.c_double),
+        ('faults_per_sec', ctypes.c_double),
+        ('ns_per_fault', ctypes.c_double),
+        ('faults', ctypes.c_uint64),
+        ('bytes', ctypes.c_uint64),
+        ('seconds', ctypes.c_double),
+    ]
+
+
+class MixedPrecisionResult(ctypes.Structure):
+    _fields_ = [
+        ('gops', ctypes.c_double),
+        ('seconds', ctypes.c_double),
+        ('ops', ctypes.c_uint64),
+        ('isa', ctypes.c_int),
+        ('max_rel_error', ctypes.c_double),
+    ]
+
+
+class TranscendentalResult(ctypes.Structure):
+    _fields_ = [
+        ('gelem_s', ctypes.c_double),
+        ('ns_per_elem', ctypes.c_double),
+        ('max_ulp', ctypes.c_double),
+        ('mean_ulp', ctypes.c_double),
+        ('evaluations', ctypes.c_uint64),
+    ]
+
+
+class SpmvResult(ctypes.Structure):
+    _fields_ = [
+        ('gflops', ctypes.c_double),
+        ('gb_s', ctypes.c_double),
+        ('fill', ctypes.c_double),
+        ('max_rel_error', ctypes.c_double),
+        ('nnz', ctypes.c_uint64),
+        ('max_row_nnz', ctypes.c_uint64),
+        ('seconds', ctypes.c_double),
+    ]
+
+
+class StencilResult(ctypes.Structure):
+    _fields_ = [
+        ('gcells_s', ctypes.c_double),
+        ('gflops', ctypes.c_double),
+        ('gb_s', ctypes.c_double),
+        ('max_abs_error', ctypes.c_double),
+        ('steps', ctypes.c_uint64),
+        ('seconds', ctypes.c_double),
+    ]
+
+
+class RadixSortResult(ctypes.Structure):
+    _fields_ = [
+        ('tuples_s', ctypes.c_double),
+        ('gb_s', ctypes.c_double),
+        ('seconds', ctypes.c_double),
+        ('sorts', ctypes.c_uint64),
+        ('sorted', ctypes.c_int),
+    ]
+
+
+class HashJoinResult(ctypes.Structure):
+    _fields_ = [
+        ('tuples_s', ctypes.c_double),
+        ('partition_share', ctypes.c_double),
+        ('seconds', ctypes.c_double),
+        ('joins', ctypes.c_uint64),
+        ('matches', ctypes.c_uint64),
+        ('valid', ctypes.c_int),
+    ]
+
+
+def _to_dict(result):
+    return {name: getattr(result, name) for name, _ in result._fields_}
+
+
+class HostBenchmark:
+    """Host benchmarking using the compiled native C++ library"""
+
+    def __init__(self):
+        self.build_dir = "build"
+        self._load_library()
+
+    def _load_library(self):
+        """Load the compiled native library and declare its C signatures"""
+        lib_path = os.path.join(self.build_dir, "libhoststress.so")
+        if not os.path.exists(lib_path):
+            raise FileNotFoundError(
+                f"Library not found: {lib_path}. Run 'make host' first to compile native benchmarks."
+            )
+        self.lib = ctypes.CDLL(os.path.abspath(lib_path))
+
+        self.lib.timing_get_info.argtypes = [ctypes.POINTER(TimingInfo)]
+        self.lib.timing_get_info.restype = ctypes.c_int
+
+        self.lib.ipc_benchmark.argtypes = [ctypes.c_int, ctypes.c_size_t, ctypes.c_int, ctypes.c_int,
+                                           ctypes.c_double, ctypes.POINTER(IpcResult)]
+        self.lib.ipc_benchmark.restype = ctypes.c_int
+
+        self.lib.sched_latency_run.argtypes = [ctypes.POINTER(ctypes.c_int), ctypes.c_int, ctypes.c_int,
+                                               ctypes.c_uint64, ctypes.c_double,
+                                               ctypes.POINTER(ctypes.c_uint64), ctypes.c_int,
+                                               ctypes.c_uint64, ctypes.POINTER(SchedLatencyResult)]
+        self.lib.sched_latency_run.restype = ctypes.c_int
+
+        self.lib.sync_contention_run.argtypes = [ctypes.c_int, ctypes.c_int, ctypes.c_uint64, ctypes.c_uint64,
+                                                 ctypes.c_int, ctypes.c_double,
+                                                 ctypes.POINTER(ctypes.c_uint64), ctypes.POINTER(SyncResult)]
+        self.lib.sync_contention_run.restype = ctypes.c_int
+
+        self.lib.syscall_bench_run.argtypes = [ctypes.c_int, ctypes.c_uint64, ctypes.POINTER(SyscallBenchResult)]
+        self.lib.syscall_bench_run.restype = ctypes.c_int
+
+        self.lib.roofline_run.argtypes = [ctypes.c_int, ctypes.c_uint64, ctypes.c_int, ctypes.c_double,
+                                          ctypes.POINTER(RooflineResult)]
+        self.lib.roofline_run.restype = ctypes.c_int
+
+        self.lib.loaded_latency_run.argtypes = [ctypes.c_int, ctypes.POINTER(ctypes.c_int), ctypes.c_int,
+                                                ctypes.c_int, ctypes.c_int, ctypes.c_uint64, ctypes.c_uint64,
+                                                ctypes.c_uint64, ctypes.c_double,
+                                                ctypes.POINTER(LoadedLatencyResult)]
+        self.lib.loaded_latency_run.restype = ctypes.c_int
+
+        self.lib.stream_bench_run.argtypes = [ctypes.c_int, ctypes.c_int, ctypes.c_uint64, ctypes.c_int,
+                                              ctypes.c_double, ctypes.POINTER(StreamBenchResult)]
+        self.lib.stream_bench_run.restype = ctypes.c_int
+
+        self.lib.memcpy_get_features.argtypes = [ctypes.POINTER(MemcpyFeatures)]
+        self.lib.memcpy_get_features.restype = ctypes.c_int
+
+        self.lib.memcpy_bench_run.argtypes = [ctypes.c_int, ctypes.c_uint64, ctypes.c_uint32, ctypes.c_uint32,
+                                              ctypes.c_double, ctypes.POINTER(MemcpyBenchResult)]
+        self.lib.memcpy_bench_run.restype = ctypes.c_int
+
+        self.lib.page_fault_run.argtypes = [ctypes.c_int, ctypes.c_int, ctypes.c_uint64, ctypes.c_int,
+                                            ctypes.c_double, ctypes.POINTER(PageFaultResult)]
+        self.lib.page_fault_run.restype = ctypes.c_int
+
+        self.lib.mixed_precision_best_isa.argtypes = [ctypes.c_int]
+        self.lib.mixed_precision_best_isa.restype = ctypes.c_int
+
+        self.lib.mixed_precision_run.argtypes = [ctypes.c_int, ctypes.c_int, ctypes.c_int, ctypes.c_double,
+                                                 ctypes.POINTER(MixedPrecisionResult)]
+        self.lib.mixed_precision_run.restype = ctypes.c_int
+
+        self.lib.transcendental_run.argtypes = [ctypes.c_int, ctypes.c_int, ctypes.c_double,
+                                                ctypes.POINTER(TranscendentalResult)]
+        self.lib.transcendental_run.restype = ctypes.c_int
+
+        self.lib.transcendental_compiler.argtypes = []
+        self.lib.transcendental_compiler.restype = ctypes.c_char_p
+
+        self.lib.spmv_run.argtypes = [ctypes.c_int, ctypes.c_int, ctypes.c_uint64, ctypes.c_int,
+                                      ctypes.POINTER(ctypes.c_int), ctypes.c_int, ctypes.c_int, ctypes.c_double,
+                                      ctypes.POINTER(SpmvResult)]
+        self.lib.spmv_run.restype = ctypes.c_int
+
+        self.lib.stencil_run.argtypes = [ctypes.c_int, ctypes.c_uint64, ctypes.c_uint64, ctypes.c_uint64, ctypes.c_int,
+                                         ctypes.c_int, ctypes.c_int, ctypes.c_int, ctypes.c_double,
+                                         ctypes.POINTER(StencilResult)]
+        self.lib.stencil_run.restype = ctypes.c_int
+
+        self.lib.radix_sort_run.argtypes = [ctypes.c_uint64, ctypes.c_int, ctypes.c_int, ctypes.c_double,
+                                            ctypes.POINTER(RadixSortResult)]
+        self.lib.radix_sort_run.restype = ctypes.c_int
+
+        self.lib.hash_join_run.argtypes = [ctypes.c_uint64, ctypes.c_uint64, ctypes.c_int, ctypes.c_int, ctypes.c_int,
+                                           ctypes.c_double, ctypes.POINTER(HashJoinResult)]
+        self.lib.hash_join_run.restype = ctypes.c_int
+
+    @staticmethod
+    def _check(rc, what):
+        if rc < 0:
+            raise OSError(-rc, f"{what} failed: {os.strerror(-rc)}")
+
+    def timing_info(self):
+        """
+        Timing source used by the native engines: the invariant TSC calibrated
+        against CLOCK_MONOTONIC at load time, or clock_gettime as a fallback
+        (forced with HOSTSTRESS_NO_TSC=1)
+        Returns: dict with invariant_tsc, rdtscp, using_tsc, tsc_ghz and ticks_overhead_ns
+        """
+        info = TimingInfo()
+        self.lib.timing_get_info(ctypes.byref(info))
+        stats = _to_dict(info)
+        for flag in ('invariant_tsc', 'rdtscp', 'using_tsc'):
+            stats[flag] = bool(stats[flag])
+        return stats
+
+    @staticmethod
+    def ipc_placements():
+        """Core placements for IPC endpoints: same core, two different cores, and unpinned"""
+        cpus = sorted(os.sched_getaffinity(0))
+        placements = {'same_core': (cpus[0], cpus[0])}
+        if len(cpus) > 1:
+            placements['cross_core'] = (cpus[0], cpus[-1])
+        placements['unpinned'] = (-1, -1)
+        return placements
+
+    def benchmark_ipc(self, transport, msg_size, cpu_a=-1, cpu_b=-1, seconds=1.0):
+        """
+        Benchmark one IPC transport at one message size and core placement
+        The streaming writer and the echoing peer run in a forked process
+        Returns: dict with bandwidth (MB/s), messages/sec and round-trip latency (ns)
+        """
+        result = IpcResult()
+        rc = self.lib.ipc_benchmark(IPC_TRANSPORTS[transport], msg_size, cpu_a, cpu_b,
+                                    seconds, ctypes.byref(result))
+        self._check(rc, f"IPC benchmark ({transport}, {msg_size}B)")
+        return _to_dict(result)
+
+    def sweep_ipc(self, transports=None, sizes=None, placements=None, seconds_per_point=0.5):
+        """
+        Sweep transports x message sizes x core placements
+        Returns: list of result dicts tagged with transport, msg_size and placement
+        """
+        transports = transports or list(IPC_TRANSPORTS)
+        sizes = sizes or IPC_MESSAGE_SIZES
+        placements = placements or self.ipc_placements()
+        points = []
+        for transport in transports:
+            for size in sizes:
+                for placement, (cpu_a, cpu_b) in placements.items():
+                    result = self.benchmark_ipc(transport, size, cpu_a, cpu_b, seconds_per_point)
+                    result.update({'transport': transport, 'msg_size': size, 'placement': placement})
+                    points.append(result)
+        return points
+
+    def benchmark_sched_latency(self, seconds=1.0, cpus=None, interval_us=1000, priority=95):
+        """
+        Cyclictest-style wake-up latency: one SCHED_FIFO thread per CPU (falls back
+        to normal priority without CAP_SYS_NICE) sleeping on absolute timers
+        Returns: dict cpu -> stats plus a dense histogram of 1 us buckets
+        """
+        cpus = cpus or sorted(os.sched_getaffinity(0))
+        ncpus = len(cpus)
+        cpu_array = (ctypes.c_int * ncpus)(*cpus)
+        histograms = (ctypes.c_uint64 * (ncpus * SCHED_LATENCY_BUCKETS))()
+        out = (SchedLatencyResult * ncpus)()
+        rc = self.lib.sched_latency_run(cpu_array, ncpus, priority, interval_us * 1000, seconds,
+                                        histograms, SCHED_LATENCY_BUCKETS, SCHED_LATENCY_BUCKET_NS, out)
+        self._check(rc, "Scheduler latency measurement")
+        per_cpu = {}
+        for i, cpu in enumerate(cpus):
+            stats = _to_dict(out[i])
+            start = i * SCHED_LATENCY_BUCKETS
+            stats['histogram'] = histograms[start:start + SCHED_LATENCY_BUCKETS]
+            per_cpu[cpu] = stats
+        return per_cpu
+
+    def benchmark_sync(self, lock, threads, cs_ns=100, think_ns=0, read_percent=80, seconds=1.0):
+        """
+        Lock contention: threads repeatedly acquire one lock and hold it for cs_ns
+        read_percent only applies to 'rwlock' (share of shared acquisitions)
+        Returns: dict with acquisitions/sec, fairness (Jain index, min/max per-thread
+        share), hand-off latency (ns) and the per-thread acquisition counts
+        """
+        per_thread = (ctypes.c_uint64 * threads)()
+        result = SyncResult()
+        rc = self.lib.sync_contention_run(SYNC_LOCKS[lock], threads, cs_ns, think_ns, read_percent,
+                                          seconds, per_thread, ctypes.byref(result))
+        self._check(rc, f"Sync contention ({lock}, {threads} threads)")
+        stats = _to_dict(result)
+        stats['per_thread'] = list(per_thread)
+        return stats
+
+    def benchmark_syscalls(self, names=None, scale=1.0):
+        """
+        Syscall-overhead microbenchmarks timed with calibrated rdtsc
+        scale shrinks or grows the number of calls per batch
+        Returns: dict name -> ns per call (min and median over batches)
+        """
+        timings = {}
+        for name in names or SYSCALL_BENCHES:
+            bench_id, calls = SYSCALL_BENCHES[name]
+            result = SyscallBenchResult()
+            rc = self.lib.syscall_bench_run(bench_id, max(1, int(calls * scale)), ctypes.byref(result))
+            self._check(rc, f"Syscall benchmark ({name})")
+            timings[name] = _to_dict(result)
+        return timings
+
+    def benchmark_roofline(self, intensities=None, size_mb=256, threads=None, seconds_per_point=0.5):
+        """
+        Sweep arithmetic intensity with the CPU version of memory_bandwidth_kernel
+        (load, chain of mul+add, store) on all allowed CPUs
+        Returns: list of dicts with intensity (FLOP/byte), gflops and gb_s, one per point
+        """
+        threads = threads or len(os.sched_getaffinity(0))
+        points = []
+        for intensity in intensities or ROOFLINE_INTENSITIES:
+            flops = max(1, int(round(intensity * 8)))
+            if flops > 1:
+                flops += flops % 2
+            result = RooflineResult()
+            rc = self.lib.roofline_run(flops, size_mb * 1024 * 1024, threads, seconds_per_point,
+                                       ctypes.byref(result))
+            self._check(rc, f"Roofline point ({intensity:g} FLOP/byte)")
+            points.append(_to_dict(result))
+        return points
+
+    @staticmethod
+    def loaded_latency_cpus():
+        """Probe core (first allowed CPU) and load cores (all the others)"""
+        cpus = sorted(os.sched_getaffinity(0))
+        return cpus[0], cpus[1:]
+
+    def benchmark_loaded_latency(self, ratio='1:0', delay_ns=0, probe_cpu=None, load_cpus=None,
+                                 chase_mb=256, load_mb=64, seconds=1.0):
+        """
+        Pointer-chase latency on probe_cpu while load_cpus stream traffic at the
+        given read:write ratio, pausing delay_ns after each group of lines
+        (an empty load_cpus measures idle latency)
+        Returns: dict with latency_ns and the load's read/write/total GB/s
+        """
+        default_probe, default_load = self.loaded_latency_cpus()
+        probe_cpu = default_probe if probe_cpu is None else probe_cpu
+        load_cpus = default_load if load_cpus is None else load_cpus
+        reads, writes = (int(n) for n in ratio.split(':'))
+        cpu_array = (ctypes.c_int * max(1, len(load_cpus)))(*load_cpus)
+        result = LoadedLatencyResult()
+        rc = self.lib.loaded_latency_run(probe_cpu, cpu_array, len(load_cpus), reads, writes, delay_ns,
+                                         chase_mb * 1024 * 1024, load_mb * 1024 * 1024, seconds,
+                                         ctypes.byref(result))
+        self._check(rc, f"Loaded latency ({ratio}, delay {delay_ns}ns)")
+        return _to_dict(result)
+
+    def sweep_loaded_latency(self, ratios=None, delays=None, seconds_per_point=1.0, **kwargs):
+        """
+        Idle latency followed by every ratio x injection delay (heaviest load first);
+        only the idle point is measured when there is no CPU left for load threads
+        Returns: list of result dicts tagged with ratio ('idle' for the unloaded point) and delay_ns
+        """
+        idle_kwargs = {k: v for k, v in kwargs.items() if k != 'load_cpus'}
+        idle = self.benchmark_loaded_latency(load_cpus=[], seconds=seconds_per_point, **idle_kwargs)
+        points = [dict(idle, ratio='idle', delay_ns=None)]
+        if kwargs.get('load_cpus') is None and not self.loaded_latency_cpus()[1]:
+            return points
+        for ratio in ratios or LOADED_LATENCY_RATIOS:
+            for delay in sorted(delays or LOADED_LATENCY_DELAYS_NS):
+                result = self.benchmark_loaded_latency(ratio, delay, seconds=seconds_per_point, **kwargs)
+                points.append(dict(result, ratio=ratio, delay_ns=delay))
+        return points
+
+    def benchmark_streams(self, streams, mix='read', threads=1, total_mb=512, seconds=0.5):
+        """
+        Walk `streams` sequential streams per thread in lockstep, writing back the
+        PREFETCH_STREAM_MIXES[mix] share of them; total_mb is split across all streams
+        Returns: dict with total, read and write GB/s plus gb_s_per_stream
+        """
+        writes = int(streams * PREFETCH_STREAM_MIXES[mix] + 0.5)
+        stream_bytes = total_mb * 1024 * 1024 // (streams * threads)
+        result = StreamBenchResult()
+        rc = self.lib.stream_bench_run(streams, writes, stream_bytes, threads, seconds, ctypes.byref(result))
+        self._check(rc, f"Stream benchmark ({streams} streams, {mix})")
+        stats = _to_dict(result)
+        stats['gb_s_per_stream'] = stats['gb_s'] / (streams * threads)
+        return stats
+
+    def sweep_streams(self, counts=None, mixes=None, threads=1, seconds_per_point=0.5):
+        """
+        Sweep stream counts x read/write mixes
+        Returns: list of result dicts tagged with streams, mix and threads
+        """
+        points = []
+        for mix in mixes or PREFETCH_STREAM_MIXES:
+            for streams in counts or PREFETCH_STREAM_COUNTS:
+                result = self.benchmark_streams(streams, mix, threads, seconds=seconds_per_point)
+                result.update({'streams': streams, 'mix': mix, 'threads': threads})
+                points.append(result)
+        return points
+
+    def memcpy_features(self):
+        """CPU copy features: erms, fsrm (fast short rep mov), avx2, avx512f"""
+        features = MemcpyFeatures()
+        self.lib.memcpy_get_features(ctypes.byref(features))
+        return {name: bool(value) for name, value in _to_dict(features).items()}
+
+    def memcpy_impls(self):
+        """Copy implementations this CPU can run"""
+        features = self.memcpy_features()
+        needs = {'avx2': 'avx2', 'avx512': 'avx512f', 'nontemporal': 'avx2'}
+        return [impl for impl in MEMCPY_IMPLS if features.get(needs.get(impl), True)]
+
+    def benchmark_memcpy(self, impl, size, alignment='aligned', seconds=0.05):
+        """
+        Time one copy implementation at one size and alignment (warm buffers)
+        Returns: dict with ns per copy (min and median over batches) and GB/s
+        """
+        src_offset, dst_offset = MEMCPY_ALIGNMENTS[alignment]
+        result = MemcpyBenchResult()
+        rc = self.lib.memcpy_bench_run(MEMCPY_IMPLS[impl], size, src_offset, dst_offset, seconds,
+                                       ctypes.byref(result))
+        self._check(rc, f"memcpy benchmark ({impl}, {size}B, {alignment})")
+        return _to_dict(result)
+
+    def sweep_memcpy(self, impls=None, sizes=None, alignments=None, seconds_per_point=0.05):
+        """
+        Sweep implementations x sizes x alignments, skipping implementations the CPU lacks
+        Returns: list of result dicts tagged with impl, size and alignment
+        """
+        available = self.memcpy_impls()
+        points = []
+        for alignment in alignments or MEMCPY_ALIGNMENTS:
+            for size in sizes or MEMCPY_SIZES:
+                for impl in impls or MEMCPY_IMPLS:
+                    if impl not in available:
+                        continue
+                    result = self.benchmark_memcpy(impl, size, alignment, seconds_per_point)
+                    result.update({'impl': impl, 'size': size, 'alignment': alignment})
+                    points.append(result)
+        return points
+
+    def benchmark_page_faults(self, mode='touch', page='4k', threads=1, mb_per_thread=64, seconds=0.5):
+        """
+        Threads repeatedly map fresh anonymous memory and fault it in
+        Returns: dict with GB/s and faults/sec (over time spent faulting) and ns per fault
+        """
+        result = PageFaultResult()
+        rc = self.lib.page_fault_run(PAGE_FAULT_MODES[mode], PAGE_FAULT_PAGES[page], mb_per_thread * 1024 * 1024,
+                                     threads, seconds, ctypes.byref(result))
+        self._check(rc, f"Page fault benchmark ({mode}, {page}, {threads} threads)")
+        return _to_dict(result)
+
+    @staticmethod
+    def page_fault_threads():
+        """Thread counts to sweep: powers of two up to the allowed CPUs, plus all of them"""
+        ncpus = len(os.sched_getaffinity(0))
+        counts = [1 << i for i in range(ncpus.bit_length()) if 1 << i < ncpus]
+        return counts + [ncpus]
+
+    def sweep_page_faults(self, modes=None, pages=None, thread_counts=None, seconds_per_point=0.5):
+        """
+        Sweep modes x page sizes x thread counts; modes the kernel lacks are
+        skipped, and a mode/page stops at the first thread count whose mappings
+        the memory limit refuses (ENOMEM, e.g. under strict overcommit)
+        Returns: list of result dicts tagged with mode, page and threads
+        """
+        points = []
+        for mode in modes or PAGE_FAULT_MODES:
+            for page in pages or PAGE_FAULT_PAGES:
+                for threads in thread_counts or self.page_fault_threads():
+                    try:
+                        result = self.benchmark_page_faults(mode, page, threads, seconds=seconds_per_point)
+                    except OSError as e:
+                        if e.errno in (errno.ENOTSUP, errno.ENOMEM):
+                            break
+                        raise
+                    result.update({'mode': mode, 'page': page, 'threads': threads})
+                    points.append(result)
+        return points
+
+    def benchmark_mixed_precision(self, precision, isa=None, threads=None, seconds=1.0):
+        """
+        GEMM register-tile kernel for one precision on `threads` pinned threads
+        (default: all allowed CPUs); isa is a MIXED_PRECISION_ISAS tier, None = best
+        the CPU supports. The kernel is validated against a scalar reference first
+        Returns: dict with gops (GFLOPS, or GOPS for int8), tops, isa name and tier
+        """
+        threads = threads or len(os.sched_getaffinity(0))
+        result = MixedPrecisionResult()
+        rc = self.lib.mixed_precision_run(MIXED_PRECISIONS[precision], -1 if isa is None else isa, threads,
+                                          seconds, ctypes.byref(result))
+        self._check(rc, f"Mixed-precision kernel ({precision})")
+        stats = _to_dict(result)
+        stats['tier'] = stats.pop('isa')
+        stats['isa'] = MIXED_PRECISION_ISAS[stats['tier']][precision]
+        stats['tops'] = stats['gops'] / 1000
+        stats['threads'] = threads
+        return stats
+
+    def math_build_info(self):
+        """glibc and compiler versions behind the libm and polynomial results"""
+        libc, version = platform.libc_ver()
+        return {'libc': f'{libc} {version}'.strip() or None,
+                'compiler': self.lib.transcendental_compiler().decode()}
+
+    def benchmark_math(self, function, impl, seconds=0.2):
+        """
+        Throughput of one function and implementation over L1-resident float inputs,
+        and its error against a double-precision reference over the function's domain
+        Returns: dict with Gelem/s, ns per element and max/mean ULP error
+        """
+        result = TranscendentalResult()
+        rc = self.lib.transcendental_run(MATH_FUNCTIONS[function], MATH_IMPLS[impl], seconds, ctypes.byref(result))
+        self._check(rc, f"Math benchmark ({function}, {impl})")
+        return _to_dict(result)
+
+    def sweep_math(self, functions=None, impls=None, seconds_per_point=0.2):
+        """
+        Sweep functions x implementations, skipping targets the CPU lacks
+        Returns: list of result dicts tagged with function, impl and speedup over libm
+        """
+        points = []
+        for function in functions or MATH_FUNCTIONS:
+            libm = None
+            for impl in impls or MATH_IMPLS:
+                try:
+                    result = self.benchmark_math(function, impl, seconds_per_point)
+                except OSError as e:
+                    if e.errno == errno.ENOTSUP:
+                        continue
+                    raise
+                libm = result['gelem_s'] if impl == 'libm' else libm
+                result.update({'function': function, 'impl': impl,
+                               'speedup': result['gelem_s'] / libm if libm else None})
+                points.append(result)
+        return points
+
+    @staticmethod
+    def spmv_cpus():
+        """Allowed CPUs grouped by NUMA node, so consecutive row partitions share a node"""
+        allowed = os.sched_getaffinity(0)
+        nodes = Topology.from_sysfs().domains('node')
+        cpus = [cpu for node in sorted(nodes) for cpu in nodes[node] if cpu in allowed]
+        return cpus + sorted(allowed - set(cpus))
+
+    def benchmark_spmv(self, fmt, pattern, rows=1 << 20, nnz_per_row=16, cpus=None, numa_local=True, seconds=0.5):
+        """
+        y = A x on one pinned thread per CPU (default: spmv_cpus()), rows split by
+        stored elements; numa_local has each thread first-touch its own partition
+        Raises OSError(E2BIG) when padding would exceed 16 stored elements per nonzero
+        Returns: dict with GFLOPS, effective GB/s, fill (stored / nonzero) and the
+        error against a serial CSR product
+        """
+        cpus = cpus or self.spmv_cpus()
+        cpu_array = (ctypes.c_int * len(cpus))(*cpus)
+        result = SpmvResult()
+        rc = self.lib.spmv_run(SPMV_FORMATS[fmt], SPMV_PATTERNS[pattern], rows, nnz_per_row, cpu_array, len(cpus),
+                               int(numa_local), seconds, ctypes.byref(result))
+        self._check(rc, f"SpMV ({fmt}, {pattern})")
+        stats = _to_dict(result)
+        stats['threads'] = len(cpus)
+        return stats
+
+    def sweep_spmv(self, formats=None, patterns=None, seconds_per_point=0.5, **kwargs):
+        """
+        Sweep patterns x formats, skipping padded formats that would blow up
+        Returns: list of result dicts tagged with format and pattern
+        """
+        points = []
+        for pattern in patterns or SPMV_PATTERNS:
+            for fmt in formats or SPMV_FORMATS:
+                try:
+                    result = self.benchmark_spmv(fmt, pattern, seconds=seconds_per_point, **kwargs)
+                except OSError as e:
+                    if e.errno == errno.E2BIG:
+                        continue
+                    raise
+                result.update({'format': fmt, 'pattern': pattern})
+                points.append(result)
+        return points
+
+    def benchmark_stencil(self, stencil, grid=None, tile=0, time_block=1, simd=True, threads=None, seconds=0.5):
+        """
+        Jacobi sweeps of one stencil over grid (nx, ny, nz; nz is ignored in 2D, default
+        STENCIL_GRIDS) on `threads` pinned threads (default: all allowed CPUs)
+        tile: spatial tile (STENCIL_TILES units), 0 = none; time_block: steps per
+        wavefront block, 1 = no temporal blocking; simd=False forces scalar code
+        The schedule is first checked against plain sweeps on a small grid
+        Returns: dict with Gcells/s, GFLOPS, effective GB/s and the check's max error
+        """
+        nx, ny, nz = grid or STENCIL_GRIDS[stencil]
+        threads = threads or len(os.sched_getaffinity(0))
+        result = StencilResult()
+        rc = self.lib.stencil_run(STENCILS[stencil], nx, ny, nz, tile, time_block, int(simd), threads, seconds,
+                                  ctypes.byref(result))
+        self._check(rc, f"Stencil ({stencil}, tile {tile}, {time_block} steps per block)")
+        stats = _to_dict(result)
+        stats['threads'] = threads
+        return stats
+
+    def sweep_stencil(self, stencils=None, variants=None, time_block=4, seconds_per_point=0.5, **kwargs):
+        """
+        Every stencil under each STENCIL_VARIANTS schedule: scalar, simd, simd with
+        spatial tiles, and simd with temporal blocks of time_block steps
+        Returns: list of result dicts tagged with stencil, variant, tile and time_block
+        """
+        points = []
+        for stencil in stencils or STENCILS:
+            for variant in variants or STENCIL_VARIANTS:
+                options = {
+                    'scalar': {'simd': False},
+                    'simd': {},
+                    'tiled': {'tile': STENCIL_TILES[stencil]},
+                    'temporal': {'time_block': time_block},
+                }[variant]
+                result = self.benchmark_stencil(stencil, seconds=seconds_per_point, **options, **kwargs)
+                result.update({'stencil': stencil, 'variant': variant, 'tile': options.get('tile', 0),
+                               'time_block': options.get('time_block', 1)})
+                points.append(result)
+        return points
+
+    def benchmark_radix_sort(self, keys, swwc=True, threads=None, seconds=0.5):
+        """
+        LSD radix sort (8 passes of 8 bits) of `keys` random 64-bit keys on `threads`
+        pinned threads (default: all allowed CPUs); swwc scatters through
+        write-combining buffers flushed with non-temporal stores
+        The first sort is checked to be ordered and a permutation of its input
+        Returns: dict with keys/s, effective GB/s and the check's outcome
+        """
+        threads = threads or len(os.sched_getaffinity(0))
+        result = RadixSortResult()
+        rc = self.lib.radix_sort_run(keys, threads, int(swwc), seconds, ctypes.byref(result))
+        self._check(rc, f"Radix sort ({keys} keys)")
+        stats = _to_dict(result)
+        stats['sorted'] = bool(stats['sorted'])
+        stats['threads'] = threads
+        return stats
+
+    def benchmark_hash_join(self, build_rows, probe_rows=None, partition_bits=None, swwc=True, threads=None,
+                            seconds=0.5):
+        """
+        Equi-join of build_rows unique keys with probe_rows (default
+        HASH_JOIN_PROBE_RATIO x) keys that all match, on `threads` pinned threads
+        partition_bits: radix-partition both sides into 2^bits pieces first, 0 = one
+        shared table (default: hash_join_partition_bits(build_rows))
+        Every join is checked for the match count and matched payloads
+        Returns: dict with (build + probe) tuples/s and the share spent partitioning
+        """
+        probe_rows = probe_rows or build_rows * HASH_JOIN_PROBE_RATIO
+        if partition_bits is None:
+            partition_bits = hash_join_partition_bits(build_rows)
+        threads = threads or len(os.sched_getaffinity(0))
+        result = HashJoinResult()
+        rc = self.lib.hash_join_run(build_rows, probe_rows, threads, partition_bits, int(swwc), seconds,
+                                    ctypes.byref(result))
+        self._check(rc, f"Hash join ({build_rows} x {probe_rows}, {partition_bits} partition bits)")
+        stats = _to_dict(result)
+        stats['valid'] = bool(stats['valid'])
+        stats.update({'probe_rows': probe_rows, 'partition_bits': partition_bits, 'threads': threads})
+        return stats
+
+    def sweep_radix_join(self, sort_sizes=None, join_sizes=None, seconds_per_point=0.5, **kwargs):
+        """
+        Radix sort with and without write-combining across sort_sizes (default
+        RADIX_SORT_SIZES), then hash joins with one shared table and partitioned
+        across join_sizes (default HASH_JOIN_SIZES); an empty list skips that workload
+        Sizes that do not fit in memory are skipped
+        Returns: list of result dicts tagged with workload, variant and rows
+        """
+        points = []
+        for keys in RADIX_SORT_SIZES if sort_sizes is None else sort_sizes:
+            for variant, swwc in (('scatter', False), ('swwc', True)):
+                try:
+                    result = self.benchmark_radix_sort(keys, swwc=swwc, seconds=seconds_per_point, **kwargs)
+                except OSError as e:
+                    if e.errno == errno.ENOMEM:
+                        continue
+                    raise
+                result.update({'workload': 'sort', 'variant': variant, 'rows': keys})
+                points.append(result)
+        for rows in HASH_JOIN_SIZES if join_sizes is None else join_sizes:
+            for variant, bits in (('shared', 0), ('partitioned', hash_join_partition_bits(rows, minimum=1))):
+                try:
+                    result = self.benchmark_hash_join(rows, partition_bits=bits, seconds=seconds_per_point, **kwargs)
+                except OSError as e:
+                    if e.errno == errno.ENOMEM:
+                        continue
+                    raise
+                result.update({'workload': 'join', 'variant': variant, 'rows': rows})
+                points.append(result)
+        return points
+
+
+def hash_join_partition_bits(build_rows, minimum=0):
+    """
+    Partition bits that bring each build-side piece down to about
+    HASH_JOIN_PARTITION_ROWS tuples, so its table stays in cache
+    """
+    bits = (max(build_rows - 1, 0) // HASH_JOIN_PARTITION_ROWS).bit_length()
+    return min(max(bits, minimum), HASH_JOIN_MAX_PARTITION_BITS)
+
+
+def thp_setting():
+    """System-wide transparent huge page mode ('always', 'madvise', 'never'), or None"""
+    try:
+        with open(THP_ENABLED) as f:
+            return next((w[1:-1] for w in f.read().split() if w.startswith('[')), None)
+    except OSError:
+        return None
+
+
+def page_fault_scaling(points):
+    """
+    Per mode and page size: single-thread and all-thread GB/s and the scaling
+    efficiency (1.0 = throughput grows linearly with threads)
+    Returns: dict 'mode/page' -> {threads, gb_s_1, gb_s_n, efficiency}
+    """
+    scaling = {}
+    for key in dict.fromkeys((p['mode'], p['page']) for p in points):
+        curve = sorted((p for p in points if (p['mode'], p['page']) == key), key=lambda p: p['threads'])
+        first, last = curve[0], curve[-1]
+        scaling['/'.join(key)] = {
+            'threads': last['threads'], 'gb_s_1': first['gb_s'], 'gb_s_n': last['gb_s'],
+            'efficiency': last['gb_s'] / (first['gb_s'] * last['threads'] / first['threads']) if first['gb_s'] else 0.0,
+        }
+    return scaling
+
+
+def memcpy_crossovers(points):
+    """
+    Fastest implementation per size for each alignment and the sizes where the
+    winner changes
+    Returns: dict alignment -> {'winners': [[size, impl]] by size, 'crossovers': [{size, from, to}]}
+    (winners is a list of pairs so the sizes stay ints through a JSON round trip)
+    """
+    out = {}
+    for alignment in dict.fromkeys(p['alignment'] for p in points):
+        best = {}
+        for p in points:
+            if p['alignment'] == alignment and (p['size'] not in best or p['gb_s'] > best[p['size']]['gb_s']):
+                best[p['size']] = p
+        winners = [[size, best[size]['impl']] for size in sorted(best)]
+        crossovers = []
+        previous = None
+        for size, impl in winners:
+            if previous is not None and impl != previous:
+                crossovers.append({'size': size, 'from': previous, 'to': impl})
+            previous = impl
+        out[alignment] = {'winners': winners, 'crossovers': crossovers}
+    return out
+
+
+def stream_limits(points, drop=0.9):
+    """
+    Per mix: the stream count with peak bandwidth and the first larger count
+    whose bandwidth falls below drop x peak (None while it never does), i.e.
+    where the prefetchers or fill buffers stop keeping up
+    Returns: dict mix -> {peak_streams, peak_gb_s, limit_streams}
+    """
+    limits = {}
+    for mix in dict.fromkeys(p['mix'] for p in points):
+        curve = sorted((p for p in points if p['mix'] == mix), key=lambda p: p['streams'])
+        peak = max(curve, key=lambda p: p['gb_s'])
+        limit = next((p['streams'] for p in curve
+                      if p['streams'] > peak['streams'] and p['gb_s'] < drop * peak['gb_s']), None)
+        limits[mix] = {'peak_streams': peak['streams'], 'peak_gb_s': peak['gb_s'], 'limit_streams': limit}
+    return limits
+
+
+def fit_roofline(points):
+    """
+    Ceilings of a roofline sweep: the memory-bound slope is the best sustained
+    bandwidth and the compute-bound roof the best achieved GFLOPS; they meet
+    at the ridge intensity. Each point is tagged with the ceiling that bounds it
+    Returns: dict with bandwidth_gb_s, peak_gflops, ridge_intensity and points
+    """
+    if not points:
+        return {'bandwidth_gb_s': 0.0, 'peak_gflops': 0.0, 'ridge_intensity': 0.0, 'points': []}
+    bandwidth = max(p['gb_s'] for p in points)
+    peak = max(p['gflops'] for p in points)
+    ridge = peak / bandwidth if bandwidth else 0.0
+    tagged = []
+    for p in points:
+        roof = min(peak, p['intensity'] * bandwidth)
+        tagged.append(dict(p, bound='memory' if p['intensity'] < ridge else 'compute',
+                           efficiency=p['gflops'] / roof if roof else 0.0))
+    return {'bandwidth_gb_s': bandwidth, 'peak_gflops': peak, 'ridge_intensity': ridge, 'points': tagged}
+
+
+def kernel_info():
+    """Kernel release and active CPU vulnerability mitigations, for comparing syscall costs"""
+    mitigations = {}
+    try:
+        for name in sorted(os.listdir(VULNERABILITIES_DIR)):
+            with open(os.path.join(VULNERABILITIES_DIR, name)) as f:
+                mitigations[name] = f.read().strip()
+    except OSError:
+        pass
+    return {'kernel': platform.release(), 'mitigations': mitigations}
+
+
+def merge_sched_latency(total, chunk):
+    """Accumulate one benchmark_sched_latency() chunk into a running per-CPU total"""
+    for cpu, stats in chunk.items():
+        if not stats['samples']:
+            continue
+        acc = total.get(cpu)
+        if acc is None:
+            total[cpu] = dict(stats, histogram=list(stats['histogram']))
+            continue
+        samples = acc['samples'] + stats['samples']
+        acc['avg_ns'] = (acc['avg_ns'] * acc['samples'] + stats['avg_ns'] * stats['samples']) / samples
+        acc['samples'] = samples
+        acc['overflows'] += stats['overflows']
+        acc['min_ns'] = min(acc['min_ns'], stats['min_ns'])
+        acc['max_ns'] = max(acc['max_ns'], stats['max_ns'])
+        acc['realtime'] = min(acc['realtime'], stats['realtime'])
+        acc['histogram'] = [a + b for a, b in zip(acc['histogram'], stats['histogram'])]
+    return total
+
+
+def unpack_sched_latency(per_cpu):
+    """
+    Inverse of the exported per-CPU form (sparse 'histogram_us'), so a resumed
+    run can keep accumulating into checkpointed histograms
+    """
+    total = {}
+    for cpu, stats in per_cpu.items():
+        histogram = [0] * SCHED_LATENCY_BUCKETS
+        for bucket, n in stats['histogram_us'].items():
+            histogram[int(bucket)] = n
+        total[int(cpu)] = dict({k: stats[k] for k in ('samples', 'overflows', 'min_ns', 'avg_ns', 'max_ns', 'realtime')},
+                               histogram=histogram)
+    return total
+
+
+def histogram_percentile(histogram, p, bucket_ns=SCHED_LATENCY_BUCKET_NS):
+    """Upper edge (ns) of the bucket containing the p-th quantile (0..1)"""
+    count = sum(histogram)
+    if count == 0:
+        return 0.0
+    target = p * count
+    seen = 0
+    for i, n in enumerate(histogram):
+        seen += n
+        if seen >= target:
+            return float((i + 1) * bucket_ns)
+    return float(len(histogram) * bucket_ns)
@@ -0,0 +1,87 @@
+"""
+Self-instrumentation for the stress tool
+Scoped timers and counters around the tool's own bookkeeping (sampling,
+exporting, worker scheduling, result merging) so a run can report how much
+of the machine went to the tool rather than to the stress
+"""
+
+import resource
+import sys
+import threading
+import time
+from contextlib import contextmanager
+
+
+def _new_scope():
+    return {'calls': 0, 'wall_s': 0.0, 'cpu_s': 0.0, 'max_wall_s': 0.0, 'net_blocks': 0}
+
+
+class Instrumentation:
+    """Accumulates per-scope wall/CPU time and net allocations, plus counters"""
+
+    def __init__(self):
+        self._lock = threading.Lock()
+        self.scopes = {}
+        self.counters = {}
+        self._start_wall = time.perf_counter()
+        self._start_usage = resource.getrusage(resource.RUSAGE_SELF)
+
+    @contextmanager
+    def scope(self, name):
+        """Time a block: wall time, calling-thread CPU time and net allocated blocks"""
+        wall = time.perf_counter()
+        cpu = time.thread_time()
+        blocks = sys.getallocatedblocks()
+        try:
+            yield
+        finally:
+            wall = time.perf_counter() - wall
+            cpu = time.thread_time() - cpu
+            blocks = sys.getallocatedblocks() - blocks
+            with self._lock:
+                entry = self.scopes.setdefault(name, _new_scope())
+                entry['calls'] += 1
+                entry['wall_s'] += wall
+                entry['cpu_s'] += cpu
+                entry['max_wall_s'] = max(entry['max_wall_s'], wall)
+                entry['net_blocks'] += blocks
+
+    def count(self, name, n=1):
+        with self._lock:
+            self.counters[name] = self.counters.get(name, 0) + n
+
+    def merge_scopes(self, scopes, prefix=''):
+        """Fold scopes reported by a worker process (see report()) into this instance"""
+        with self._lock:
+            for name, other in scopes.items():
+                entry = self.scopes.setdefault(prefix + name, _new_scope())
+                entry['calls'] += other['calls']
+                entry['wall_s'] += other['wall_s']
+                entry['cpu_s'] += other['cpu_s']
+                entry['max_wall_s'] = max(entry['max_wall_s'], other['max_wall_s'])
+                entry['net_blocks'] += other['net_blocks']
+
+    def report(self):
+        """
+        Overhead of this process since construction
+        Returns: dict with process CPU time and share of one core, context
+        switches (wakeups) per second, peak RSS, per-scope totals and counters
+        """
+        usage = resource.getrusage(resource.RUSAGE_SELF)
+        wall = time.perf_counter() - self._start_wall
+        cpu = ((usage.ru_utime - self._start_usage.ru_utime) +
+               (usage.ru_stime - self._start_usage.ru_stime))
+        switches = ((usage.ru_nvcsw - self._start_usage.ru_nvcsw) +
+                    (usage.ru_nivcsw - self._start_usage.ru_nivcsw))
+        with self._lock:
+            scopes = {name: dict(entry) for name, entry in self.scopes.items()}
+            counters = dict(self.counters)
+        return {
+            'wall_s': wall,
+            'cpu_s': cpu,
+            'cpu_percent': 100.0 * cpu / wall if wall > 0 else 0.0,
+            'wakeups_per_sec': switches / wall if wall > 0 else 0.0,
+            'max_rss_kb': usage.ru_maxrss,
+            'scopes': scopes,
+            'counters': counters,
+        }
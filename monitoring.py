@@ -3,33 +3,250 @@ import time
 import threading
 import csv
 import json
+import os
 from collections import defaultdict
 from rich.console import Console
 from rich.table import Table
 import matplotlib.pyplot as plt
 import matplotlib.animation as animation
+from instrumentation import Instrumentation
+from rollup import Rollups
+from runfile import RunWriter, host_manifest
+from topology import DOMAIN_KINDS, Topology, aggregate_per_cpu, format_cpulist, read_node_memory, read_socket_temperatures
+
+SAMPLE_FIELDS = ('time', 'timestamp', 'cpu', 'ram', 'disk', 'net_sent', 'net_recv')
+SAMPLE_METRICS = ('cpu', 'ram', 'disk')
+
+
+def _new_totals():
+    return {'samples': 0, 'sum': {m: 0.0 for m in SAMPLE_METRICS}, 'max': {m: 0.0 for m in SAMPLE_METRICS},
+            'net_sent': 0, 'net_recv': 0, 'gaps': 0, 'gap_s': 0.0}
+
+
+def _new_domain_totals():
+    return {'samples': 0, 'cpu_sum': 0.0, 'cpu_max': 0.0, 'mem_samples': 0, 'mem_sum': 0.0, 'mem_max': 0.0,
+            'local_pages': 0, 'remote_pages': 0}
+
+
+def _domain_value(domains, kind, domain, field):
+    """One per-domain value from a domain sample (keys are ints live, strings once spilled)"""
+    entry = domains[kind].get(domain, domains[kind].get(str(domain)))
+    if entry is None:
+        return None
+    if field == 'mem_used':
+        return 100.0 * entry['used_kb'] / entry['total_kb'] if entry.get('total_kb') else None
+    return entry.get(field)
+
 
 class Monitor:
-    def __init__(self, interval=2):
+    def __init__(self, interval=2, spill_path=None):
+        """
+        spill_path: soak mode; spill() moves collected samples to this JSON-lines
+        file so memory stays flat, while summaries use running totals
+        """
         self.interval = interval
         self.stats = []
+        self.domain_stats = []
+        self.totals = _new_totals()
+        self.rollups = Rollups()
+        self.domain_totals = {kind: {} for kind in DOMAIN_KINDS}
+        self._last_sample = None  # counters of the previous sample, None after a gap
+        self._lock = threading.Lock()
+        self.spill_path = spill_path
+        self._spill_offset = None  # bytes of spill_path that belong to this run, once known
+        self.results = {}
+        self.topology = Topology.from_sysfs()
+        self.instrumentation = Instrumentation()
         self._stop_event = threading.Event()
         self.thread = threading.Thread(target=self._monitor_loop, daemon=True)
         self.console = Console()
 
     def _monitor_loop(self):
         while not self._stop_event.is_set():
-            stat = {
-                'time': time.strftime('%H:%M:%S'),
-                'cpu': psutil.cpu_percent(interval=None),
-                'ram': psutil.virtual_memory().percent,
-                'disk': psutil.disk_usage('/').percent,
-                'net_sent': psutil.net_io_counters().bytes_sent,
-                'net_recv': psutil.net_io_counters().bytes_recv,
-            }
-            self.stats.append(stat)
+            with self.instrumentation.scope('sampler'):
+                stat = {
+                    'time': time.strftime('%H:%M:%S'),
+                    'timestamp': round(time.time(), 3),
+                    'cpu': psutil.cpu_percent(interval=None),
+                    'ram': psutil.virtual_memory().percent,
+                    'disk': psutil.disk_usage('/').percent,
+                    'net_sent': psutil.net_io_counters().bytes_sent,
+                    'net_recv': psutil.net_io_counters().bytes_recv,
+                }
+                self._record(stat, self._sample_domains(stat['time']))
+            self.instrumentation.count('sampler_wakeups')
             time.sleep(self.interval)
 
+    def _sample_domains(self, timestamp):
+        """Per-socket and per-NUMA-node CPU load, temperature and memory for one sample"""
+        per_cpu = dict(enumerate(psutil.cpu_percent(interval=None, percpu=True)))
+        sensors = psutil.sensors_temperatures() if hasattr(psutil, 'sensors_temperatures') else {}
+        temps = read_socket_temperatures(sensors)
+        memory = read_node_memory()
+        sample = {'time': timestamp}
+        for kind in DOMAIN_KINDS:
+            sample[kind] = {}
+            for domain, loads in self.topology.group(per_cpu, kind).items():
+                entry = {'cpu': sum(loads) / len(loads), 'cpu_max': max(loads)}
+                if kind == 'socket' and domain in temps:
+                    entry['temp'] = temps[domain]
+                if kind == 'node' and domain in memory:
+                    entry.update(memory[domain])
+                sample[kind][domain] = entry
+        return sample
+
+    def _record(self, stat, domains):
+        """Keep a sample and fold it into the running totals"""
+        with self._lock:
+            self.stats.append(stat)
+            self.domain_stats.append(domains)
+            totals = self.totals
+            totals['samples'] += 1
+            for metric in SAMPLE_METRICS:
+                totals['sum'][metric] += stat[metric]
+                totals['max'][metric] = max(totals['max'][metric], stat[metric])
+            rollup = {metric: stat[metric] for metric in SAMPLE_METRICS}
+            last = self._last_sample
+            if last is not None:
+                elapsed = stat['timestamp'] - last[0]['timestamp']
+                for counter in ('net_sent', 'net_recv'):
+                    delta = max(stat[counter] - last[0][counter], 0)
+                    totals[counter] += delta
+                    if elapsed > 0:
+                        rollup[f'{counter}_rate'] = delta / elapsed
+            self.rollups.add(stat['timestamp'], rollup)
+            for kind in DOMAIN_KINDS:
+                for domain, entry in domains[kind].items():
+                    acc = self.domain_totals[kind].setdefault(str(domain), _new_domain_totals())
+                    acc['samples'] += 1
+                    acc['cpu_sum'] += entry['cpu']
+                    acc['cpu_max'] = max(acc['cpu_max'], entry['cpu_max'])
+                    if 'temp' in entry:
+                        acc['temp_max'] = max(acc.get('temp_max', entry['temp']), entry['temp'])
+                    if entry.get('total_kb'):
+                        used = 100.0 * entry['used_kb'] / entry['total_kb']
+                        acc['mem_samples'] += 1
+                        acc['mem_sum'] += used
+                        acc['mem_max'] = max(acc['mem_max'], used)
+                    previous = last[1][kind].get(domain) if last is not None else None
+                    if previous is not None and 'local_pages' in entry:
+                        acc['local_pages'] += max(entry['local_pages'] - previous['local_pages'], 0)
+                        acc['remote_pages'] += max(entry['remote_pages'] - previous['remote_pages'], 0)
+            self._last_sample = (stat, domains)
+
+    def mark_gap(self, seconds):
+        """
+        Insert a gap marker into the time series (e.g. a soak run resumed after a
+        reboot); counter deltas are not carried across the gap
+        """
+        timestamp = time.strftime('%H:%M:%S')
+        marker = dict({field: None for field in SAMPLE_FIELDS}, time=timestamp,
+                      timestamp=round(time.time(), 3), gap_s=seconds)
+        with self._lock:
+            self.stats.append(marker)
+            self.domain_stats.append(dict({kind: {} for kind in DOMAIN_KINDS}, time=timestamp, gap_s=seconds))
+            self.totals['gaps'] += 1
+            self.totals['gap_s'] += seconds
+            self._last_sample = None
+
+    def spill(self):
+        """
+        Append collected samples to spill_path and drop them from memory
+        Returns: size of the spill file, to be recorded in a checkpoint
+        """
+        with self._lock:
+            stats, domain_stats = self._take_samples()
+        return self._write_spill(stats, domain_stats)
+
+    def _take_samples(self):
+        stats, domain_stats = self.stats, self.domain_stats
+        self.stats, self.domain_stats = [], []
+        return stats, domain_stats
+
+    def _write_spill(self, stats, domain_stats):
+        with self.instrumentation.scope('spill'):
+            with open(self.spill_path, 'ab') as f:
+                if self._spill_offset is None:
+                    f.truncate(0)  # fresh run: discard samples from an earlier one
+                for stat, domains in zip(stats, domain_stats):
+                    f.write(json.dumps({'sample': stat, 'domains': domains}).encode() + b'\n')
+                f.flush()
+                os.fsync(f.fileno())
+                self._spill_offset = f.tell()
+        return self._spill_offset
+
+    def iter_samples(self):
+        """(sample, per-domain sample) pairs for the whole run, spilled ones first"""
+        if self.spill_path and self._spill_offset:
+            with open(self.spill_path, 'rb') as f:
+                for line in f:
+                    record = json.loads(line)
+                    yield record['sample'], record['domains']
+        with self._lock:
+            pairs = list(zip(self.stats, self.domain_stats))
+        yield from pairs
+
+    def checkpoint_state(self):
+        """Spill samples and return the running totals needed to resume (see restore_state)"""
+        # Take the samples and the totals together so they describe the same instant
+        with self._lock:
+            state = {'totals': json.loads(json.dumps(self.totals)),
+                     'domain_totals': json.loads(json.dumps(self.domain_totals)),
+                     'rollups': self.rollups.to_dict()}
+            spilled = self._take_samples() if self.spill_path else None
+        state['spill_offset'] = self._write_spill(*spilled) if spilled else 0
+        return state
+
+    def restore_state(self, state, gap_seconds):
+        """
+        Continue from a checkpoint_state(): samples spilled after that checkpoint
+        are discarded and a gap marker covers the time the run was down
+        """
+        with self._lock:
+            self.totals = state['totals']
+            self.domain_totals = state['domain_totals']
+            if 'rollups' in state:
+                self.rollups = Rollups.from_dict(state['rollups'])
+        if self.spill_path:
+            with open(self.spill_path, 'ab') as f:
+                f.truncate(state['spill_offset'])
+            self._spill_offset = state['spill_offset']
+        self.mark_gap(gap_seconds)
+
+    def domain_summary(self):
+        """
+        Per-socket and per-NUMA-node aggregates over the run, plus per-CPU
+        stressor results grouped by the same domains
+        Returns: {'socket': {id: {...}}, 'node': {id: {...}}}
+        """
+        summary = {}
+        for kind in DOMAIN_KINDS:
+            summary[kind] = {}
+            for domain, cpus in self.topology.domains(kind).items():
+                acc = self.domain_totals[kind].get(str(domain))
+                entry = {'cpus': format_cpulist(cpus)}
+                if acc and acc['samples']:
+                    entry['cpu_avg'] = acc['cpu_sum'] / acc['samples']
+                    entry['cpu_max'] = acc['cpu_max']
+                    if 'temp_max' in acc:
+                        entry['temp_max'] = acc['temp_max']
+                    if acc['mem_samples']:
+                        entry['mem_used_avg'] = acc['mem_sum'] / acc['mem_samples']
+                        entry['mem_used_max'] = acc['mem_max']
+                    allocations = acc['local_pages'] + acc['remote_pages']
+                    if allocations:
+                        entry['remote_alloc_percent'] = 100.0 * acc['remote_pages'] / allocations
+                stressors = {}
+                for name, result in self.results.items():
+                    if isinstance(result.get('per_cpu'), dict):
+                        aggregated = aggregate_per_cpu(result['per_cpu'], self.topology, kind)
+                        if str(domain) in aggregated:
+                            stressors[name] = aggregated[str(domain)]
+                if stressors:
+                    entry['stressors'] = stressors
+                summary[kind][str(domain)] = entry
+        return summary
+
     def start(self):
         self.thread.start()
 
@@ -38,57 +255,140 @@ class Monitor:
         self.thread.join()
 
     def export_csv(self, filename):
-        if not self.stats:
+        if not self.totals['samples']:
             return
-        with open(filename, 'w', newline='') as f:
-            writer = csv.DictWriter(f, fieldnames=self.stats[0].keys())
-            writer.writeheader()
-            writer.writerows(self.stats)
+        with self.instrumentation.scope('export_csv'):
+            with open(filename, 'w', newline='') as f:
+                # Gap markers become rows with empty metrics
+                writer = csv.DictWriter(f, fieldnames=SAMPLE_FIELDS, extrasaction='ignore')
+                writer.writeheader()
+                writer.writerows(stat for stat, _ in self.iter_samples())
 
     def export_json(self, filename):
-        with open(filename, 'w') as f:
-            json.dump(self.stats, f, indent=2)
+        with self.instrumentation.scope('export_json'):
+            with open(filename, 'w') as f:
+                # Samples are streamed so a spilled soak run is never loaded into memory at once
+                f.write('{\n  "samples": [')
+                for i, (stat, _) in enumerate(self.iter_samples()):
+                    f.write((',\n    ' if i else '\n    ') + json.dumps(stat))
+                f.write('\n  ],\n  "domain_samples": [')
+                for i, (_, domains) in enumerate(self.iter_samples()):
+                    f.write((',\n    ' if i else '\n    ') + json.dumps(domains))
+                f.write('\n  ],\n')
+                rest = json.dumps({'manifest': host_manifest(), 'results': self.results,
+                                   'topology': self.topology.to_dict(),
+                                   'domains': self.domain_summary(), 'rollups': self._rollups_snapshot(),
+                                   'tool_overhead': self.tool_overhead()},
+                                  indent=2)
+                f.write(rest[2:])
+
+    def _bin_columns(self):
+        """Flat (metric, getter) columns of the binary export: host metrics, then per-domain ones"""
+        columns = [(field, lambda stat, _, field=field: stat[field]) for field in SAMPLE_FIELDS[2:]]
+        for kind, fields in (('socket', ('cpu', 'temp')), ('node', ('cpu', 'mem_used'))):
+            for domain in self.topology.domains(kind):
+                for field in fields:
+                    columns.append((f'{kind}{domain}.{field}',
+                                    lambda _, domains, kind=kind, domain=domain, field=field:
+                                        _domain_value(domains, kind, domain, field)))
+        return columns
+
+    def export_bin(self, filename):
+        """Write the run in the binary run format (see runfile.py)"""
+        with self.instrumentation.scope('export_bin'):
+            columns = self._bin_columns()
+            writer = RunWriter(filename, [name for name, _ in columns], manifest=host_manifest())
+            events = []
+            for stat, domains in self.iter_samples():
+                if 'gap_s' in stat:
+                    events.append({'timestamp': stat['timestamp'], 'type': 'gap', 'seconds': stat['gap_s']})
+                writer.write(stat['timestamp'], {name: get(stat, domains) for name, get in columns})
+            writer.close({'manifest': host_manifest(), 'interval': self.interval, 'events': events,
+                          'results': self.results, 'topology': self.topology.to_dict(),
+                          'domains': self.domain_summary(), 'rollups': self._rollups_snapshot(),
+                          'tool_overhead': self.tool_overhead()})
+
+    def _rollups_snapshot(self):
+        with self._lock:
+            return self.rollups.to_dict()
+
+    def add_results(self, results):
+        """Store stressor results, folding worker bookkeeping ('overhead' scopes) into the tool overhead"""
+        for name, result in results.items():
+            overhead = result.pop('overhead', None)
+            if overhead:
+                self.instrumentation.merge_scopes(overhead, prefix=f"{name}.")
+            self.results[name] = result
+
+    def tool_overhead(self):
+        """The tool's own cost (see Instrumentation.report)"""
+        return self.instrumentation.report()
 
     def print_summary(self):
-        if not self.stats:
+        totals = self.totals
+        if not totals['samples']:
             print('No stats collected.')
             return
-        cpu_vals = [s['cpu'] for s in self.stats]
-        ram_vals = [s['ram'] for s in self.stats]
-        disk_vals = [s['disk'] for s in self.stats]
-        net_sent = [s['net_sent'] for s in self.stats]
-        net_recv = [s['net_recv'] for s in self.stats]
+        averages = {m: totals['sum'][m] / totals['samples'] for m in SAMPLE_METRICS}
         print('\n--- Summary Report ---')
-        print(f"CPU: avg={sum(cpu_vals)/len(cpu_vals):.1f}%, max={max(cpu_vals):.1f}%")
-        print(f"RAM: avg={sum(ram_vals)/len(ram_vals):.1f}%, max={max(ram_vals):.1f}%")
-        print(f"Disk: avg={sum(disk_vals)/len(disk_vals):.1f}%, max={max(disk_vals):.1f}%")
-        print(f"Network sent: {net_sent[-1] - net_sent[0]} bytes, recv: {net_recv[-1] - net_recv[0]} bytes")
+        print(f"CPU: avg={averages['cpu']:.1f}%, max={totals['max']['cpu']:.1f}%")
+        print(f"RAM: avg={averages['ram']:.1f}%, max={totals['max']['ram']:.1f}%")
+        print(f"Disk: avg={averages['disk']:.1f}%, max={totals['max']['disk']:.1f}%")
+        print(f"Network sent: {totals['net_sent']} bytes, recv: {totals['net_recv']} bytes")
+        if totals['gaps']:
+            print(f"Gaps: {totals['gaps']} (resumed runs, {totals['gap_s']:.0f}s without samples)")
+        if self.results:
+            print('\n--- Stressor Results ---')
+            for name, result in self.results.items():
+                print(f"{name}: {result.get('summary', '')}")
+        domains = self.domain_summary()
+        for kind, title in (('socket', 'Per-Socket'), ('node', 'Per-NUMA-Node')):
+            print(f'\n--- {title} ---')
+            for domain, entry in domains[kind].items():
+                line = f"{kind} {domain} (CPUs {entry['cpus']}):"
+                if 'cpu_avg' in entry:
+                    line += f" CPU avg={entry['cpu_avg']:.1f}%, max={entry['cpu_max']:.1f}%"
+                if 'temp_max' in entry:
+                    line += f", temp max={entry['temp_max']:.0f}C"
+                if 'mem_used_max' in entry:
+                    line += f", RAM avg={entry['mem_used_avg']:.1f}%, max={entry['mem_used_max']:.1f}%"
+                if 'remote_alloc_percent' in entry:
+                    line += f", remote allocs={entry['remote_alloc_percent']:.1f}%"
+                print(line)
+                for name, result in entry.get('stressors', {}).items():
+                    if 'max_ns' in result:
+                        worst_p99 = f", p99 {result['p99_ns'] / 1000:.0f}us" if 'p99_ns' in result else ''
+                        print(f"  {name}: max {result['max_ns'] / 1000:.1f}us{worst_p99} over {result['cpus']} CPUs")
+        overhead = self.tool_overhead()
+        print('\n--- Tool Overhead ---')
+        print(f"CPU: {overhead['cpu_s']:.2f}s ({overhead['cpu_percent']:.2f}% of one core), "
+              f"wakeups: {overhead['wakeups_per_sec']:.1f}/s, peak RSS: {overhead['max_rss_kb'] / 1024:.1f}MB")
+        for name, scope in sorted(overhead['scopes'].items()):
+            print(f"  {name}: {scope['calls']} calls, {scope['cpu_s'] * 1000:.1f}ms CPU, "
+                  f"max {scope['max_wall_s'] * 1000:.2f}ms, {scope['net_blocks']:+d} blocks")
 
-    def live_graph(self):
+    def live_graph(self, max_points=600):
+        """Live plot read from the rollup tiers, so redraws stay cheap however long the run is"""
         plt.ion()
         fig, ax = plt.subplots()
-        cpu_vals, ram_vals, disk_vals, times = [], [], [], []
-        line_cpu, = ax.plot([], [], label='CPU %')
-        line_ram, = ax.plot([], [], label='RAM %')
-        line_disk, = ax.plot([], [], label='Disk %')
+        lines = {metric: ax.plot([], [], label=label)[0]
+                 for metric, label in (('cpu', 'CPU %'), ('ram', 'RAM %'), ('disk', 'Disk %'))}
         ax.set_ylim(0, 100)
-        ax.set_xlabel('Time (samples)')
+        ax.set_xlabel('Time (s)')
         ax.set_ylabel('Usage (%)')
         ax.legend()
         fig.suptitle('Live System Usage')
+        start = time.time()
 
         def update(frame):
-            if not self.stats:
-                return line_cpu, line_ram, line_disk
-            cpu_vals.append(self.stats[-1]['cpu'])
-            ram_vals.append(self.stats[-1]['ram'])
-            disk_vals.append(self.stats[-1]['disk'])
-            times.append(len(times))
-            line_cpu.set_data(times, cpu_vals)
-            line_ram.set_data(times, ram_vals)
-            line_disk.set_data(times, disk_vals)
-            ax.set_xlim(0, max(10, len(times)))
-            return line_cpu, line_ram, line_disk
+            with self._lock:
+                series = {metric: self.rollups.series(metric, max_points) for metric in lines}
+            for metric, line in lines.items():
+                line.set_data([t - start for t in series[metric]['time']], series[metric]['mean'])
+            times = series['cpu']['time']
+            if times:
+                ax.set_xlim(min(0, times[0] - start), max(10, times[-1] - start))
+            return tuple(lines.values())
 
         ani = animation.FuncAnimation(fig, update, interval=self.interval*1000, blit=False)
-        plt.show(block=True) 
\ No newline at end of file
+        plt.show(block=True)
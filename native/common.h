@@ -0,0 +1,103 @@
+/**
+ * Shared helpers for the native host benchmarks
+ * Exposed to Python through ctypes (see host_benchmark.py)
+ */
+
+#pragma once
+
+#include <linux/futex.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#define HS_EXPORT extern "C" __attribute__((visibility("default")))
+
+namespace hs {
+
+/**
+ * Monotonic clock in nanoseconds
+ */
+inline uint64_t now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+/**
+ * Pin the calling thread to one CPU; cpu < 0 leaves it unpinned
+ */
+inline int pin_to_cpu(int cpu) {
+    if (cpu < 0) {
+        return 0;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+/**
+ * Sleep while *addr == val; shared = true for futexes in memory mapped into
+ * several processes (process-private otherwise). A relative timeout ends the
+ * wait with ETIMEDOUT
+ */
+inline long futex_wait(std::atomic<uint32_t>* addr, uint32_t val, bool shared = false,
+                       const timespec* timeout = nullptr) {
+    return syscall(SYS_futex, reinterpret_cast<uint32_t*>(addr), shared ? FUTEX_WAIT : FUTEX_WAIT_PRIVATE, val,
+                   timeout, nullptr, 0);
+}
+
+/**
+ * Wake up to n waiters sleeping on addr
+ */
+inline long futex_wake(std::atomic<uint32_t>* addr, int n, bool shared = false) {
+    return syscall(SYS_futex, reinterpret_cast<uint32_t*>(addr), shared ? FUTEX_WAKE : FUTEX_WAKE_PRIVATE, n,
+                   nullptr, nullptr, 0);
+}
+
+/**
+ * Sense-reversing barrier for a fixed set of threads; waiters yield so
+ * oversubscribed runs still make progress
+ */
+class Barrier {
+public:
+    explicit Barrier(int n) : n_(n) {}
+    void wait() {
+        bool sense = sense_.load(std::memory_order_relaxed);
+        if (arrived_.fetch_add(1, std::memory_order_acq_rel) + 1 == n_) {
+            arrived_.store(0, std::memory_order_relaxed);
+            sense_.store(!sense, std::memory_order_release);
+        } else {
+            while (sense_.load(std::memory_order_acquire) == sense) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+private:
+    int n_;
+    std::atomic<int> arrived_{0};
+    std::atomic<bool> sense_{false};
+};
+
+/**
+ * Percentile of an unsorted sample vector (sorts in place)
+ */
+inline double percentile(std::vector<uint64_t>& samples, double p) {
+    if (samples.empty()) {
+        return 0.0;
+    }
+    std::sort(samples.begin(), samples.end());
+    size_t idx = (size_t)(p * (samples.size() - 1));
+    return (double)samples[idx];
+}
+
+}  // namespace hs
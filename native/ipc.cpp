@@ -0,0 +1,542 @@
+/**
+ * Same-host IPC throughput and round-trip latency benchmark
+ * Covers pipes, UNIX stream/datagram sockets, socketpair and a
+ * shared-memory ring with futex wakeups
+ * The peer runs in a forked process, so every message crosses address
+ * spaces and pays the mm/TLB switch real IPC does
+ */
+
+#include "timing.h"
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+#include <memory>
+#include <thread>
+
+enum IpcTransport {
+    IPC_PIPE = 0,
+    IPC_UNIX_STREAM = 1,
+    IPC_UNIX_DGRAM = 2,
+    IPC_SOCKETPAIR = 3,
+    IPC_SHM_FUTEX = 4,
+};
+
+struct ipc_result {
+    double bandwidth_mb_s;     // forked writer -> this process's reader
+    double messages_per_sec;
+    double rtt_avg_ns;
+    double rtt_p50_ns;
+    double rtt_p99_ns;
+    uint64_t round_trips;      // this process sends, the forked peer echoes
+};
+
+namespace {
+
+const size_t MAX_DGRAM_SIZE = 64 * 1024;
+const size_t RING_CAPACITY = 4 * 1024 * 1024;
+const size_t MAX_RTT_SAMPLES = 1 << 20;
+const long PEER_CHECK_NS = 10 * 1000 * 1000;  // futex sleep slice between peer liveness checks
+
+/**
+ * One direction of a channel: a writer end and a reader end
+ */
+class Link {
+public:
+    virtual ~Link() {}
+    virtual bool send(const char* buf, size_t len) = 0;
+    virtual bool recv(char* buf, size_t len) = 0;  // false on end of stream
+    virtual void close_writer() = 0;
+    // After fork: drop this process's copy of the end it does not use, so end of
+    // stream is seen once the other process closes its writer
+    virtual void release(bool keep_writer) = 0;
+    // After fork, in the parent: the child on the other end. Only links without
+    // a kernel-side end of stream need it to notice the child dying
+    virtual void watch(pid_t) {}
+};
+
+bool write_all(int fd, const char* buf, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, buf, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        buf += n;
+        len -= n;
+    }
+    return true;
+}
+
+bool read_all(int fd, char* buf, size_t len) {
+    while (len > 0) {
+        ssize_t n = read(fd, buf, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        buf += n;
+        len -= n;
+    }
+    return true;
+}
+
+/**
+ * Byte-stream link over a pair of file descriptors (pipe, stream socket)
+ */
+class FdLink : public Link {
+public:
+    FdLink(int rfd, int wfd, bool socket) : rfd_(rfd), wfd_(wfd), socket_(socket) {}
+    ~FdLink() override {
+        close_writer();
+        if (rfd_ >= 0) close(rfd_);
+    }
+    bool send(const char* buf, size_t len) override { return write_all(wfd_, buf, len); }
+    bool recv(char* buf, size_t len) override { return read_all(rfd_, buf, len); }
+    void close_writer() override {
+        if (wfd_ < 0) return;
+        // The socket may be dup'ed into the reverse link, so signal EOF explicitly
+        if (socket_) shutdown(wfd_, SHUT_WR);
+        close(wfd_);
+        wfd_ = -1;
+    }
+    void release(bool keep_writer) override {
+        // A plain close: shutdown() would act on the socket the other process still uses
+        int& fd = keep_writer ? rfd_ : wfd_;
+        if (fd >= 0) close(fd);
+        fd = -1;
+    }
+
+private:
+    int rfd_;
+    int wfd_;
+    bool socket_;
+};
+
+/**
+ * Datagram link: one message per datagram, empty datagram marks the end
+ */
+class DgramLink : public Link {
+public:
+    DgramLink(int rfd, int wfd) : rfd_(rfd), wfd_(wfd) {}
+    ~DgramLink() override {
+        close(rfd_);
+        close(wfd_);
+    }
+    bool send(const char* buf, size_t len) override {
+        while (::send(wfd_, buf, len, 0) < 0) {
+            if (errno != EINTR && errno != ENOBUFS) return false;
+        }
+        return true;
+    }
+    bool recv(char* buf, size_t len) override {
+        ssize_t n;
+        while ((n = ::recv(rfd_, buf, len, 0)) < 0) {
+            if (errno != EINTR) return false;
+        }
+        return n > 0;
+    }
+    void close_writer() override { ::send(wfd_, "", 0, 0); }
+    void release(bool) override {}  // the end marker is explicit
+
+private:
+    int rfd_;
+    int wfd_;
+};
+
+/**
+ * Single-producer single-consumer byte ring in MAP_SHARED memory, inherited
+ * across fork; the sides spin briefly and then sleep on a shared futex
+ * sequence word. A watched peer killed before it could close the ring ends
+ * the wait with ECHILD instead of leaving this side asleep
+ */
+class ShmRingLink : public Link {
+public:
+    ShmRingLink() {
+        mem_ = mmap(nullptr, sizeof(Shared) + RING_CAPACITY, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (mem_ == MAP_FAILED) {
+            mem_ = nullptr;
+            return;
+        }
+        shared_ = new (mem_) Shared();
+        data_ = static_cast<char*>(mem_) + sizeof(Shared);
+    }
+    ~ShmRingLink() override {
+        if (mem_) munmap(mem_, sizeof(Shared) + RING_CAPACITY);
+    }
+    bool ok() const { return mem_ != nullptr; }
+
+    bool send(const char* buf, size_t len) override {
+        while (len > 0) {
+            uint64_t head = shared_->head.load(std::memory_order_relaxed);
+            uint64_t free_bytes;
+            if (!wait_until(shared_->space_seq, shared_->space_waiters, [&] {
+                    free_bytes = RING_CAPACITY - (head - shared_->tail.load(std::memory_order_acquire));
+                    return free_bytes > 0;
+                })) {
+                return false;
+            }
+            size_t chunk = std::min<size_t>(len, free_bytes);
+            copy_in(head, buf, chunk);
+            shared_->head.store(head + chunk, std::memory_order_release);
+            wake(shared_->data_seq, shared_->data_waiters);
+            buf += chunk;
+            len -= chunk;
+        }
+        return true;
+    }
+
+    bool recv(char* buf, size_t len) override {
+        while (len > 0) {
+            uint64_t tail = shared_->tail.load(std::memory_order_relaxed);
+            uint64_t avail;
+            if (!wait_until(shared_->data_seq, shared_->data_waiters, [&] {
+                    avail = shared_->head.load(std::memory_order_acquire) - tail;
+                    return avail > 0 || shared_->closed.load(std::memory_order_acquire);
+                })) {
+                return false;
+            }
+            if (avail == 0) return false;
+            size_t chunk = std::min<size_t>(len, avail);
+            copy_out(tail, buf, chunk);
+            shared_->tail.store(tail + chunk, std::memory_order_release);
+            wake(shared_->space_seq, shared_->space_waiters);
+            buf += chunk;
+            len -= chunk;
+        }
+        return true;
+    }
+
+    void close_writer() override {
+        shared_->closed.store(true, std::memory_order_release);
+        wake(shared_->data_seq, shared_->data_waiters);
+    }
+
+    void release(bool) override {}
+    void watch(pid_t pid) override { peer_ = pid; }
+
+private:
+    struct Shared {
+        alignas(64) std::atomic<uint64_t> head{0};
+        alignas(64) std::atomic<uint64_t> tail{0};
+        alignas(64) std::atomic<uint32_t> data_seq{0};
+        std::atomic<uint32_t> data_waiters{0};
+        alignas(64) std::atomic<uint32_t> space_seq{0};
+        std::atomic<uint32_t> space_waiters{0};
+        std::atomic<bool> closed{false};
+    };
+
+    // False (errno ECHILD) if the watched peer exited while ready() never held
+    template <typename Pred>
+    bool wait_until(std::atomic<uint32_t>& seq, std::atomic<uint32_t>& waiters, Pred ready) {
+        for (int spin = 0; spin < 200; ++spin) {
+            if (ready()) return true;
+            hs::cpu_relax();
+        }
+        const timespec slice = {0, PEER_CHECK_NS};
+        for (;;) {
+            uint32_t s = seq.load();
+            if (ready()) return true;
+            waiters.fetch_add(1);
+            long rc = hs::futex_wait(&seq, s, true, peer_ > 0 ? &slice : nullptr);
+            int err = errno;
+            waiters.fetch_sub(1);
+            if (rc < 0 && err == ETIMEDOUT && peer_exited()) {
+                if (ready()) return true;
+                errno = ECHILD;
+                return false;
+            }
+        }
+    }
+
+    // Peeks without reaping, so reap_peer still sees how the peer ended
+    bool peer_exited() const {
+        siginfo_t info;
+        info.si_pid = 0;
+        return waitid(P_PID, peer_, &info, WEXITED | WNOHANG | WNOWAIT) < 0 || info.si_pid != 0;
+    }
+
+    static void wake(std::atomic<uint32_t>& seq, std::atomic<uint32_t>& waiters) {
+        seq.fetch_add(1);
+        if (waiters.load()) {
+            hs::futex_wake(&seq, 1, true);
+        }
+    }
+
+    void copy_in(uint64_t pos, const char* src, size_t len) {
+        size_t off = pos % RING_CAPACITY;
+        size_t first = std::min(len, RING_CAPACITY - off);
+        memcpy(data_ + off, src, first);
+        memcpy(data_, src + first, len - first);
+    }
+
+    void copy_out(uint64_t pos, char* dst, size_t len) {
+        size_t off = pos % RING_CAPACITY;
+        size_t first = std::min(len, RING_CAPACITY - off);
+        memcpy(dst, data_ + off, first);
+        memcpy(dst + first, data_, len - first);
+    }
+
+    void* mem_ = nullptr;
+    Shared* shared_ = nullptr;
+    char* data_ = nullptr;
+    pid_t peer_ = -1;
+};
+
+/**
+ * Abstract-namespace address (leading NUL): nothing is left on the filesystem
+ */
+socklen_t abstract_addr(sockaddr_un& addr, const char* tag, int id) {
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    int len = snprintf(addr.sun_path + 1, sizeof(addr.sun_path) - 1, "hoststress-%d-%s-%d", getpid(), tag, id);
+    return offsetof(sockaddr_un, sun_path) + 1 + len;
+}
+
+int bind_abstract(int fd, const char* tag, int id) {
+    sockaddr_un addr;
+    socklen_t len = abstract_addr(addr, tag, id);
+    return bind(fd, reinterpret_cast<sockaddr*>(&addr), len);
+}
+
+int connect_abstract(int fd, const char* tag, int id) {
+    sockaddr_un addr;
+    socklen_t len = abstract_addr(addr, tag, id);
+    return connect(fd, reinterpret_cast<sockaddr*>(&addr), len);
+}
+
+/**
+ * Create the two directions (a -> b, b -> a) of a channel
+ */
+int make_channel(int transport, std::unique_ptr<Link>& ab, std::unique_ptr<Link>& ba) {
+    static std::atomic<int> next_id{0};
+    switch (transport) {
+        case IPC_PIPE: {
+            int p1[2], p2[2];
+            if (pipe(p1) < 0) return -errno;
+            if (pipe(p2) < 0) {
+                int err = errno;
+                close(p1[0]);
+                close(p1[1]);
+                return -err;
+            }
+            ab.reset(new FdLink(p1[0], p1[1], false));
+            ba.reset(new FdLink(p2[0], p2[1], false));
+            return 0;
+        }
+        case IPC_SOCKETPAIR: {
+            int sv[2];
+            if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0) return -errno;
+            ab.reset(new FdLink(sv[1], sv[0], true));
+            ba.reset(new FdLink(dup(sv[0]), dup(sv[1]), true));
+            return 0;
+        }
+        case IPC_UNIX_STREAM: {
+            int id = next_id++;
+            int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+            if (listener < 0) return -errno;
+            if (bind_abstract(listener, "stream", id) < 0 || listen(listener, 1) < 0) {
+                int err = errno;
+                close(listener);
+                return -err;
+            }
+            int client = socket(AF_UNIX, SOCK_STREAM, 0);
+            if (client < 0 || connect_abstract(client, "stream", id) < 0) {
+                int err = errno;
+                if (client >= 0) close(client);
+                close(listener);
+                return -err;
+            }
+            int server = accept(listener, nullptr, nullptr);
+            close(listener);
+            if (server < 0) {
+                int err = errno;
+                close(client);
+                return -err;
+            }
+            ab.reset(new FdLink(server, client, true));
+            ba.reset(new FdLink(dup(client), dup(server), true));
+            return 0;
+        }
+        case IPC_UNIX_DGRAM: {
+            int id = next_id++;
+            int a = socket(AF_UNIX, SOCK_DGRAM, 0);
+            int b = socket(AF_UNIX, SOCK_DGRAM, 0);
+            if (a < 0 || b < 0 ||
+                bind_abstract(a, "dgram-a", id) < 0 || bind_abstract(b, "dgram-b", id) < 0 ||
+                connect_abstract(a, "dgram-b", id) < 0 || connect_abstract(b, "dgram-a", id) < 0) {
+                int err = errno;
+                if (a >= 0) close(a);
+                if (b >= 0) close(b);
+                return -err;
+            }
+            ab.reset(new DgramLink(b, a));
+            ba.reset(new DgramLink(dup(a), dup(b)));
+            return 0;
+        }
+        case IPC_SHM_FUTEX: {
+            ShmRingLink* l1 = new ShmRingLink();
+            ShmRingLink* l2 = new ShmRingLink();
+            ab.reset(l1);
+            ba.reset(l2);
+            return (l1->ok() && l2->ok()) ? 0 : -ENOMEM;
+        }
+        default:
+            return -EINVAL;
+    }
+}
+
+/**
+ * Fork the peer side of a measurement: the child pins itself to cpu, runs fn
+ * (which returns 0 or an errno) and leaves with _exit; it is killed if this
+ * thread goes away first. fn must only use memory allocated before the fork
+ */
+template <typename Fn>
+pid_t spawn_peer(int cpu, Fn fn) {
+    pid_t parent = getpid();
+    pid_t pid = fork();
+    if (pid == 0) {
+        prctl(PR_SET_PDEATHSIG, SIGKILL);
+        if (getppid() != parent) _exit(ECHILD);
+        hs::pin_to_cpu(cpu);
+        _exit(fn());
+    }
+    return pid;
+}
+
+/**
+ * Wait for the peer; 0 if it succeeded, otherwise the negative errno it
+ * exited with (-ECHILD if it was killed)
+ */
+int reap_peer(pid_t pid) {
+    int status;
+    while (waitpid(pid, &status, 0) < 0) {
+        if (errno != EINTR) return -errno;
+    }
+    if (!WIFEXITED(status)) return -ECHILD;
+    return -WEXITSTATUS(status);
+}
+
+}  // namespace
+
+/**
+ * Measure one (transport, message size, placement) point
+ * The first half of the time streams messages a -> b for bandwidth, the
+ * second half ping-pongs them for round-trip latency. The streaming writer
+ * and the echoing peer are forked; the reader and the timed client run here
+ * Returns 0 on success or a negative errno
+ */
+HS_EXPORT int ipc_benchmark(int transport, size_t msg_size, int cpu_a, int cpu_b,
+                            double seconds, ipc_result* out) {
+    if (msg_size == 0 || !out) return -EINVAL;
+    if (transport == IPC_UNIX_DGRAM && msg_size > MAX_DGRAM_SIZE) return -EMSGSIZE;
+    memset(out, 0, sizeof(*out));
+    std::vector<char> buf(msg_size, 'x');
+
+    // Bandwidth: the forked writer streams until the deadline, then closes its end;
+    // the rate is taken from the first message received to the end of stream
+    {
+        std::unique_ptr<Link> ab, ba;
+        int rc = make_channel(transport, ab, ba);
+        if (rc < 0) return rc;
+        uint64_t deadline = hs::ticks() + hs::ns_to_ticks((uint64_t)(seconds * 0.5e9));
+        pid_t writer = spawn_peer(cpu_a, [&] {
+            ab->release(true);
+            int err = 0;
+            while (!err && hs::ticks() < deadline) {
+                for (int i = 0; i < 16; ++i) {
+                    if (!ab->send(buf.data(), msg_size)) {
+                        err = errno ? errno : EPIPE;
+                        break;
+                    }
+                }
+            }
+            ab->close_writer();
+            return err;
+        });
+        if (writer < 0) return -errno;
+        ab->release(false);
+        ab->watch(writer);
+        uint64_t received = 0, first = 0, last = 0;
+        std::thread reader([&] {
+            hs::pin_to_cpu(cpu_b);
+            std::vector<char> rbuf(msg_size);
+            while (ab->recv(rbuf.data(), msg_size)) {
+                if (received++ == 0) first = hs::now_ns();
+            }
+            last = hs::now_ns();
+        });
+        reader.join();
+        rc = reap_peer(writer);
+        if (rc < 0) return rc;
+        if (received > 1) {
+            double elapsed = (last - first) / 1e9;
+            out->messages_per_sec = (received - 1) / elapsed;
+            out->bandwidth_mb_s = (received - 1) * (double)msg_size / elapsed / (1024.0 * 1024.0);
+        }
+    }
+
+    // Latency: a sends, the forked b echoes, a times the round trip
+    {
+        std::unique_ptr<Link> ab, ba;
+        int rc = make_channel(transport, ab, ba);
+        if (rc < 0) return rc;
+        pid_t echo = spawn_peer(cpu_b, [&] {
+            ab->release(false);
+            ba->release(true);
+            int err = 0;
+            while (ab->recv(buf.data(), msg_size)) {
+                if (!ba->send(buf.data(), msg_size)) {
+                    err = errno ? errno : EPIPE;
+                    break;
+                }
+            }
+            ba->close_writer();
+            return err;
+        });
+        if (echo < 0) return -errno;
+        ab->release(true);
+        ba->release(false);
+        ab->watch(echo);
+        ba->watch(echo);
+        std::vector<uint64_t> samples;
+        uint64_t total = 0;
+        int err = 0;
+        std::thread client([&] {
+            hs::pin_to_cpu(cpu_a);
+            std::vector<char> cbuf(msg_size, 'y');
+            samples.reserve(4096);
+            uint64_t deadline = hs::ticks() + hs::ns_to_ticks((uint64_t)(seconds * 0.5e9));
+            for (;;) {
+                uint64_t t0 = hs::ticks();
+                if (t0 >= deadline) break;
+                if (!ab->send(cbuf.data(), msg_size) || !ba->recv(cbuf.data(), msg_size)) {
+                    err = errno ? errno : EPIPE;
+                    break;
+                }
+                uint64_t rtt = hs::ticks() - t0;
+                total += rtt;
+                if (samples.size() < MAX_RTT_SAMPLES) samples.push_back(rtt);
+                out->round_trips++;
+            }
+            ab->close_writer();
+        });
+        client.join();
+        rc = reap_peer(echo);
+        if (err) return -err;
+        if (rc < 0) return rc;
+        if (out->round_trips) {
+            out->rtt_avg_ns = hs::ticks_to_ns((double)total / out->round_trips);
+            out->rtt_p50_ns = hs::ticks_to_ns(hs::percentile(samples, 0.50));
+            out->rtt_p99_ns = hs::ticks_to_ns(hs::percentile(samples, 0.99));
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,183 @@
+/**
+ * Loaded latency: a dependent pointer chase on one core measures memory
+ * latency while load threads on the other cores stream reads and writes at
+ * a chosen read:write ratio, throttled by an injection delay, so latency can
+ * be plotted against the bandwidth they achieve (like MLC --loaded_latency)
+ */
+
+#include "timing.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <thread>
+
+struct loaded_latency_result {
+    double latency_ns;       // average dependent-load latency seen by the probe
+    double bandwidth_gb_s;   // read + write bandwidth of the load threads during the probe
+    double read_gb_s;
+    double write_gb_s;
+    uint64_t probe_loads;
+};
+
+namespace {
+
+const size_t LINE = 64;
+const uint64_t CHASE_BATCH = 65536;  // dependent loads between clock reads
+const int PUBLISH_EVERY = 256;       // load groups between counter updates
+
+struct alignas(64) Line {
+    Line* next;
+    uint64_t pad[7];
+};
+
+struct alignas(64) LoadCounter {
+    std::atomic<uint64_t> read_lines{0};
+    std::atomic<uint64_t> write_lines{0};
+};
+
+/**
+ * Link all lines into one random cycle (Sattolo's algorithm) so hardware
+ * prefetchers cannot follow the chase
+ */
+void build_chase(Line* lines, size_t n) {
+    std::vector<uint32_t> order(n);
+    for (size_t i = 0; i < n; ++i) order[i] = (uint32_t)i;
+    uint64_t state = 0x9e3779b97f4a7c15ull;
+    for (size_t i = n - 1; i > 0; --i) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        std::swap(order[i], order[state % i]);
+    }
+    for (size_t i = 0; i < n; ++i) {
+        lines[order[i]].next = &lines[order[(i + 1) % n]];
+    }
+}
+
+/**
+ * Stream over the buffer in groups of `reads` loaded lines followed by
+ * `writes` fully stored lines, spinning delay_ns after each group
+ */
+void generate_load(uint64_t* buffer, size_t lines, int reads, int writes, uint64_t delay_ns,
+                   const std::atomic<bool>& stop, LoadCounter& counter, std::atomic<uint64_t>& sink) {
+    const size_t words = LINE / sizeof(uint64_t);
+    size_t line = 0;
+    uint64_t sum = 0;
+    uint64_t pending_reads = 0, pending_writes = 0;
+    int groups = 0;
+    while (!stop.load(std::memory_order_relaxed)) {
+        for (int r = 0; r < reads; ++r) {
+            const uint64_t* p = buffer + line * words;
+            for (size_t w = 0; w < words; ++w) sum += p[w];
+            line = line + 1 == lines ? 0 : line + 1;
+        }
+        for (int w = 0; w < writes; ++w) {
+            uint64_t* p = buffer + line * words;
+            for (size_t i = 0; i < words; ++i) p[i] = sum + i;
+            line = line + 1 == lines ? 0 : line + 1;
+        }
+        pending_reads += reads;
+        pending_writes += writes;
+        hs::spin_for_ns(delay_ns);
+        if (++groups == PUBLISH_EVERY) {
+            counter.read_lines.fetch_add(pending_reads, std::memory_order_relaxed);
+            counter.write_lines.fetch_add(pending_writes, std::memory_order_relaxed);
+            pending_reads = pending_writes = 0;
+            groups = 0;
+        }
+    }
+    sink.fetch_add(sum, std::memory_order_relaxed);
+}
+
+}  // namespace
+
+/**
+ * Chase a random cycle over chase_bytes on probe_cpu for `seconds` while
+ * nload threads (pinned to load_cpus, -1 = unpinned) each stream over their
+ * own load_bytes buffer; reads:writes of 1:0 is read-only traffic
+ */
+HS_EXPORT int loaded_latency_run(int probe_cpu, const int* load_cpus, int nload, int reads, int writes,
+                                 uint64_t delay_ns, uint64_t chase_bytes, uint64_t load_bytes, double seconds,
+                                 loaded_latency_result* out) {
+    if (!out || nload < 0 || (nload > 0 && !load_cpus) || reads < 0 || writes < 0 ||
+        (nload > 0 && reads + writes == 0) || chase_bytes < 2 * LINE || seconds <= 0) {
+        return -EINVAL;
+    }
+    size_t chase_lines = chase_bytes / LINE;
+    size_t load_lines = load_bytes / LINE;
+    if (nload > 0 && load_lines == 0) return -EINVAL;
+    Line* chase = static_cast<Line*>(aligned_alloc(LINE, chase_lines * LINE));
+    if (!chase) return -ENOMEM;
+    std::vector<uint64_t*> buffers(nload, nullptr);
+    std::vector<LoadCounter> counters(nload);
+    std::atomic<bool> stop{false};
+    std::atomic<int> ready{0};
+    std::atomic<uint64_t> sink{0};
+    std::vector<std::thread> threads;
+    int rc = 0;
+
+    for (int i = 0; i < nload; ++i) {
+        buffers[i] = static_cast<uint64_t*>(aligned_alloc(LINE, load_lines * LINE));
+        if (!buffers[i]) {
+            rc = -ENOMEM;
+            break;
+        }
+    }
+    if (rc == 0) {
+        for (int i = 0; i < nload; ++i) {
+            threads.emplace_back([&, i] {
+                hs::pin_to_cpu(load_cpus[i]);
+                memset(buffers[i], 1, load_lines * LINE);  // first touch on the load thread's node
+                ready.fetch_add(1);
+                generate_load(buffers[i], load_lines, reads, writes, delay_ns, stop, counters[i], sink);
+            });
+        }
+
+        std::thread probe([&] {
+            hs::pin_to_cpu(probe_cpu);
+            build_chase(chase, chase_lines);
+            while (ready.load() < nload) {
+                std::this_thread::yield();
+            }
+            // Let the load reach steady state before sampling
+            hs::spin_for_ns(50000000);
+            uint64_t reads0 = 0, writes0 = 0;
+            for (auto& c : counters) {
+                reads0 += c.read_lines.load();
+                writes0 += c.write_lines.load();
+            }
+            Line* p = chase;
+            uint64_t loads = 0;
+            uint64_t budget = (uint64_t)(seconds * 1e9);
+            uint64_t start = hs::now_ns();
+            uint64_t now = start;
+            while (now - start < budget) {
+                for (uint64_t i = 0; i < CHASE_BATCH; ++i) p = p->next;
+                loads += CHASE_BATCH;
+                now = hs::now_ns();
+            }
+            uint64_t reads1 = 0, writes1 = 0;
+            for (auto& c : counters) {
+                reads1 += c.read_lines.load();
+                writes1 += c.write_lines.load();
+            }
+            sink.fetch_add((uintptr_t)p);
+            double elapsed = (double)(now - start);
+            out->latency_ns = elapsed / loads;
+            out->read_gb_s = (double)(reads1 - reads0) * LINE / elapsed;
+            out->write_gb_s = (double)(writes1 - writes0) * LINE / elapsed;
+            out->bandwidth_gb_s = out->read_gb_s + out->write_gb_s;
+            out->probe_loads = loads;
+        });
+        probe.join();
+        stop.store(true);
+        for (auto& t : threads) {
+            t.join();
+        }
+    }
+    for (uint64_t* b : buffers) free(b);
+    free(chase);
+    return rc;
+}
@@ -0,0 +1,203 @@
+/**
+ * Host copy benchmark: libc memcpy, rep movsb (ERMS/FSRM), AVX2 and AVX-512
+ * load/store loops and non-temporal stores, across sizes and alignments,
+ * timed in batches with the calibrated TSC (the host side of memory_copy_kernel)
+ */
+
+#include "timing.h"
+
+#include <cpuid.h>
+#include <errno.h>
+#include <immintrin.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum MemcpyImpl {
+    MEMCPY_LIBC = 0,
+    MEMCPY_REP_MOVSB = 1,
+    MEMCPY_AVX2 = 2,
+    MEMCPY_AVX512 = 3,
+    MEMCPY_NONTEMPORAL = 4,
+};
+
+struct memcpy_features {
+    int erms;     // enhanced rep movsb/stosb, CPUID.7.0:EBX[9]
+    int fsrm;     // fast short rep mov, CPUID.7.0:EDX[4]
+    int avx2;
+    int avx512f;
+};
+
+struct memcpy_bench_result {
+    double ns_per_copy_min;     // best batch
+    double ns_per_copy_median;  // median batch
+    double gb_s;                // at the median
+    uint64_t copies;
+};
+
+namespace {
+
+const int BATCHES = 15;
+
+void copy_rep_movsb(void* dst, const void* src, size_t n) {
+    asm volatile("rep movsb" : "+D"(dst), "+S"(src), "+c"(n) : : "memory");
+}
+
+__attribute__((target("avx2")))
+void copy_avx2(void* dst, const void* src, size_t n) {
+    char* d = static_cast<char*>(dst);
+    const char* s = static_cast<const char*>(src);
+    for (; n >= 128; n -= 128, d += 128, s += 128) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + 32));
+        __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + 64));
+        __m256i e = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + 96));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(d), a);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(d + 32), b);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(d + 64), c);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(d + 96), e);
+    }
+    for (; n >= 32; n -= 32, d += 32, s += 32) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(d),
+                            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s)));
+    }
+    while (n--) *d++ = *s++;
+}
+
+__attribute__((target("avx512f")))
+void copy_avx512(void* dst, const void* src, size_t n) {
+    char* d = static_cast<char*>(dst);
+    const char* s = static_cast<const char*>(src);
+    for (; n >= 256; n -= 256, d += 256, s += 256) {
+        __m512i a = _mm512_loadu_si512(s);
+        __m512i b = _mm512_loadu_si512(s + 64);
+        __m512i c = _mm512_loadu_si512(s + 128);
+        __m512i e = _mm512_loadu_si512(s + 192);
+        _mm512_storeu_si512(d, a);
+        _mm512_storeu_si512(d + 64, b);
+        _mm512_storeu_si512(d + 128, c);
+        _mm512_storeu_si512(d + 192, e);
+    }
+    for (; n >= 64; n -= 64, d += 64, s += 64) {
+        _mm512_storeu_si512(d, _mm512_loadu_si512(s));
+    }
+    while (n--) *d++ = *s++;
+}
+
+/**
+ * Streaming stores that bypass the cache: align the destination, stream
+ * 32-byte chunks, copy the tail normally and fence
+ */
+__attribute__((target("avx2")))
+void copy_nontemporal(void* dst, const void* src, size_t n) {
+    char* d = static_cast<char*>(dst);
+    const char* s = static_cast<const char*>(src);
+    size_t head = (32 - (reinterpret_cast<uintptr_t>(d) & 31)) & 31;
+    if (head > n) head = n;
+    memcpy(d, s, head);
+    d += head, s += head, n -= head;
+    for (; n >= 128; n -= 128, d += 128, s += 128) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + 32));
+        __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + 64));
+        __m256i e = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + 96));
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(d), a);
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(d + 32), b);
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(d + 64), c);
+        _mm256_stream_si256(reinterpret_cast<__m256i*>(d + 96), e);
+    }
+    memcpy(d, s, n);
+    _mm_sfence();
+}
+
+void detect(memcpy_features* f) {
+    memset(f, 0, sizeof(*f));
+    unsigned a, b, c, d;
+    if (__get_cpuid_count(7, 0, &a, &b, &c, &d)) {
+        f->erms = (b >> 9) & 1;
+        f->fsrm = (d >> 4) & 1;
+    }
+    __builtin_cpu_init();
+    f->avx2 = __builtin_cpu_supports("avx2") != 0;
+    f->avx512f = __builtin_cpu_supports("avx512f") != 0;
+}
+
+typedef void (*CopyFn)(void*, const void*, size_t);
+
+/**
+ * Copy routine for impl, or nullptr when this CPU lacks the instructions
+ */
+CopyFn select(int impl) {
+    memcpy_features f;
+    detect(&f);
+    switch (impl) {
+        case MEMCPY_LIBC:
+            return [](void* d, const void* s, size_t n) { memcpy(d, s, n); };
+        case MEMCPY_REP_MOVSB:
+            return copy_rep_movsb;
+        case MEMCPY_AVX2:
+            return f.avx2 ? copy_avx2 : nullptr;
+        case MEMCPY_AVX512:
+            return f.avx512f ? copy_avx512 : nullptr;
+        case MEMCPY_NONTEMPORAL:
+            return f.avx2 ? copy_nontemporal : nullptr;
+    }
+    return nullptr;
+}
+
+uint64_t run_batch(CopyFn copy, char* dst, const char* src, size_t size, uint64_t copies) {
+    uint64_t start = hs::ticks_begin();
+    for (uint64_t i = 0; i < copies; ++i) {
+        copy(dst, src, size);
+        asm volatile("" : : : "memory");
+    }
+    return hs::ticks_end() - start;
+}
+
+}  // namespace
+
+HS_EXPORT int memcpy_get_features(memcpy_features* out) {
+    if (!out) return -EINVAL;
+    detect(out);
+    return 0;
+}
+
+/**
+ * Copy `size` bytes from src + src_offset to dst + dst_offset (offsets from
+ * page-aligned buffers) in BATCHES batches sized to fill about `seconds`
+ * Returns 0, -ENOTSUP when the CPU lacks the instructions, or a negative errno
+ */
+HS_EXPORT int memcpy_bench_run(int impl, uint64_t size, uint32_t src_offset, uint32_t dst_offset, double seconds,
+                               memcpy_bench_result* out) {
+    if (!out || size == 0 || src_offset >= 4096 || dst_offset >= 4096 || seconds <= 0) return -EINVAL;
+    if (impl < MEMCPY_LIBC || impl > MEMCPY_NONTEMPORAL) return -EINVAL;
+    CopyFn copy = select(impl);
+    if (!copy) return -ENOTSUP;
+    memset(out, 0, sizeof(*out));
+    size_t bytes = (size + 2 * 4096) / 4096 * 4096;
+    char* src = static_cast<char*>(aligned_alloc(4096, bytes));
+    char* dst = static_cast<char*>(aligned_alloc(4096, bytes));
+    if (!src || !dst) {
+        free(src);
+        free(dst);
+        return -ENOMEM;
+    }
+    memset(src, 0x5a, bytes);
+    memset(dst, 0, bytes);
+
+    // Warm up, then size batches so all of them take about `seconds`
+    uint64_t one = std::max<uint64_t>(1, run_batch(copy, dst + dst_offset, src + src_offset, size, 1));
+    uint64_t budget = hs::ns_to_ticks((uint64_t)(seconds * 1e9 / BATCHES));
+    uint64_t copies = std::max<uint64_t>(1, budget / one);
+    std::vector<uint64_t> batches;
+    for (int b = 0; b < BATCHES; ++b) {
+        batches.push_back(run_batch(copy, dst + dst_offset, src + src_offset, size, copies));
+    }
+    free(src);
+    free(dst);
+
+    out->ns_per_copy_median = hs::ticks_to_ns(hs::percentile(batches, 0.5)) / copies;
+    out->ns_per_copy_min = hs::ticks_to_ns(*std::min_element(batches.begin(), batches.end())) / copies;
+    out->gb_s = size / out->ns_per_copy_median;
+    out->copies = copies * BATCHES;
+    return 0;
+}
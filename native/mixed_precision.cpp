@@ -0,0 +1,478 @@
+/**
+ * Mixed-precision compute stress: the register-tile inner kernel of a GEMM
+ * (C[MR x NR] += A[MR x K] * B[K x NR] on cache-resident packed panels) for
+ * FP64, FP32, BF16 and INT8, templated on the precision and specialized per
+ * ISA (FMA, AVX-512, AVX512_BF16, AVX-VNNI, AVX512_VNNI); the best tier the
+ * CPU supports is picked at run time from CPUID
+ */
+
+#include "common.h"
+
+#include <errno.h>
+#include <immintrin.h>
+#include <math.h>
+#include <string.h>
+
+#include <thread>
+
+enum Precision {
+    PRECISION_FP64 = 0,
+    PRECISION_FP32 = 1,
+    PRECISION_BF16 = 2,
+    PRECISION_INT8 = 3,
+};
+
+enum IsaTier {
+    ISA_SCALAR = 0,
+    ISA_AVX2 = 1,    // FMA for FP64/FP32, AVX-VNNI for INT8
+    ISA_AVX512 = 2,  // AVX-512F for FP64/FP32, AVX512_BF16, AVX512_VNNI
+};
+
+struct mixed_precision_result {
+    double gops;           // GFLOPS (TOPS x 1000 for INT8)
+    double seconds;
+    uint64_t ops;
+    int isa;               // tier that ran
+    double max_rel_error;  // kernel vs. scalar reference on one tile
+};
+
+namespace {
+
+const int K_ELEMENTS = 128;     // depth of the packed panels
+const int TILES_PER_CHECK = 64;
+const int TILES_PER_RESET = 1024;  // keeps INT8 accumulators far from overflow
+
+// ---------------------------------------------------------------------------
+// Precisions: storage types, accumulator, and elements consumed per k step
+// (BF16 dot products take pairs, VNNI takes quads)
+// ---------------------------------------------------------------------------
+
+float bf16_to_float(uint16_t x) {
+    uint32_t bits = (uint32_t)x << 16;
+    float f;
+    memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+uint16_t float_to_bf16(float f) {
+    uint32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+    return (uint16_t)((bits + 0x7fff + ((bits >> 16) & 1)) >> 16);  // round to nearest even
+}
+
+struct Fp64 {
+    typedef double A;
+    typedef double B;
+    typedef double Acc;
+    static const int KSTEP = 1;
+    static double a(double x) { return x; }
+    static double b(double x) { return x; }
+    static double from(int v) { return v * 0.25; }
+};
+
+struct Fp32 {
+    typedef float A;
+    typedef float B;
+    typedef float Acc;
+    static const int KSTEP = 1;
+    static float a(float x) { return x; }
+    static float b(float x) { return x; }
+    static float from(int v) { return v * 0.25f; }
+};
+
+struct Bf16 {
+    typedef uint16_t A;
+    typedef uint16_t B;
+    typedef float Acc;
+    static const int KSTEP = 2;
+    static float a(uint16_t x) { return bf16_to_float(x); }
+    static float b(uint16_t x) { return bf16_to_float(x); }
+    static uint16_t from(int v) { return float_to_bf16(v * 0.25f); }
+};
+
+struct Int8 {
+    typedef uint8_t A;  // VNNI multiplies unsigned by signed bytes
+    typedef int8_t B;
+    typedef int32_t Acc;
+    static const int KSTEP = 4;
+    static int32_t a(uint8_t x) { return x; }
+    static int32_t b(int8_t x) { return x; }
+};
+
+/**
+ * Panels are packed per k step: A[(s * MR + r) * KSTEP + e], B[(s * NR + c) * KSTEP + e]
+ */
+template <class P>
+void reference_tile(typename P::Acc* c, const typename P::A* a, const typename P::B* b, int mr, int nr,
+                    int ksteps) {
+    for (int s = 0; s < ksteps; ++s) {
+        for (int r = 0; r < mr; ++r) {
+            for (int col = 0; col < nr; ++col) {
+                typename P::Acc sum = 0;
+                for (int e = 0; e < P::KSTEP; ++e) {
+                    sum += P::a(a[(s * mr + r) * P::KSTEP + e]) * P::b(b[(s * nr + col) * P::KSTEP + e]);
+                }
+                c[r * nr + col] += sum;
+            }
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Microkernels: the primary template is the portable scalar tile; each
+// specialization below is one precision on one ISA tier
+// ---------------------------------------------------------------------------
+
+template <class P, int Isa>
+struct Microkernel {
+    static const int MR = 4;
+    static const int NR = 16;
+    static bool supported() { return Isa == ISA_SCALAR; }
+    static void tile(typename P::Acc* c, const typename P::A* a, const typename P::B* b, int ksteps) {
+        reference_tile<P>(c, a, b, MR, NR, ksteps);
+    }
+};
+
+template <>
+struct Microkernel<Fp64, ISA_AVX2> {
+    static const int MR = 4;
+    static const int NR = 12;
+    static bool supported() { return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"); }
+    __attribute__((target("avx2,fma")))
+    static void tile(double* c, const double* a, const double* b, int ksteps) {
+        __m256d acc[MR][3];
+        for (int r = 0; r < MR; ++r)
+            for (int j = 0; j < 3; ++j) acc[r][j] = _mm256_loadu_pd(c + r * NR + 4 * j);
+        for (int s = 0; s < ksteps; ++s) {
+            __m256d b0 = _mm256_loadu_pd(b + s * NR), b1 = _mm256_loadu_pd(b + s * NR + 4),
+                    b2 = _mm256_loadu_pd(b + s * NR + 8);
+            for (int r = 0; r < MR; ++r) {
+                __m256d av = _mm256_broadcast_sd(a + s * MR + r);
+                acc[r][0] = _mm256_fmadd_pd(av, b0, acc[r][0]);
+                acc[r][1] = _mm256_fmadd_pd(av, b1, acc[r][1]);
+                acc[r][2] = _mm256_fmadd_pd(av, b2, acc[r][2]);
+            }
+        }
+        for (int r = 0; r < MR; ++r)
+            for (int j = 0; j < 3; ++j) _mm256_storeu_pd(c + r * NR + 4 * j, acc[r][j]);
+    }
+};
+
+template <>
+struct Microkernel<Fp64, ISA_AVX512> {
+    static const int MR = 4;
+    static const int NR = 24;
+    static bool supported() { return __builtin_cpu_supports("avx512f"); }
+    __attribute__((target("avx512f")))
+    static void tile(double* c, const double* a, const double* b, int ksteps) {
+        __m512d acc[MR][3];
+        for (int r = 0; r < MR; ++r)
+            for (int j = 0; j < 3; ++j) acc[r][j] = _mm512_loadu_pd(c + r * NR + 8 * j);
+        for (int s = 0; s < ksteps; ++s) {
+            __m512d b0 = _mm512_loadu_pd(b + s * NR), b1 = _mm512_loadu_pd(b + s * NR + 8),
+                    b2 = _mm512_loadu_pd(b + s * NR + 16);
+            for (int r = 0; r < MR; ++r) {
+                __m512d av = _mm512_set1_pd(a[s * MR + r]);
+                acc[r][0] = _mm512_fmadd_pd(av, b0, acc[r][0]);
+                acc[r][1] = _mm512_fmadd_pd(av, b1, acc[r][1]);
+                acc[r][2] = _mm512_fmadd_pd(av, b2, acc[r][2]);
+            }
+        }
+        for (int r = 0; r < MR; ++r)
+            for (int j = 0; j < 3; ++j) _mm512_storeu_pd(c + r * NR + 8 * j, acc[r][j]);
+    }
+};
+
+template <>
+struct Microkernel<Fp32, ISA_AVX2> {
+    static const int MR = 4;
+    static const int NR = 24;
+    static bool supported() { return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"); }
+    __attribute__((target("avx2,fma")))
+    static void tile(float* c, const float* a, const float* b, int ksteps) {
+        __m256 acc[MR][3];
+        for (int r = 0; r < MR; ++r)
+            for (int j = 0; j < 3; ++j) acc[r][j] = _mm256_loadu_ps(c + r * NR + 8 * j);
+        for (int s = 0; s < ksteps; ++s) {
+            __m256 b0 = _mm256_loadu_ps(b + s * NR), b1 = _mm256_loadu_ps(b + s * NR + 8),
+                   b2 = _mm256_loadu_ps(b + s * NR + 16);
+            for (int r = 0; r < MR; ++r) {
+                __m256 av = _mm256_broadcast_ss(a + s * MR + r);
+                acc[r][0] = _mm256_fmadd_ps(av, b0, acc[r][0]);
+                acc[r][1] = _mm256_fmadd_ps(av, b1, acc[r][1]);
+                acc[r][2] = _mm256_fmadd_ps(av, b2, acc[r][2]);
+            }
+        }
+        for (int r = 0; r < MR; ++r)
+            for (int j = 0; j < 3; ++j) _mm256_storeu_ps(c + r * NR + 8 * j, acc[r][j]);
+    }
+};
+
+template <>
+struct Microkernel<Fp32, ISA_AVX512> {
+    static const int MR = 4;
+    static const int NR = 48;
+    static bool supported() { return __builtin_cpu_supports("avx512f"); }
+    __attribute__((target("avx512f")))
+    static void tile(float* c, const float* a, const float* b, int ksteps) {
+        __m512 acc[MR][3];
+        for (int r = 0; r < MR; ++r)
+            for (int j = 0; j < 3; ++j) acc[r][j] = _mm512_loadu_ps(c + r * NR + 16 * j);
+        for (int s = 0; s < ksteps; ++s) {
+            __m512 b0 = _mm512_loadu_ps(b + s * NR), b1 = _mm512_loadu_ps(b + s * NR + 16),
+                   b2 = _mm512_loadu_ps(b + s * NR + 32);
+            for (int r = 0; r < MR; ++r) {
+                __m512 av = _mm512_set1_ps(a[s * MR + r]);
+                acc[r][0] = _mm512_fmadd_ps(av, b0, acc[r][0]);
+                acc[r][1] = _mm512_fmadd_ps(av, b1, acc[r][1]);
+                acc[r][2] = _mm512_fmadd_ps(av, b2, acc[r][2]);
+            }
+        }
+        for (int r = 0; r < MR; ++r)
+            for (int j = 0; j < 3; ++j) _mm512_storeu_ps(c + r * NR + 16 * j, acc[r][j]);
+    }
+};
+
+template <>
+struct Microkernel<Bf16, ISA_AVX512> {
+    static const int MR = 4;
+    static const int NR = 48;
+    static bool supported() { return __builtin_cpu_supports("avx512bf16"); }
+    __attribute__((target("avx512f,avx512bf16")))
+    static void tile(float* c, const uint16_t* a, const uint16_t* b, int ksteps) {
+        __m512 acc[MR][3];
+        for (int r = 0; r < MR; ++r)
+            for (int j = 0; j < 3; ++j) acc[r][j] = _mm512_loadu_ps(c + r * NR + 16 * j);
+        for (int s = 0; s < ksteps; ++s) {
+            // 16 columns x 2 k values per vector
+            const uint16_t* bs = b + s * NR * 2;
+            __m512bh b0 = (__m512bh)_mm512_loadu_si512(bs), b1 = (__m512bh)_mm512_loadu_si512(bs + 32),
+                     b2 = (__m512bh)_mm512_loadu_si512(bs + 64);
+            for (int r = 0; r < MR; ++r) {
+                uint32_t pair;
+                memcpy(&pair, a + (s * MR + r) * 2, sizeof(pair));
+                __m512bh av = (__m512bh)_mm512_set1_epi32((int)pair);
+                acc[r][0] = _mm512_dpbf16_ps(acc[r][0], av, b0);
+                acc[r][1] = _mm512_dpbf16_ps(acc[r][1], av, b1);
+                acc[r][2] = _mm512_dpbf16_ps(acc[r][2], av, b2);
+            }
+        }
+        for (int r = 0; r < MR; ++r)
+            for (int j = 0; j < 3; ++j) _mm512_storeu_ps(c + r * NR + 16 * j, acc[r][j]);
+    }
+};
+
+template <>
+struct Microkernel<Int8, ISA_AVX2> {
+    static const int MR = 4;
+    static const int NR = 24;
+    static bool supported() { return __builtin_cpu_supports("avxvnni"); }
+    __attribute__((target("avx2,avxvnni")))
+    static void tile(int32_t* c, const uint8_t* a, const int8_t* b, int ksteps) {
+        __m256i acc[MR][3];
+        for (int r = 0; r < MR; ++r)
+            for (int j = 0; j < 3; ++j) acc[r][j] = _mm256_loadu_si256((const __m256i*)(c + r * NR + 8 * j));
+        for (int s = 0; s < ksteps; ++s) {
+            // 8 columns x 4 k values per vector
+            const int8_t* bs = b + s * NR * 4;
+            __m256i b0 = _mm256_loadu_si256((const __m256i*)bs), b1 = _mm256_loadu_si256((const __m256i*)(bs + 32)),
+                    b2 = _mm256_loadu_si256((const __m256i*)(bs + 64));
+            for (int r = 0; r < MR; ++r) {
+                uint32_t quad;
+                memcpy(&quad, a + (s * MR + r) * 4, sizeof(quad));
+                __m256i av = _mm256_set1_epi32((int)quad);
+                acc[r][0] = _mm256_dpbusd_avx_epi32(acc[r][0], av, b0);
+                acc[r][1] = _mm256_dpbusd_avx_epi32(acc[r][1], av, b1);
+                acc[r][2] = _mm256_dpbusd_avx_epi32(acc[r][2], av, b2);
+            }
+        }
+        for (int r = 0; r < MR; ++r)
+            for (int j = 0; j < 3; ++j) _mm256_storeu_si256((__m256i*)(c + r * NR + 8 * j), acc[r][j]);
+    }
+};
+
+template <>
+struct Microkernel<Int8, ISA_AVX512> {
+    static const int MR = 4;
+    static const int NR = 48;
+    static bool supported() { return __builtin_cpu_supports("avx512vnni"); }
+    __attribute__((target("avx512f,avx512vnni")))
+    static void tile(int32_t* c, const uint8_t* a, const int8_t* b, int ksteps) {
+        __m512i acc[MR][3];
+        for (int r = 0; r < MR; ++r)
+            for (int j = 0; j < 3; ++j) acc[r][j] = _mm512_loadu_si512(c + r * NR + 16 * j);
+        for (int s = 0; s < ksteps; ++s) {
+            // 16 columns x 4 k values per vector
+            const int8_t* bs = b + s * NR * 4;
+            __m512i b0 = _mm512_loadu_si512(bs), b1 = _mm512_loadu_si512(bs + 64), b2 = _mm512_loadu_si512(bs + 128);
+            for (int r = 0; r < MR; ++r) {
+                uint32_t quad;
+                memcpy(&quad, a + (s * MR + r) * 4, sizeof(quad));
+                __m512i av = _mm512_set1_epi32((int)quad);
+                acc[r][0] = _mm512_dpbusd_epi32(acc[r][0], av, b0);
+                acc[r][1] = _mm512_dpbusd_epi32(acc[r][1], av, b1);
+                acc[r][2] = _mm512_dpbusd_epi32(acc[r][2], av, b2);
+            }
+        }
+        for (int r = 0; r < MR; ++r)
+            for (int j = 0; j < 3; ++j) _mm512_storeu_si512(c + r * NR + 16 * j, acc[r][j]);
+    }
+};
+
+// ---------------------------------------------------------------------------
+// Driver, generic over precision and tier
+// ---------------------------------------------------------------------------
+
+template <class P>
+void fill_panels(std::vector<typename P::A>& a, std::vector<typename P::B>& b) {
+    // Small multiples of 1/4 keep every precision (and every summation order) exact
+    for (size_t i = 0; i < a.size(); ++i) a[i] = P::from((int)(i * 7 % 9) - 4);
+    for (size_t i = 0; i < b.size(); ++i) b[i] = P::from((int)(i * 5 % 11) - 5);
+}
+
+template <>
+void fill_panels<Int8>(std::vector<uint8_t>& a, std::vector<int8_t>& b) {
+    for (size_t i = 0; i < a.size(); ++i) a[i] = (uint8_t)(i * 7 % 16);
+    for (size_t i = 0; i < b.size(); ++i) b[i] = (int8_t)(i * 5 % 16 - 8);
+}
+
+/**
+ * One tile from the kernel against the scalar reference; returns the largest relative error
+ */
+template <class P, int Isa>
+double validate() {
+    typedef Microkernel<P, Isa> K;
+    const int ksteps = K_ELEMENTS / P::KSTEP;
+    std::vector<typename P::A> a(ksteps * K::MR * P::KSTEP);
+    std::vector<typename P::B> b(ksteps * K::NR * P::KSTEP);
+    fill_panels<P>(a, b);
+    std::vector<typename P::Acc> got(K::MR * K::NR, 0), want(K::MR * K::NR, 0);
+    K::tile(got.data(), a.data(), b.data(), ksteps);
+    reference_tile<P>(want.data(), a.data(), b.data(), K::MR, K::NR, ksteps);
+    double worst = 0.0;
+    for (size_t i = 0; i < got.size(); ++i) {
+        double scale = std::max(1.0, fabs((double)want[i]));
+        worst = std::max(worst, fabs((double)got[i] - (double)want[i]) / scale);
+    }
+    return worst;
+}
+
+template <class P, int Isa>
+int run(int nthreads, double seconds, mixed_precision_result* out) {
+    typedef Microkernel<P, Isa> K;
+    if (!K::supported()) return -ENOTSUP;
+    out->max_rel_error = validate<P, Isa>();
+    if (out->max_rel_error > 1e-6) return -EIO;
+
+    cpu_set_t allowed;
+    sched_getaffinity(0, sizeof(allowed), &allowed);
+    std::vector<int> cpus;
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &allowed)) cpus.push_back(cpu);
+    }
+    const int ksteps = K_ELEMENTS / P::KSTEP;
+    std::atomic<int> ready{0};
+    std::atomic<bool> go{false};
+    std::vector<uint64_t> tiles(nthreads, 0), elapsed(nthreads, 0);
+    std::vector<double> sinks(nthreads, 0.0);
+    std::vector<std::thread> threads;
+    uint64_t budget_ns = (uint64_t)(seconds * 1e9);
+    for (int id = 0; id < nthreads; ++id) {
+        threads.emplace_back([&, id] {
+            hs::pin_to_cpu(cpus.empty() ? -1 : cpus[id % cpus.size()]);
+            std::vector<typename P::A> a(ksteps * K::MR * P::KSTEP);
+            std::vector<typename P::B> b(ksteps * K::NR * P::KSTEP);
+            std::vector<typename P::Acc> c(K::MR * K::NR, 0);
+            fill_panels<P>(a, b);
+            ready.fetch_add(1);
+            while (!go.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            uint64_t done = 0;
+            uint64_t start = hs::now_ns();
+            uint64_t now = start;
+            while (now - start < budget_ns) {
+                for (int t = 0; t < TILES_PER_CHECK; ++t) {
+                    K::tile(c.data(), a.data(), b.data(), ksteps);
+                }
+                done += TILES_PER_CHECK;
+                if (done % TILES_PER_RESET == 0) {
+                    sinks[id] += (double)c[0];
+                    std::fill(c.begin(), c.end(), 0);
+                }
+                now = hs::now_ns();
+            }
+            sinks[id] += (double)c[0];
+            tiles[id] = done;
+            elapsed[id] = now - start;
+        });
+    }
+    while (ready.load() < nthreads) {
+        std::this_thread::yield();
+    }
+    go.store(true, std::memory_order_release);
+    for (auto& t : threads) {
+        t.join();
+    }
+    uint64_t total = 0;
+    for (uint64_t n : tiles) total += n;
+    double wall = *std::max_element(elapsed.begin(), elapsed.end());
+    out->ops = total * 2ull * K::MR * K::NR * K_ELEMENTS;  // multiply + add per MAC
+    out->seconds = wall / 1e9;
+    out->gops = out->ops / wall;
+    out->isa = Isa;
+    return 0;
+}
+
+template <class P>
+int dispatch(int isa, int nthreads, double seconds, mixed_precision_result* out) {
+    switch (isa) {
+        case ISA_SCALAR: return run<P, ISA_SCALAR>(nthreads, seconds, out);
+        case ISA_AVX2: return run<P, ISA_AVX2>(nthreads, seconds, out);
+        case ISA_AVX512: return run<P, ISA_AVX512>(nthreads, seconds, out);
+    }
+    return -EINVAL;
+}
+
+template <class P>
+int best_isa() {
+    if (Microkernel<P, ISA_AVX512>::supported()) return ISA_AVX512;
+    if (Microkernel<P, ISA_AVX2>::supported()) return ISA_AVX2;
+    return ISA_SCALAR;
+}
+
+}  // namespace
+
+/**
+ * Best ISA tier this CPU supports for a precision (ISA_SCALAR always works)
+ */
+HS_EXPORT int mixed_precision_best_isa(int precision) {
+    __builtin_cpu_init();
+    switch (precision) {
+        case PRECISION_FP64: return best_isa<Fp64>();
+        case PRECISION_FP32: return best_isa<Fp32>();
+        case PRECISION_BF16: return best_isa<Bf16>();
+        case PRECISION_INT8: return best_isa<Int8>();
+    }
+    return -EINVAL;
+}
+
+/**
+ * Run the GEMM microkernel for one precision on nthreads pinned threads;
+ * isa < 0 picks the best supported tier. The kernel is checked against the
+ * scalar reference first (-EIO on mismatch); -ENOTSUP if the tier is missing
+ */
+HS_EXPORT int mixed_precision_run(int precision, int isa, int nthreads, double seconds,
+                                  mixed_precision_result* out) {
+    if (!out || nthreads <= 0 || seconds <= 0) return -EINVAL;
+    memset(out, 0, sizeof(*out));
+    int tier = isa < 0 ? mixed_precision_best_isa(precision) : isa;
+    if (tier < 0) return tier;
+    switch (precision) {
+        case PRECISION_FP64: return dispatch<Fp64>(tier, nthreads, seconds, out);
+        case PRECISION_FP32: return dispatch<Fp32>(tier, nthreads, seconds, out);
+        case PRECISION_BF16: return dispatch<Bf16>(tier, nthreads, seconds, out);
+        case PRECISION_INT8: return dispatch<Int8>(tier, nthreads, seconds, out);
+    }
+    return -EINVAL;
+}
@@ -0,0 +1,154 @@
+/**
+ * First-touch page-fault throughput: threads repeatedly map fresh anonymous
+ * memory and fault it in, by touching one byte per page, with MAP_POPULATE or
+ * with MADV_POPULATE_WRITE, on 4 KB pages or transparent huge pages
+ * Fault counts come from each thread's own minor-fault counter
+ */
+
+#include "common.h"
+
+#include <errno.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+
+#include <thread>
+
+#ifndef MADV_POPULATE_WRITE
+#define MADV_POPULATE_WRITE 23
+#endif
+
+enum PageFaultMode {
+    FAULT_TOUCH = 0,
+    FAULT_MAP_POPULATE = 1,
+    FAULT_MADV_POPULATE = 2,
+};
+
+struct page_fault_result {
+    double gb_s;             // bytes faulted in per second, all threads
+    double faults_per_sec;
+    double ns_per_fault;     // average time per fault on one thread
+    uint64_t faults;
+    uint64_t bytes;
+    double seconds;
+};
+
+namespace {
+
+const size_t PAGE = 4096;
+const size_t HUGE_PAGE = 2 * 1024 * 1024;
+
+uint64_t minor_faults() {
+    struct rusage usage;
+    getrusage(RUSAGE_THREAD, &usage);
+    return usage.ru_minflt;
+}
+
+/**
+ * Map and fault in `bytes` once; only the faulting is timed (plus the mmap
+ * itself for MAP_POPULATE, where the two cannot be separated)
+ * Returns 0 or a negative errno
+ */
+int fault_round(int mode, bool huge, size_t bytes, uint64_t* ns, uint64_t* faults) {
+    // Over-allocate so the region can be aligned to a huge page; MAP_POPULATE
+    // faults in the whole mapping before any advice, so it maps exactly bytes
+    bool populate = mode == FAULT_MAP_POPULATE;
+    size_t len = populate ? bytes : bytes + HUGE_PAGE;
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS | (populate ? MAP_POPULATE : 0);
+    uint64_t faults0 = minor_faults();
+    uint64_t start = hs::now_ns();
+    char* base = static_cast<char*>(mmap(nullptr, len, PROT_READ | PROT_WRITE, flags, -1, 0));
+    if (base == MAP_FAILED) return -errno;
+    char* p = populate ? base
+                       : reinterpret_cast<char*>(((uintptr_t)base + HUGE_PAGE - 1) & ~(uintptr_t)(HUGE_PAGE - 1));
+    if (!populate) {
+        madvise(p, bytes, huge ? MADV_HUGEPAGE : MADV_NOHUGEPAGE);
+        faults0 = minor_faults();
+        start = hs::now_ns();
+    }
+    int rc = 0;
+    if (mode == FAULT_TOUCH) {
+        for (size_t off = 0; off < bytes; off += PAGE) {
+            *(volatile char*)(p + off) = 1;
+        }
+    } else if (mode == FAULT_MADV_POPULATE && madvise(p, bytes, MADV_POPULATE_WRITE) < 0) {
+        rc = errno == EINVAL ? -ENOTSUP : -errno;  // EINVAL: kernel older than 5.14
+    }
+    *ns += hs::now_ns() - start;
+    *faults += minor_faults() - faults0;
+    munmap(base, len);
+    return rc;
+}
+
+}  // namespace
+
+/**
+ * nthreads each fault in bytes_per_thread repeatedly for about `seconds`
+ * huge != 0 requests transparent huge pages (MADV_HUGEPAGE); with
+ * MAP_POPULATE the pages are populated before the advice can apply, so THP
+ * is only used there when it is enabled system-wide
+ */
+HS_EXPORT int page_fault_run(int mode, int huge, uint64_t bytes_per_thread, int nthreads, double seconds,
+                             page_fault_result* out) {
+    if (!out || mode < FAULT_TOUCH || mode > FAULT_MADV_POPULATE || nthreads <= 0 || seconds <= 0 ||
+        bytes_per_thread < HUGE_PAGE || bytes_per_thread % HUGE_PAGE != 0) {
+        return -EINVAL;
+    }
+    memset(out, 0, sizeof(*out));
+    cpu_set_t allowed;
+    sched_getaffinity(0, sizeof(allowed), &allowed);
+    std::vector<int> cpus;
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &allowed)) cpus.push_back(cpu);
+    }
+
+    std::atomic<int> ready{0};
+    std::atomic<bool> go{false};
+    std::vector<uint64_t> ns(nthreads, 0), faults(nthreads, 0), rounds(nthreads, 0);
+    std::vector<int> errors(nthreads, 0);
+    std::vector<std::thread> threads;
+    uint64_t budget_ns = (uint64_t)(seconds * 1e9);
+    uint64_t wall_start = 0, wall_end = 0;
+    for (int id = 0; id < nthreads; ++id) {
+        threads.emplace_back([&, id] {
+            hs::pin_to_cpu(cpus.empty() ? -1 : cpus[id % cpus.size()]);
+            ready.fetch_add(1);
+            while (!go.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            uint64_t start = hs::now_ns();
+            do {
+                errors[id] = fault_round(mode, huge != 0, bytes_per_thread, &ns[id], &faults[id]);
+                ++rounds[id];
+            } while (errors[id] == 0 && hs::now_ns() - start < budget_ns);
+        });
+    }
+    while (ready.load() < nthreads) {
+        std::this_thread::yield();
+    }
+    wall_start = hs::now_ns();
+    go.store(true, std::memory_order_release);
+    for (auto& t : threads) {
+        t.join();
+    }
+    wall_end = hs::now_ns();
+    for (int err : errors) {
+        if (err) return err;
+    }
+
+    uint64_t total_rounds = 0, total_ns = 0;
+    for (int id = 0; id < nthreads; ++id) {
+        total_rounds += rounds[id];
+        total_ns += ns[id];
+        out->faults += faults[id];
+    }
+    // Throughput over the time threads actually spent faulting (mapping and
+    // unmapping are excluded), averaged across the concurrently running threads
+    double faulting_s = total_ns / 1e9 / nthreads;
+    out->bytes = total_rounds * bytes_per_thread;
+    out->seconds = (wall_end - wall_start) / 1e9;
+    out->gb_s = out->bytes / faulting_s / 1e9;
+    out->faults_per_sec = out->faults / faulting_s;
+    out->ns_per_fault = out->faults ? (double)total_ns / out->faults : 0.0;
+    return 0;
+}
@@ -0,0 +1,128 @@
+/**
+ * Prefetcher stream limits: the host generalization of concurrent_memory_kernel
+ * Each thread walks N sequential streams in lockstep, one cache line of each
+ * per step, reading every stream and writing back a chosen subset, so the
+ * bandwidth per stream count shows where hardware prefetchers and line fill
+ * buffers stop keeping up
+ */
+
+#include "common.h"
+
+#include <errno.h>
+#include <stdlib.h>
+
+#include <thread>
+
+struct stream_bench_result {
+    double gb_s;        // read + write
+    double read_gb_s;
+    double write_gb_s;
+    double seconds;
+};
+
+namespace {
+
+const size_t LINE = 64;
+const size_t FLOATS_PER_LINE = LINE / sizeof(float);
+const size_t STAGGER = 3 * LINE;  // offset between stream starts so they do not alias in the L1 sets
+const uint64_t STEPS_PER_CHECK = 1024;
+
+/**
+ * One step of every stream per iteration: read the line of each stream,
+ * then store to the line of the first `writes` streams
+ */
+uint64_t walk(float* const* streams, int nstreams, int writes, size_t lines, uint64_t budget_ns,
+              uint64_t* elapsed_ns) {
+    float acc[FLOATS_PER_LINE] = {};
+    size_t line = 0;
+    uint64_t steps = 0;
+    uint64_t start = hs::now_ns();
+    uint64_t now = start;
+    while (now - start < budget_ns) {
+        for (uint64_t n = 0; n < STEPS_PER_CHECK; ++n) {
+            size_t offset = line * FLOATS_PER_LINE;
+            for (int s = 0; s < nstreams; ++s) {
+                const float* p = streams[s] + offset;
+                for (size_t j = 0; j < FLOATS_PER_LINE; ++j) acc[j] += p[j];
+            }
+            for (int s = 0; s < writes; ++s) {
+                float* p = streams[s] + offset;
+                for (size_t j = 0; j < FLOATS_PER_LINE; ++j) p[j] = acc[j] * 0.5f;
+            }
+            line = line + 1 == lines ? 0 : line + 1;
+        }
+        steps += STEPS_PER_CHECK;
+        now = hs::now_ns();
+    }
+    *elapsed_ns = now - start;
+    // Keep the accumulation observable
+    volatile float sink = acc[0];
+    (void)sink;
+    return steps;
+}
+
+}  // namespace
+
+/**
+ * nthreads each walk `streams` sequential streams of stream_bytes, writing
+ * back `writes` of them (0 = read-only, streams = read-modify-write all)
+ * Threads are pinned round-robin over the allowed CPUs
+ */
+HS_EXPORT int stream_bench_run(int streams, int writes, uint64_t stream_bytes, int nthreads, double seconds,
+                               stream_bench_result* out) {
+    if (!out || streams <= 0 || writes < 0 || writes > streams || nthreads <= 0 || seconds <= 0) {
+        return -EINVAL;
+    }
+    size_t lines = stream_bytes / LINE;
+    if (lines < STEPS_PER_CHECK / 64) return -EINVAL;
+    size_t stride = lines * LINE + STAGGER;
+    size_t per_thread = stride * streams;
+    uint8_t* buffer = static_cast<uint8_t*>(aligned_alloc(4096, (per_thread * nthreads + 4095) / 4096 * 4096));
+    if (!buffer) return -ENOMEM;
+
+    cpu_set_t allowed;
+    sched_getaffinity(0, sizeof(allowed), &allowed);
+    std::vector<int> cpus;
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &allowed)) cpus.push_back(cpu);
+    }
+
+    std::atomic<int> ready{0};
+    std::atomic<bool> go{false};
+    std::vector<uint64_t> steps(nthreads, 0);
+    std::vector<uint64_t> elapsed(nthreads, 0);
+    std::vector<std::thread> threads;
+    uint64_t budget_ns = (uint64_t)(seconds * 1e9);
+    for (int id = 0; id < nthreads; ++id) {
+        threads.emplace_back([&, id] {
+            hs::pin_to_cpu(cpus.empty() ? -1 : cpus[id % cpus.size()]);
+            std::vector<float*> ptrs(streams);
+            for (int s = 0; s < streams; ++s) {
+                ptrs[s] = reinterpret_cast<float*>(buffer + id * per_thread + s * stride);
+                std::fill(ptrs[s], ptrs[s] + lines * FLOATS_PER_LINE, 1.0f);
+            }
+            ready.fetch_add(1);
+            while (!go.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            steps[id] = walk(ptrs.data(), streams, writes, lines, budget_ns, &elapsed[id]);
+        });
+    }
+    while (ready.load() < nthreads) {
+        std::this_thread::yield();
+    }
+    go.store(true, std::memory_order_release);
+    for (auto& t : threads) {
+        t.join();
+    }
+    free(buffer);
+
+    uint64_t total = 0;
+    for (uint64_t n : steps) total += n;
+    double wall = *std::max_element(elapsed.begin(), elapsed.end());
+    out->seconds = wall / 1e9;
+    out->read_gb_s = (double)total * streams * LINE / wall;
+    out->write_gb_s = (double)total * writes * LINE / wall;
+    out->gb_s = out->read_gb_s + out->write_gb_s;
+    return 0;
+}
@@ -0,0 +1,390 @@
+/**
+ * Database-style CPU + memory workloads: a multithreaded LSD radix sort of
+ * 64-bit keys and a hash join (build + probe), either on one shared table or
+ * radix-partitioned into cache-sized pieces first
+ * Both scatter with optional software write-combining: each bucket fills a
+ * cache-line buffer that is written out with non-temporal stores, so the
+ * scatter touches one line per bucket instead of thrashing the TLB and caches
+ */
+
+#include "common.h"
+
+#include <emmintrin.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct radix_sort_result {
+    double tuples_s;   // keys sorted per second
+    double gb_s;       // per pass: the input read twice (histogram, scatter) and written once
+    double seconds;
+    uint64_t sorts;
+    int sorted;        // the first sort was checked: ordered and a permutation of the input
+};
+
+struct hash_join_result {
+    double tuples_s;         // build + probe tuples per second
+    double partition_share;  // fraction of the time spent partitioning
+    double seconds;
+    uint64_t joins;
+    uint64_t matches;        // per join
+    int valid;               // every probe matched the right build tuple
+};
+
+namespace {
+
+const int SORT_BITS = 8;
+const size_t SORT_BUCKETS = 1 << SORT_BITS;
+const int MAX_PARTITION_BITS = 12;  // 4096 write-combining lines = 256 KB, about an L2
+
+struct Tuple {
+    uint64_t key;
+    uint64_t payload;
+};
+
+uint64_t splitmix64(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+/**
+ * MurmurHash3 finalizer: a bijection with fmix64(x) == 0 only for x == 0, so
+ * fmix64(i + 1) gives unique nonzero build keys
+ */
+uint64_t fmix64(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdull;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ull;
+    return x ^ (x >> 33);
+}
+
+template <class T>
+T* alloc_lines(size_t n) {
+    return static_cast<T*>(aligned_alloc(64, (std::max<size_t>(n, 1) * sizeof(T) + 63) / 64 * 64));
+}
+
+/**
+ * Scatter in[0, n) into out by bucket(v); pos[b] starts at this thread's first
+ * slot for bucket b and is advanced past every element written
+ * With write-combining, elements collect in one 64-byte line per bucket that
+ * is streamed out once full; lines shared with a neighbouring bucket or
+ * thread (the first and last of each run) are written element by element
+ */
+template <class T, class Bucket>
+void scatter(const T* in, size_t n, T* out, size_t* pos, size_t buckets, Bucket bucket, bool swwc,
+             std::vector<T>& lines) {
+    const size_t PER_LINE = 64 / sizeof(T);
+    if (!swwc) {
+        for (size_t i = 0; i < n; ++i) out[pos[bucket(in[i])]++] = in[i];
+        return;
+    }
+    std::vector<size_t> begin(pos, pos + buckets);
+    lines.resize(buckets * PER_LINE + PER_LINE);
+    T* buf = reinterpret_cast<T*>(((uintptr_t)lines.data() + 63) & ~(uintptr_t)63);
+    for (size_t i = 0; i < n; ++i) {
+        size_t b = bucket(in[i]);
+        size_t p = pos[b]++;
+        T* line = buf + b * PER_LINE;
+        line[p % PER_LINE] = in[i];
+        if ((p + 1) % PER_LINE == 0) {
+            size_t start = p + 1 - PER_LINE;
+            if (start >= begin[b]) {
+                const __m128i* src = reinterpret_cast<const __m128i*>(line);
+                __m128i* dst = reinterpret_cast<__m128i*>(out + start);
+                _mm_stream_si128(dst, _mm_load_si128(src));
+                _mm_stream_si128(dst + 1, _mm_load_si128(src + 1));
+                _mm_stream_si128(dst + 2, _mm_load_si128(src + 2));
+                _mm_stream_si128(dst + 3, _mm_load_si128(src + 3));
+            } else {
+                for (size_t q = begin[b]; q <= p; ++q) out[q] = line[q % PER_LINE];
+            }
+        }
+    }
+    for (size_t b = 0; b < buckets; ++b) {
+        size_t start = std::max(begin[b], pos[b] / PER_LINE * PER_LINE);
+        for (size_t q = start; q < pos[b]; ++q) out[q] = buf[b * PER_LINE + q % PER_LINE];
+    }
+    _mm_sfence();
+}
+
+/**
+ * Per-thread histograms -> each thread's starting slot per bucket, with
+ * buckets laid out in order and threads in order within a bucket
+ */
+void scatter_offsets(const std::vector<std::vector<size_t>>& hist, int id, size_t buckets, size_t* pos) {
+    size_t base = 0;
+    for (size_t b = 0; b < buckets; ++b) {
+        size_t at = base;
+        for (size_t t = 0; t < hist.size(); ++t) {
+            if ((int)t == id) pos[b] = at;
+            at += hist[t][b];
+        }
+        base = at;
+    }
+}
+
+std::vector<int> allowed_cpus() {
+    cpu_set_t allowed;
+    sched_getaffinity(0, sizeof(allowed), &allowed);
+    std::vector<int> cpus;
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &allowed)) cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
+}  // namespace
+
+/**
+ * Sort n random 64-bit keys (8 passes of 8 bits) on nthreads pinned threads,
+ * repeating with fresh keys until `seconds` of sorting have elapsed; only the
+ * passes are timed. swwc != 0 scatters through write-combining buffers
+ */
+HS_EXPORT int radix_sort_run(uint64_t n, int nthreads, int swwc, double seconds, radix_sort_result* out) {
+    if (!out || n == 0 || nthreads <= 0 || seconds <= 0) return -EINVAL;
+    memset(out, 0, sizeof(*out));
+    uint64_t* keys = alloc_lines<uint64_t>(n);
+    uint64_t* tmp = alloc_lines<uint64_t>(n);
+    if (!keys || !tmp) {
+        free(keys);
+        free(tmp);
+        return -ENOMEM;
+    }
+    std::vector<int> cpus = allowed_cpus();
+    std::vector<std::vector<size_t>> hist(nthreads, std::vector<size_t>(SORT_BUCKETS));
+    std::vector<uint64_t> sums(nthreads, 0);
+    hs::Barrier barrier(nthreads);
+    std::atomic<bool> stop{false};
+    uint64_t timed_ns = 0, sorts = 0;
+    bool sorted = true;
+    std::vector<std::thread> threads;
+    for (int id = 0; id < nthreads; ++id) {
+        threads.emplace_back([&, id] {
+            hs::pin_to_cpu(cpus.empty() ? -1 : cpus[id % cpus.size()]);
+            size_t c0 = n * id / nthreads, c1 = n * (id + 1) / nthreads;
+            std::vector<size_t> pos(SORT_BUCKETS);
+            std::vector<uint64_t> lines;
+            uint64_t start = 0;
+            for (uint64_t round = 0; !stop.load(std::memory_order_acquire); ++round) {
+                // Fresh keys each round (first-touched by the thread that reads them first)
+                uint64_t sum = 0;
+                for (size_t i = c0; i < c1; ++i) {
+                    keys[i] = splitmix64(round * n + i);
+                    sum += keys[i];
+                }
+                sums[id] = sum;
+                barrier.wait();
+                if (id == 0) start = hs::now_ns();
+                uint64_t* src = keys;
+                uint64_t* dst = tmp;
+                for (int shift = 0; shift < 64; shift += SORT_BITS) {
+                    std::fill(hist[id].begin(), hist[id].end(), 0);
+                    for (size_t i = c0; i < c1; ++i) ++hist[id][(src[i] >> shift) & (SORT_BUCKETS - 1)];
+                    barrier.wait();
+                    scatter_offsets(hist, id, SORT_BUCKETS, pos.data());
+                    scatter(src + c0, c1 - c0, dst, pos.data(), SORT_BUCKETS,
+                            [shift](uint64_t k) { return (k >> shift) & (SORT_BUCKETS - 1); }, swwc != 0, lines);
+                    barrier.wait();
+                    std::swap(src, dst);
+                }
+                if (id == 0) {
+                    timed_ns += hs::now_ns() - start;
+                    ++sorts;
+                    if (round == 0) {
+                        uint64_t expected = 0, actual = 0;
+                        for (uint64_t s : sums) expected += s;
+                        for (size_t i = 0; i < n; ++i) {
+                            actual += keys[i];
+                            if (i && keys[i - 1] > keys[i]) sorted = false;
+                        }
+                        sorted = sorted && actual == expected;
+                    }
+                    if (timed_ns >= (uint64_t)(seconds * 1e9)) stop.store(true, std::memory_order_release);
+                }
+                barrier.wait();
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    free(keys);
+    free(tmp);
+
+    out->sorts = sorts;
+    out->seconds = timed_ns / 1e9;
+    out->sorted = sorted;
+    out->tuples_s = (double)n * sorts / out->seconds;
+    out->gb_s = out->tuples_s * (64 / SORT_BITS) * 3 * sizeof(uint64_t) / 1e9;
+    return 0;
+}
+
+/**
+ * Equi-join build_rows unique keys with probe_rows keys drawn from them on
+ * nthreads pinned threads, repeated until `seconds` elapse
+ * partition_bits == 0: build one shared linear-probing table (CAS inserts)
+ * and probe it; otherwise radix-partition both sides into 2^bits pieces by the
+ * low key bits, then join piece by piece with a cache-resident table each
+ */
+HS_EXPORT int hash_join_run(uint64_t build_rows, uint64_t probe_rows, int nthreads, int partition_bits, int swwc,
+                            double seconds, hash_join_result* out) {
+    if (!out || build_rows == 0 || probe_rows == 0 || nthreads <= 0 || seconds <= 0 || partition_bits < 0 ||
+        partition_bits > MAX_PARTITION_BITS) {
+        return -EINVAL;
+    }
+    memset(out, 0, sizeof(*out));
+    size_t parts = (size_t)1 << partition_bits;
+    size_t mask = parts - 1;
+    // Shared table: 2x the build side; partitioned: per-thread tables sized at join time
+    size_t table_slots = 2;
+    while (table_slots < 2 * build_rows) table_slots <<= 1;
+    Tuple* build = alloc_lines<Tuple>(build_rows);
+    Tuple* probe = alloc_lines<Tuple>(probe_rows);
+    Tuple* build_parts = partition_bits ? alloc_lines<Tuple>(build_rows) : nullptr;
+    Tuple* probe_parts = partition_bits ? alloc_lines<Tuple>(probe_rows) : nullptr;
+    Tuple* table = partition_bits ? nullptr : alloc_lines<Tuple>(table_slots);
+    if (!build || !probe || (partition_bits ? !build_parts || !probe_parts : !table)) {
+        for (Tuple* p : {build, probe, build_parts, probe_parts, table}) free(p);
+        return -ENOMEM;
+    }
+
+    std::vector<int> cpus = allowed_cpus();
+    std::vector<std::vector<size_t>> build_hist(nthreads, std::vector<size_t>(parts));
+    std::vector<std::vector<size_t>> probe_hist(nthreads, std::vector<size_t>(parts));
+    std::vector<size_t> build_start(parts + 1), probe_start(parts + 1);
+    std::vector<uint64_t> expected(nthreads, 0), matches(nthreads, 0), checksums(nthreads, 0);
+    hs::Barrier barrier(nthreads);
+    std::atomic<bool> stop{false};
+    std::atomic<size_t> next_part{0};
+    uint64_t total_ns = 0, partition_ns = 0, joins = 0, join_matches = 0;
+    bool valid = true;
+    std::vector<std::thread> threads;
+    for (int id = 0; id < nthreads; ++id) {
+        threads.emplace_back([&, id] {
+            hs::pin_to_cpu(cpus.empty() ? -1 : cpus[id % cpus.size()]);
+            size_t b0 = build_rows * id / nthreads, b1 = build_rows * (id + 1) / nthreads;
+            size_t p0 = probe_rows * id / nthreads, p1 = probe_rows * (id + 1) / nthreads;
+            for (size_t i = b0; i < b1; ++i) build[i] = {fmix64(i + 1), i};
+            for (size_t i = p0; i < p1; ++i) {
+                uint64_t row = splitmix64(i) % build_rows;
+                probe[i] = {fmix64(row + 1), i};
+                expected[id] += row;
+            }
+            std::vector<size_t> pos(parts);
+            std::vector<Tuple> lines, local;
+            auto bucket = [mask](const Tuple& t) { return t.key & mask; };
+            barrier.wait();
+            while (!stop.load(std::memory_order_acquire)) {
+                uint64_t start = hs::now_ns(), partitioned = start;
+                uint64_t found = 0, sum = 0;
+                if (partition_bits) {
+                    std::fill(build_hist[id].begin(), build_hist[id].end(), 0);
+                    std::fill(probe_hist[id].begin(), probe_hist[id].end(), 0);
+                    for (size_t i = b0; i < b1; ++i) ++build_hist[id][bucket(build[i])];
+                    for (size_t i = p0; i < p1; ++i) ++probe_hist[id][bucket(probe[i])];
+                    barrier.wait();
+                    scatter_offsets(build_hist, id, parts, pos.data());
+                    if (id == 0) {
+                        for (size_t p = 0; p <= parts; ++p) {
+                            build_start[p] = p ? build_start[p - 1] : 0;
+                            probe_start[p] = p ? probe_start[p - 1] : 0;
+                            for (int t = 0; p && t < nthreads; ++t) {
+                                build_start[p] += build_hist[t][p - 1];
+                                probe_start[p] += probe_hist[t][p - 1];
+                            }
+                        }
+                        next_part.store(0);
+                    }
+                    scatter(build + b0, b1 - b0, build_parts, pos.data(), parts, bucket, swwc != 0, lines);
+                    scatter_offsets(probe_hist, id, parts, pos.data());
+                    scatter(probe + p0, p1 - p0, probe_parts, pos.data(), parts, bucket, swwc != 0, lines);
+                    barrier.wait();
+                    partitioned = hs::now_ns();
+                    // Pieces are handed out dynamically; the table for each fits in cache
+                    for (size_t p = next_part++; p < parts; p = next_part++) {
+                        size_t nb = build_start[p + 1] - build_start[p];
+                        size_t slots = 2;
+                        while (slots < 2 * nb) slots <<= 1;
+                        local.assign(slots, Tuple{0, 0});
+                        for (size_t i = build_start[p]; i < build_start[p + 1]; ++i) {
+                            const Tuple& t = build_parts[i];
+                            size_t s = (t.key >> partition_bits) & (slots - 1);
+                            while (local[s].key) s = (s + 1) & (slots - 1);
+                            local[s] = t;
+                        }
+                        for (size_t i = probe_start[p]; i < probe_start[p + 1]; ++i) {
+                            uint64_t key = probe_parts[i].key;
+                            for (size_t s = (key >> partition_bits) & (slots - 1); local[s].key;
+                                 s = (s + 1) & (slots - 1)) {
+                                if (local[s].key == key) {
+                                    ++found;
+                                    sum += local[s].payload;
+                                    break;
+                                }
+                            }
+                        }
+                    }
+                } else {
+                    size_t s0 = table_slots * id / nthreads, s1 = table_slots * (id + 1) / nthreads;
+                    memset(table + s0, 0, (s1 - s0) * sizeof(Tuple));
+                    barrier.wait();
+                    for (size_t i = b0; i < b1; ++i) {
+                        size_t s = build[i].key & (table_slots - 1);
+                        uint64_t empty = 0;
+                        while (!__atomic_compare_exchange_n(&table[s].key, &empty, build[i].key, false,
+                                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                            s = (s + 1) & (table_slots - 1);
+                            empty = 0;
+                        }
+                        table[s].payload = build[i].payload;
+                    }
+                    barrier.wait();
+                    for (size_t i = p0; i < p1; ++i) {
+                        uint64_t key = probe[i].key;
+                        for (size_t s = key & (table_slots - 1); table[s].key; s = (s + 1) & (table_slots - 1)) {
+                            if (table[s].key == key) {
+                                ++found;
+                                sum += table[s].payload;
+                                break;
+                            }
+                        }
+                    }
+                }
+                matches[id] = found;
+                checksums[id] = sum;
+                barrier.wait();
+                if (id == 0) {
+                    uint64_t end = hs::now_ns();
+                    total_ns += end - start;
+                    partition_ns += partitioned - start;
+                    uint64_t m = 0, got = 0, want = 0;
+                    for (int t = 0; t < nthreads; ++t) {
+                        m += matches[t];
+                        got += checksums[t];
+                        want += expected[t];
+                    }
+                    valid = valid && m == probe_rows && got == want;
+                    join_matches = m;
+                    ++joins;
+                    if (total_ns >= (uint64_t)(seconds * 1e9)) stop.store(true, std::memory_order_release);
+                }
+                barrier.wait();
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    for (Tuple* p : {build, probe, build_parts, probe_parts, table}) free(p);
+
+    out->joins = joins;
+    out->matches = join_matches;
+    out->valid = valid;
+    out->seconds = total_ns / 1e9;
+    out->tuples_s = (double)(build_rows + probe_rows) * joins / out->seconds;
+    out->partition_share = total_ns ? (double)partition_ns / total_ns : 0.0;
+    return 0;
+}
@@ -0,0 +1,130 @@
+/**
+ * Roofline sweep: the CPU counterpart of memory_bandwidth_kernel
+ * Every element of a float buffer is loaded, run through a chain of
+ * val * a + b updates and stored back, so one pass moves 8 bytes per element
+ * and the chain length sets the arithmetic intensity (FLOP per byte)
+ */
+
+#include "common.h"
+
+#include <errno.h>
+#include <stdlib.h>
+
+#include <thread>
+
+struct roofline_result {
+    double intensity;  // FLOP per byte of memory traffic
+    double gflops;
+    double gb_s;
+    double seconds;
+    uint64_t bytes;    // total bytes loaded and stored
+};
+
+namespace {
+
+// Independent chains per chunk: enough vector registers in flight to hide
+// the mul/add latency once the chain is long enough to be compute bound
+const size_t LANES = 64;
+const size_t CHUNK = 4096;  // elements between deadline checks
+const float A = 1.000001f;
+const float B = 0.000001f;
+
+#if defined(__x86_64__)
+#define HS_MULTIVERSION __attribute__((target_clones("arch=x86-64-v3", "default")))
+#else
+#define HS_MULTIVERSION
+#endif
+
+/**
+ * One load / chain / store pass over [p, p + n); n is a multiple of LANES
+ * flops == 1 is a single add per element, otherwise flops / 2 mul+add pairs
+ */
+HS_MULTIVERSION
+void update(float* p, size_t n, int flops) {
+    for (size_t i = 0; i < n; i += LANES) {
+        float v[LANES];
+        for (size_t j = 0; j < LANES; ++j) v[j] = p[i + j];
+        if (flops == 1) {
+            for (size_t j = 0; j < LANES; ++j) v[j] += B;
+        } else {
+            for (int k = 0; k < flops / 2; ++k) {
+                for (size_t j = 0; j < LANES; ++j) v[j] = v[j] * A + B;
+            }
+        }
+        for (size_t j = 0; j < LANES; ++j) p[i + j] = v[j];
+    }
+}
+
+}  // namespace
+
+/**
+ * Run nthreads over a shared buffer of buffer_bytes, each sweeping its own
+ * slice (first-touched by that thread) until `seconds` elapse
+ * flops_per_element must be 1 or even; intensity = flops_per_element / 8
+ */
+HS_EXPORT int roofline_run(int flops_per_element, uint64_t buffer_bytes, int nthreads, double seconds,
+                           roofline_result* out) {
+    if (!out || nthreads <= 0 || seconds <= 0 || flops_per_element <= 0 ||
+        (flops_per_element != 1 && flops_per_element % 2 != 0)) {
+        return -EINVAL;
+    }
+    size_t per_thread = buffer_bytes / sizeof(float) / nthreads / CHUNK * CHUNK;
+    if (per_thread == 0) return -EINVAL;
+    float* buffer = static_cast<float*>(aligned_alloc(64, per_thread * nthreads * sizeof(float)));
+    if (!buffer) return -ENOMEM;
+
+    cpu_set_t allowed;
+    sched_getaffinity(0, sizeof(allowed), &allowed);
+    std::vector<int> cpus;
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &allowed)) cpus.push_back(cpu);
+    }
+
+    std::atomic<int> ready{0};
+    std::atomic<bool> go{false};
+    std::vector<uint64_t> elements(nthreads, 0);
+    std::vector<uint64_t> elapsed(nthreads, 0);
+    std::vector<std::thread> threads;
+    uint64_t budget_ns = (uint64_t)(seconds * 1e9);
+    for (int id = 0; id < nthreads; ++id) {
+        threads.emplace_back([&, id] {
+            hs::pin_to_cpu(cpus.empty() ? -1 : cpus[id % cpus.size()]);
+            float* slice = buffer + (size_t)id * per_thread;
+            for (size_t i = 0; i < per_thread; ++i) slice[i] = 1.0f;
+            ready.fetch_add(1);
+            while (!go.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            uint64_t start = hs::now_ns();
+            uint64_t done = 0;
+            size_t offset = 0;
+            uint64_t now = start;
+            while (now - start < budget_ns) {
+                update(slice + offset, CHUNK, flops_per_element);
+                done += CHUNK;
+                offset = offset + CHUNK == per_thread ? 0 : offset + CHUNK;
+                now = hs::now_ns();
+            }
+            elements[id] = done;
+            elapsed[id] = now - start;
+        });
+    }
+    while (ready.load() < nthreads) {
+        std::this_thread::yield();
+    }
+    go.store(true, std::memory_order_release);
+    for (auto& t : threads) {
+        t.join();
+    }
+    free(buffer);
+
+    uint64_t total = 0;
+    for (uint64_t n : elements) total += n;
+    double wall = *std::max_element(elapsed.begin(), elapsed.end()) / 1e9;
+    out->intensity = flops_per_element / 8.0;
+    out->bytes = total * 2 * sizeof(float);
+    out->seconds = wall;
+    out->gflops = (double)total * flops_per_element / wall / 1e9;
+    out->gb_s = out->bytes / wall / 1e9;
+    return 0;
+}
@@ -0,0 +1,239 @@
+/**
+ * Memory-mapped reader for the binary run format (see runfile.py)
+ * Seeks by time range through the block index and hands out pointers to
+ * columns inside the mapping, so callers decode only the blocks they need
+ */
+
+#include "common.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+struct runfile_info {
+    uint64_t rows;
+    uint32_t blocks;
+    uint32_t columns;        // timestamp column plus one per metric
+    uint32_t header_length;  // bytes of header JSON
+    double first_time;
+    double last_time;
+};
+
+namespace {
+
+const char MAGIC[8] = {'H', 'S', 'R', 'U', 'N', '0', '0', '1'};
+const char END_MAGIC[8] = {'H', 'S', 'R', 'U', 'N', 'E', 'N', 'D'};
+
+#pragma pack(push, 1)
+struct IndexEntry {
+    uint64_t offset;
+    uint32_t rows;
+    uint32_t pad;
+    double first;
+    double last;
+};
+
+struct Footer {
+    uint64_t index_offset;
+    uint64_t blocks;
+    uint64_t meta_offset;
+    char magic[8];
+};
+
+struct BlockHeader {
+    uint32_t rows;
+    uint32_t columns;
+};
+#pragma pack(pop)
+
+struct RunFile {
+    const uint8_t* base = nullptr;
+    size_t size = 0;
+    const char* header = nullptr;
+    uint32_t header_length = 0;
+    const char* meta = nullptr;
+    uint64_t meta_length = 0;
+    const IndexEntry* index = nullptr;
+    uint32_t blocks = 0;
+    uint32_t columns = 0;
+};
+
+/**
+ * Validate the footer, index and every block header against the file size
+ * Offsets come from the file, so every bound is checked by subtraction or
+ * division from a value already known to be in range: sums and products of
+ * untrusted fields could wrap and pass
+ */
+int parse(RunFile* run) {
+    if (run->size < sizeof(MAGIC) + sizeof(uint32_t) + sizeof(Footer) ||
+        memcmp(run->base, MAGIC, sizeof(MAGIC)) != 0) {
+        return -EINVAL;
+    }
+    memcpy(&run->header_length, run->base + sizeof(MAGIC), sizeof(uint32_t));
+    size_t header_end = sizeof(MAGIC) + sizeof(uint32_t) + (size_t)run->header_length;
+    Footer footer;
+    memcpy(&footer, run->base + run->size - sizeof(Footer), sizeof(Footer));
+    if (memcmp(footer.magic, END_MAGIC, sizeof(END_MAGIC)) != 0 || footer.blocks > UINT32_MAX ||
+        footer.meta_offset > run->size - sizeof(Footer) || footer.index_offset > footer.meta_offset ||
+        header_end > footer.index_offset ||
+        footer.blocks > (footer.meta_offset - footer.index_offset) / sizeof(IndexEntry)) {
+        return -EINVAL;
+    }
+    run->header = reinterpret_cast<const char*>(run->base + sizeof(MAGIC) + sizeof(uint32_t));
+    run->meta = reinterpret_cast<const char*>(run->base + footer.meta_offset);
+    run->meta_length = run->size - sizeof(Footer) - footer.meta_offset;
+    run->index = reinterpret_cast<const IndexEntry*>(run->base + footer.index_offset);
+    run->blocks = (uint32_t)footer.blocks;
+    for (uint32_t b = 0; b < run->blocks; ++b) {
+        const IndexEntry& entry = run->index[b];
+        BlockHeader block;
+        if (entry.offset % sizeof(double) != 0 || entry.offset < header_end ||
+            entry.offset > footer.index_offset || footer.index_offset - entry.offset < sizeof(block)) {
+            return -EINVAL;
+        }
+        memcpy(&block, run->base + entry.offset, sizeof(block));
+        // rows * columns doubles must fit before the index: compare by division
+        uint64_t capacity = (footer.index_offset - entry.offset - sizeof(block)) / sizeof(double);
+        if (block.rows != entry.rows || block.columns == 0 ||
+            (run->columns && block.columns != run->columns) || block.rows > capacity / block.columns) {
+            return -EINVAL;
+        }
+        run->columns = block.columns;
+    }
+    return 0;
+}
+
+const double* column_ptr(const RunFile* run, uint32_t block, uint32_t column) {
+    const IndexEntry& entry = run->index[block];
+    return reinterpret_cast<const double*>(run->base + entry.offset + sizeof(BlockHeader)) +
+           (size_t)column * entry.rows;
+}
+
+}  // namespace
+
+/**
+ * Map a run file read-only and validate its layout
+ * Returns 0 and an opaque handle, or a negative errno
+ */
+HS_EXPORT int runfile_open(const char* path, void** handle) {
+    if (!path || !handle) return -EINVAL;
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return -errno;
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        int err = errno;
+        close(fd);
+        return -err;
+    }
+    if (st.st_size == 0) {
+        close(fd);
+        return -EINVAL;
+    }
+    void* base = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    int err = errno;
+    close(fd);
+    if (base == MAP_FAILED) return -err;
+
+    RunFile* run = new RunFile;
+    run->base = static_cast<const uint8_t*>(base);
+    run->size = st.st_size;
+    int rc = parse(run);
+    if (rc < 0) {
+        munmap(base, st.st_size);
+        delete run;
+        return rc;
+    }
+    *handle = run;
+    return 0;
+}
+
+HS_EXPORT void runfile_close(void* handle) {
+    RunFile* run = static_cast<RunFile*>(handle);
+    if (!run) return;
+    munmap(const_cast<uint8_t*>(run->base), run->size);
+    delete run;
+}
+
+HS_EXPORT int runfile_get_info(void* handle, runfile_info* out) {
+    const RunFile* run = static_cast<const RunFile*>(handle);
+    if (!run || !out) return -EINVAL;
+    memset(out, 0, sizeof(*out));
+    out->blocks = run->blocks;
+    out->columns = run->columns;
+    out->header_length = run->header_length;
+    for (uint32_t b = 0; b < run->blocks; ++b) {
+        out->rows += run->index[b].rows;
+    }
+    if (run->blocks) {
+        out->first_time = run->index[0].first;
+        out->last_time = run->index[run->blocks - 1].last;
+    }
+    return 0;
+}
+
+/**
+ * Header JSON (metric names, manifest); not NUL-terminated, see header_length
+ */
+HS_EXPORT const char* runfile_header(void* handle) {
+    const RunFile* run = static_cast<const RunFile*>(handle);
+    return run ? run->header : nullptr;
+}
+
+/**
+ * Metadata JSON trailer (results, events, ...); not NUL-terminated
+ */
+HS_EXPORT int runfile_meta(void* handle, const char** data, uint64_t* length) {
+    const RunFile* run = static_cast<const RunFile*>(handle);
+    if (!run || !data || !length) return -EINVAL;
+    *data = run->meta;
+    *length = run->meta_length;
+    return 0;
+}
+
+/**
+ * Blocks overlapping [start, end] via binary search on the block index
+ * (blocks are written in time order); -ENOENT when none overlap
+ */
+HS_EXPORT int runfile_seek(void* handle, double start, double end, uint32_t* first_block,
+                           uint32_t* last_block) {
+    const RunFile* run = static_cast<const RunFile*>(handle);
+    if (!run || !first_block || !last_block || start > end) return -EINVAL;
+    const IndexEntry* begin = run->index;
+    const IndexEntry* stop = run->index + run->blocks;
+    const IndexEntry* first = std::lower_bound(
+        begin, stop, start, [](const IndexEntry& e, double t) { return e.last < t; });
+    const IndexEntry* last = std::upper_bound(
+        first, stop, end, [](double t, const IndexEntry& e) { return t < e.first; });
+    if (first == last) return -ENOENT;
+    *first_block = (uint32_t)(first - begin);
+    *last_block = (uint32_t)(last - begin) - 1;
+    return 0;
+}
+
+/**
+ * Row range [row_begin, row_end) of one block whose timestamps fall in [start, end]
+ */
+HS_EXPORT int runfile_block_rows(void* handle, uint32_t block, double start, double end,
+                                 uint64_t* row_begin, uint64_t* row_end) {
+    const RunFile* run = static_cast<const RunFile*>(handle);
+    if (!run || block >= run->blocks || !row_begin || !row_end) return -EINVAL;
+    const double* t = column_ptr(run, block, 0);
+    uint32_t rows = run->index[block].rows;
+    *row_begin = std::lower_bound(t, t + rows, start) - t;
+    *row_end = std::upper_bound(t, t + rows, end) - t;
+    return 0;
+}
+
+/**
+ * Pointer to one column of one block inside the mapping (column 0 = timestamps)
+ */
+HS_EXPORT int runfile_column(void* handle, uint32_t block, uint32_t column, const double** data,
+                             uint64_t* rows) {
+    const RunFile* run = static_cast<const RunFile*>(handle);
+    if (!run || block >= run->blocks || column >= run->columns || !data || !rows) return -EINVAL;
+    *data = column_ptr(run, block, column);
+    *rows = run->index[block].rows;
+    return 0;
+}
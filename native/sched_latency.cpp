@@ -0,0 +1,103 @@
+/**
+ * Scheduler wake-up latency measurement (cyclictest-style)
+ * One real-time measurement thread per CPU sleeps until absolute timer
+ * deadlines and records how late it actually woke up
+ */
+
+#include "common.h"
+
+#include <errno.h>
+#include <string.h>
+
+#include <thread>
+
+struct sched_latency_result {
+    uint64_t samples;
+    uint64_t overflows;  // wake-ups later than the histogram range
+    double min_ns;
+    double avg_ns;
+    double max_ns;
+    int realtime;        // 1 if SCHED_FIFO was granted
+};
+
+namespace {
+
+void measure_cpu(int cpu, int priority, uint64_t interval_ns, uint64_t duration_ns,
+                 uint64_t* histogram, int buckets, uint64_t bucket_ns,
+                 sched_latency_result* out) {
+    hs::pin_to_cpu(cpu);
+    struct sched_param param;
+    memset(&param, 0, sizeof(param));
+    param.sched_priority = priority;
+    out->realtime = (priority > 0 &&
+                     pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0) ? 1 : 0;
+
+    uint64_t min_lat = UINT64_MAX, max_lat = 0, total = 0;
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    uint64_t next_ns = (uint64_t)next.tv_sec * 1000000000ull + next.tv_nsec;
+    uint64_t end_ns = next_ns + duration_ns;
+
+    while (next_ns < end_ns) {
+        next_ns += interval_ns;
+        next.tv_sec = next_ns / 1000000000ull;
+        next.tv_nsec = next_ns % 1000000000ull;
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, nullptr) == EINTR) {
+        }
+        // Deadlines live on CLOCK_MONOTONIC, so read that clock rather than the
+        // TSC: NTP slewing between the two would show up as fake latency
+        uint64_t now = hs::now_ns();
+        uint64_t lat = now > next_ns ? now - next_ns : 0;
+
+        uint64_t bucket = lat / bucket_ns;
+        if (bucket >= (uint64_t)buckets) {
+            bucket = buckets - 1;
+            out->overflows++;
+        }
+        histogram[bucket]++;
+        min_lat = std::min(min_lat, lat);
+        max_lat = std::max(max_lat, lat);
+        total += lat;
+        out->samples++;
+
+        // Overran one or more periods: resynchronize instead of firing a burst
+        if (now > next_ns + interval_ns) {
+            next_ns = now - (now - next_ns) % interval_ns;
+        }
+    }
+    if (out->samples) {
+        out->min_ns = (double)min_lat;
+        out->max_ns = (double)max_lat;
+        out->avg_ns = (double)total / out->samples;
+    }
+}
+
+}  // namespace
+
+/**
+ * Run one measurement thread per listed CPU for the given time
+ * histograms holds ncpus consecutive arrays of `buckets` counters of
+ * bucket_ns width; the last bucket collects overflows
+ * Returns 0 on success or a negative errno
+ */
+HS_EXPORT int sched_latency_run(const int* cpus, int ncpus, int priority, uint64_t interval_ns,
+                                double seconds, uint64_t* histograms, int buckets,
+                                uint64_t bucket_ns, sched_latency_result* out) {
+    if (!cpus || ncpus <= 0 || !histograms || buckets <= 0 || bucket_ns == 0 ||
+        interval_ns == 0 || !out) {
+        return -EINVAL;
+    }
+    memset(out, 0, sizeof(*out) * ncpus);
+    memset(histograms, 0, sizeof(uint64_t) * buckets * ncpus);
+    uint64_t duration_ns = (uint64_t)(seconds * 1e9);
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < ncpus; ++i) {
+        threads.emplace_back(measure_cpu, cpus[i], priority, interval_ns, duration_ns,
+                             histograms + (size_t)i * buckets, buckets, bucket_ns, &out[i]);
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    return 0;
+}
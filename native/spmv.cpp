@@ -0,0 +1,477 @@
+/**
+ * Sparse matrix-vector product y = A x over synthetic matrices (banded,
+ * power-law row lengths, uniform random) in CSR, ELL and SELL-C-sigma
+ * Rows are partitioned across pinned threads by stored elements, and each
+ * thread first-touches its own partition so the pages land on its NUMA node
+ */
+
+#include "common.h"
+
+#include <errno.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <thread>
+
+enum SpmvFormat {
+    SPMV_CSR = 0,
+    SPMV_ELL = 1,
+    SPMV_SELL = 2,
+};
+
+enum SpmvPattern {
+    SPMV_BANDED = 0,     // columns within a band around the diagonal
+    SPMV_POWER_LAW = 1,  // Pareto row lengths, random columns
+    SPMV_RANDOM = 2,     // fixed row length, uniformly random columns
+};
+
+struct spmv_result {
+    double gflops;         // 2 FLOP per nonzero
+    double gb_s;           // matrix storage + x and y once per product
+    double fill;           // stored elements (with padding) per nonzero
+    double max_rel_error;  // against a serial CSR product
+    uint64_t nnz;
+    uint64_t max_row_nnz;
+    double seconds;
+};
+
+namespace {
+
+const size_t SELL_C = 8;        // rows per chunk: one AVX-512 vector of doubles
+const size_t SELL_SIGMA = 256;  // rows sorted by length within windows of this size
+const double PARETO_ALPHA = 2.2;
+const double MAX_FILL = 16.0;   // refuse padded formats beyond this many stored elements per nonzero
+
+#if defined(__x86_64__)
+#define HS_MULTIVERSION __attribute__((target_clones("arch=x86-64-v4", "arch=x86-64-v3", "default")))
+#else
+#define HS_MULTIVERSION
+#endif
+
+uint64_t splitmix64(uint64_t* state) {
+    uint64_t z = (*state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+double uniform(uint64_t* state) {
+    return (splitmix64(state) >> 11) * 0x1.0p-53;
+}
+
+/**
+ * The matrix as generated, in CSR with sorted columns per row
+ */
+struct Source {
+    size_t rows = 0;
+    std::vector<uint32_t> ptr, col;
+    std::vector<double> val;
+};
+
+void generate(int pattern, size_t rows, int nnz_per_row, Source* m) {
+    m->rows = rows;
+    m->ptr.assign(1, 0);
+    size_t band = std::max<size_t>(4 * nnz_per_row, 1);
+    std::vector<uint32_t> cols;
+    for (size_t r = 0; r < rows; ++r) {
+        uint64_t state = r * 0x2545f4914f6cdd1dull + pattern;
+        size_t lo = 0, span = rows;
+        size_t len = nnz_per_row;
+        if (pattern == SPMV_BANDED) {
+            lo = r > band ? r - band : 0;
+            span = std::min(rows, r + band + 1) - lo;
+        } else if (pattern == SPMV_POWER_LAW) {
+            double xm = nnz_per_row * (PARETO_ALPHA - 1) / PARETO_ALPHA;
+            len = (size_t)(xm / pow(1.0 - uniform(&state), 1.0 / PARETO_ALPHA));
+        }
+        len = std::min(std::max<size_t>(len, 1), std::max<size_t>(span / 2, 1));
+        cols.clear();
+        while (cols.size() < len) {
+            while (cols.size() < len) cols.push_back((uint32_t)(lo + splitmix64(&state) % span));
+            std::sort(cols.begin(), cols.end());
+            cols.erase(std::unique(cols.begin(), cols.end()), cols.end());
+        }
+        for (uint32_t c : cols) {
+            m->col.push_back(c);
+            m->val.push_back(0.5 + uniform(&state));
+        }
+        m->ptr.push_back((uint32_t)m->col.size());
+    }
+}
+
+double x_value(size_t i) {
+    return 1.0 + (i % 7) * 0.125;
+}
+
+template <class T>
+T* alloc_untouched(size_t n) {
+    // Left untouched so the first write places each page
+    return static_cast<T*>(aligned_alloc(64, (std::max<size_t>(n, 1) * sizeof(T) + 63) / 64 * 64));
+}
+
+/**
+ * A storage format split into per-thread partitions; fill() copies one
+ * partition out of the source (and so first-touches it), run() multiplies it
+ */
+class Format {
+public:
+    virtual ~Format() = default;
+    virtual size_t stored() const = 0;
+    virtual size_t bytes() const = 0;  // storage, x and y traffic for one product
+    virtual void fill(const Source& m, int part, double* x, double* y) = 0;
+    virtual void run(int part, const double* x, double* y) const = 0;
+    virtual void gather(const double* y, double* out) const = 0;  // y in original row order
+    std::vector<size_t> bounds;  // partition boundaries in rows (chunks for SELL)
+    std::vector<double> shares;  // fraction of the stored elements in each partition
+};
+
+/**
+ * Split [0, n) so each part holds about the same share of prefix[n] (prefix
+ * is a running total of stored elements)
+ */
+template <class P>
+void balance(Format* f, const P* prefix, size_t n, int parts) {
+    f->bounds.assign(parts + 1, n);
+    f->bounds[0] = 0;
+    for (int p = 1; p < parts; ++p) {
+        P target = (P)((uint64_t)prefix[n] * p / parts);
+        size_t at = std::lower_bound(prefix, prefix + n + 1, target) - prefix;
+        f->bounds[p] = std::max(f->bounds[p - 1], std::min(n, at));
+    }
+    f->shares.resize(parts);
+    for (int p = 0; p < parts; ++p) {
+        f->shares[p] = prefix[n] ? (double)(prefix[f->bounds[p + 1]] - prefix[f->bounds[p]]) / prefix[n] : 0.0;
+    }
+}
+
+void touch_vectors(size_t r0, size_t r1, double* x, double* y) {
+    for (size_t r = r0; r < r1; ++r) {
+        x[r] = x_value(r);
+        y[r] = 0.0;
+    }
+}
+
+HS_MULTIVERSION
+void csr_rows(const uint32_t* ptr, const uint32_t* col, const double* val, const double* x, double* y, size_t r0,
+              size_t r1) {
+    for (size_t r = r0; r < r1; ++r) {
+        double sum = 0.0;
+        for (uint32_t k = ptr[r]; k < ptr[r + 1]; ++k) sum += val[k] * x[col[k]];
+        y[r] = sum;
+    }
+}
+
+class Csr : public Format {
+public:
+    Csr(const Source& m, int parts) : rows_(m.rows), nnz_(m.col.size()) {
+        ptr_ = alloc_untouched<uint32_t>(rows_ + 1);
+        col_ = alloc_untouched<uint32_t>(nnz_);
+        val_ = alloc_untouched<double>(nnz_);
+        balance(this, m.ptr.data(), rows_, parts);
+    }
+    ~Csr() override {
+        free(ptr_);
+        free(col_);
+        free(val_);
+    }
+    bool ok() const { return ptr_ && col_ && val_; }
+    size_t stored() const override { return nnz_; }
+    size_t bytes() const override { return nnz_ * 12 + rows_ * (4 + 8 + 8); }
+    void fill(const Source& m, int part, double* x, double* y) override {
+        size_t r0 = bounds[part], r1 = bounds[part + 1];
+        memcpy(ptr_ + r0, m.ptr.data() + r0, (r1 - r0 + (part + 2 == (int)bounds.size())) * sizeof(uint32_t));
+        memcpy(col_ + m.ptr[r0], m.col.data() + m.ptr[r0], (m.ptr[r1] - m.ptr[r0]) * sizeof(uint32_t));
+        memcpy(val_ + m.ptr[r0], m.val.data() + m.ptr[r0], (m.ptr[r1] - m.ptr[r0]) * sizeof(double));
+        touch_vectors(r0, r1, x, y);
+    }
+    void run(int part, const double* x, double* y) const override {
+        csr_rows(ptr_, col_, val_, x, y, bounds[part], bounds[part + 1]);
+    }
+    void gather(const double* y, double* out) const override { memcpy(out, y, rows_ * sizeof(double)); }
+
+private:
+    size_t rows_, nnz_;
+    uint32_t* ptr_;
+    uint32_t* col_;
+    double* val_;
+};
+
+HS_MULTIVERSION
+void ell_rows(size_t width, const uint32_t* col, const double* val, const double* x, double* y, size_t r0,
+              size_t r1) {
+    for (size_t r = r0; r < r1; ++r) {
+        double sum = 0.0;
+        for (size_t k = r * width; k < (r + 1) * width; ++k) sum += val[k] * x[col[k]];
+        y[r] = sum;
+    }
+}
+
+/**
+ * Every row padded to the longest one, row-major (the CPU-friendly layout);
+ * padding repeats the row's last column with a zero value
+ */
+class Ell : public Format {
+public:
+    Ell(const Source& m, int parts, size_t width) : rows_(m.rows), width_(width) {
+        col_ = alloc_untouched<uint32_t>(rows_ * width_);
+        val_ = alloc_untouched<double>(rows_ * width_);
+        std::vector<size_t> prefix(rows_ + 1);
+        for (size_t r = 0; r <= rows_; ++r) prefix[r] = r;
+        balance(this, prefix.data(), rows_, parts);
+    }
+    ~Ell() override {
+        free(col_);
+        free(val_);
+    }
+    bool ok() const { return col_ && val_; }
+    size_t stored() const override { return rows_ * width_; }
+    size_t bytes() const override { return stored() * 12 + rows_ * (8 + 8); }
+    void fill(const Source& m, int part, double* x, double* y) override {
+        for (size_t r = bounds[part]; r < bounds[part + 1]; ++r) {
+            size_t len = m.ptr[r + 1] - m.ptr[r];
+            for (size_t k = 0; k < width_; ++k) {
+                size_t src = m.ptr[r] + std::min(k, len - 1);
+                col_[r * width_ + k] = m.col[src];
+                val_[r * width_ + k] = k < len ? m.val[src] : 0.0;
+            }
+        }
+        touch_vectors(bounds[part], bounds[part + 1], x, y);
+    }
+    void run(int part, const double* x, double* y) const override {
+        ell_rows(width_, col_, val_, x, y, bounds[part], bounds[part + 1]);
+    }
+    void gather(const double* y, double* out) const override { memcpy(out, y, rows_ * sizeof(double)); }
+
+private:
+    size_t rows_, width_;
+    uint32_t* col_;
+    double* val_;
+};
+
+/**
+ * Chunks of C rows, each padded to its longest row and stored column-major so
+ * one vector holds element j of C consecutive rows; the lane loop vectorizes
+ * (with gathers from x) without reordering any row's sum
+ */
+HS_MULTIVERSION
+void sell_chunks(const uint64_t* chunk_ptr, const uint32_t* width, const uint32_t* col, const double* val,
+                 const double* x, double* y, size_t c0, size_t c1) {
+    for (size_t c = c0; c < c1; ++c) {
+        double sum[SELL_C] = {};
+        const uint32_t* cc = col + chunk_ptr[c];
+        const double* vc = val + chunk_ptr[c];
+        uint32_t w = width[c];
+        for (uint32_t j = 0; j < w; ++j) {
+            // Kept as a loop so it is vectorized with gathers; once fully
+            // unrolled, GCC's SLP pass does not form gathers
+#pragma GCC unroll 1
+            for (size_t lane = 0; lane < SELL_C; ++lane) {
+                sum[lane] += vc[j * SELL_C + lane] * x[cc[j * SELL_C + lane]];
+            }
+        }
+        for (size_t lane = 0; lane < SELL_C; ++lane) y[c * SELL_C + lane] = sum[lane];
+    }
+}
+
+/**
+ * SELL-C-sigma: rows sorted by length (longest first) within windows of sigma
+ * rows, so chunks group rows of similar length and padding stays small
+ * y is produced in the permuted order; gather() undoes the permutation
+ */
+class Sell : public Format {
+public:
+    Sell(const Source& m, int parts) : rows_(m.rows) {
+        size_t chunks = (rows_ + SELL_C - 1) / SELL_C;
+        padded_ = chunks * SELL_C;
+        perm_.resize(padded_);
+        for (size_t r = 0; r < padded_; ++r) perm_[r] = r;
+        auto len = [&](size_t r) { return r < rows_ ? m.ptr[r + 1] - m.ptr[r] : 0u; };
+        for (size_t w = 0; w < padded_; w += SELL_SIGMA) {
+            std::stable_sort(perm_.begin() + w, perm_.begin() + std::min(padded_, w + SELL_SIGMA),
+                             [&](size_t a, size_t b) { return len(a) > len(b); });
+        }
+        widths_.resize(chunks);
+        chunk_prefix_.assign(chunks + 1, 0);
+        for (size_t c = 0; c < chunks; ++c) {
+            uint32_t width = 0;
+            for (size_t lane = 0; lane < SELL_C; ++lane) width = std::max(width, len(perm_[c * SELL_C + lane]));
+            widths_[c] = width;
+            chunk_prefix_[c + 1] = chunk_prefix_[c] + width * SELL_C;
+        }
+        chunk_ptr_ = alloc_untouched<uint64_t>(chunks + 1);
+        width_ = alloc_untouched<uint32_t>(chunks);
+        col_ = alloc_untouched<uint32_t>(chunk_prefix_[chunks]);
+        val_ = alloc_untouched<double>(chunk_prefix_[chunks]);
+        balance(this, chunk_prefix_.data(), chunks, parts);
+    }
+    ~Sell() override {
+        free(chunk_ptr_);
+        free(width_);
+        free(col_);
+        free(val_);
+    }
+    bool ok() const { return chunk_ptr_ && width_ && col_ && val_; }
+    size_t stored() const override { return chunk_prefix_.back(); }
+    size_t bytes() const override { return stored() * 12 + widths_.size() * 12 + rows_ * (8 + 8); }
+    void fill(const Source& m, int part, double* x, double* y) override {
+        size_t c0 = bounds[part], c1 = bounds[part + 1];
+        for (size_t c = c0; c < c1; ++c) {
+            chunk_ptr_[c] = chunk_prefix_[c];
+            width_[c] = widths_[c];
+            for (size_t lane = 0; lane < SELL_C; ++lane) {
+                size_t r = perm_[c * SELL_C + lane];
+                size_t start = r < rows_ ? m.ptr[r] : 0;
+                size_t len = r < rows_ ? m.ptr[r + 1] - m.ptr[r] : 0;
+                for (size_t j = 0; j < widths_[c]; ++j) {
+                    size_t at = chunk_prefix_[c] + j * SELL_C + lane;
+                    col_[at] = len ? m.col[start + std::min(j, len - 1)] : 0;
+                    val_[at] = j < len ? m.val[start + j] : 0.0;
+                }
+            }
+        }
+        if (c1 == widths_.size()) chunk_ptr_[c1] = chunk_prefix_[c1];
+        touch_vectors(std::min(rows_, c0 * SELL_C), std::min(rows_, c1 * SELL_C), x, y);
+        for (size_t r = std::max(rows_, c0 * SELL_C); r < c1 * SELL_C; ++r) y[r] = 0.0;
+    }
+    void run(int part, const double* x, double* y) const override {
+        sell_chunks(chunk_ptr_, width_, col_, val_, x, y, bounds[part], bounds[part + 1]);
+    }
+    void gather(const double* y, double* out) const override {
+        for (size_t i = 0; i < padded_; ++i) {
+            if (perm_[i] < rows_) out[perm_[i]] = y[i];
+        }
+    }
+    size_t padded() const { return padded_; }
+
+private:
+    size_t rows_, padded_;
+    std::vector<size_t> perm_;
+    std::vector<uint32_t> widths_;
+    std::vector<uint64_t> chunk_prefix_;
+    uint64_t* chunk_ptr_;
+    uint32_t* width_;
+    uint32_t* col_;
+    double* val_;
+};
+
+}  // namespace
+
+/**
+ * Multiply a rows x rows matrix with about nnz_per_row nonzeros per row on
+ * one thread per entry of cpus (pinned in that order, so callers group CPUs
+ * by NUMA node) for about `seconds`
+ * numa_local != 0: each thread first-touches its partition of the matrix, x
+ * and y; 0: the calling thread touches everything (the NUMA-oblivious case)
+ * Returns -E2BIG when a padded format would store more than MAX_FILL
+ * elements per nonzero (ELL on power-law rows), or another negative errno
+ */
+HS_EXPORT int spmv_run(int format, int pattern, uint64_t rows, int nnz_per_row, const int* cpus, int ncpus,
+                       int numa_local, double seconds, spmv_result* out) {
+    if (!out || !cpus || ncpus <= 0 || seconds <= 0 || rows < SELL_C || rows > UINT32_MAX || nnz_per_row <= 0 ||
+        format < SPMV_CSR || format > SPMV_SELL || pattern < SPMV_BANDED || pattern > SPMV_RANDOM) {
+        return -EINVAL;
+    }
+    if ((double)rows * nnz_per_row > (double)UINT32_MAX / 2) return -E2BIG;
+    memset(out, 0, sizeof(*out));
+    Source m;
+    generate(pattern, rows, nnz_per_row, &m);
+    size_t nnz = m.col.size();
+    uint32_t max_row = 0;
+    for (size_t r = 0; r < rows; ++r) max_row = std::max(max_row, m.ptr[r + 1] - m.ptr[r]);
+
+    Format* f = nullptr;
+    bool ok = false;
+    size_t y_len = rows;
+    if (format == SPMV_CSR) {
+        Csr* csr = new Csr(m, ncpus);
+        ok = csr->ok();
+        f = csr;
+    } else if (format == SPMV_ELL) {
+        if ((double)rows * max_row > MAX_FILL * nnz) return -E2BIG;
+        Ell* ell = new Ell(m, ncpus, max_row);
+        ok = ell->ok();
+        f = ell;
+    } else {
+        Sell* sell = new Sell(m, ncpus);
+        if (sell->stored() > MAX_FILL * nnz) {
+            delete sell;
+            return -E2BIG;
+        }
+        ok = sell->ok();
+        y_len = sell->padded();
+        f = sell;
+    }
+    double* x = alloc_untouched<double>(rows);
+    double* y = alloc_untouched<double>(y_len);
+    if (!ok || !x || !y) {
+        delete f;
+        free(x);
+        free(y);
+        return -ENOMEM;
+    }
+    if (!numa_local) {
+        for (int part = 0; part < ncpus; ++part) f->fill(m, part, x, y);
+    }
+
+    std::atomic<int> ready{0};
+    std::atomic<bool> go{false};
+    std::vector<uint64_t> products(ncpus, 0);
+    std::vector<uint64_t> elapsed(ncpus, 0);
+    std::vector<std::thread> threads;
+    uint64_t budget_ns = (uint64_t)(seconds * 1e9);
+    for (int id = 0; id < ncpus; ++id) {
+        threads.emplace_back([&, id] {
+            hs::pin_to_cpu(cpus[id]);
+            if (numa_local) f->fill(m, id, x, y);
+            ready.fetch_add(1);
+            while (!go.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            uint64_t start = hs::now_ns();
+            uint64_t now = start;
+            uint64_t done = 0;
+            do {
+                f->run(id, x, y);
+                ++done;
+                now = hs::now_ns();
+            } while (now - start < budget_ns);
+            products[id] = done;
+            elapsed[id] = now - start;
+        });
+    }
+    while (ready.load() < ncpus) {
+        std::this_thread::yield();
+    }
+    go.store(true, std::memory_order_release);
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    // Every partition has run at least once since x was filled, so y is the
+    // complete product; check it against a serial CSR pass over the source
+    std::vector<double> result(rows), expected(rows), xs(rows);
+    for (size_t r = 0; r < rows; ++r) xs[r] = x_value(r);
+    csr_rows(m.ptr.data(), m.col.data(), m.val.data(), xs.data(), expected.data(), 0, rows);
+    f->gather(y, result.data());
+    for (size_t r = 0; r < rows; ++r) {
+        double err = fabs(result[r] - expected[r]) / std::max(fabs(expected[r]), 1e-300);
+        out->max_rel_error = std::max(out->max_rel_error, err);
+    }
+
+    // Threads run their partitions independently: count each completed
+    // partition as its share of one full product
+    double products_total = 0.0;
+    for (int id = 0; id < ncpus; ++id) products_total += products[id] * f->shares[id];
+    double wall = *std::max_element(elapsed.begin(), elapsed.end()) / 1e9;
+    out->nnz = nnz;
+    out->max_row_nnz = max_row;
+    out->fill = (double)f->stored() / nnz;
+    out->seconds = wall;
+    out->gflops = products_total * 2.0 * nnz / wall / 1e9;
+    out->gb_s = products_total * f->bytes() / wall / 1e9;
+    delete f;
+    free(x);
+    free(y);
+    return 0;
+}
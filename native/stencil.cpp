@@ -0,0 +1,317 @@
+/**
+ * Jacobi stencil sweeps: the host generalization of pipeline_kernel's 1D
+ * 3-point average to a 2D 5-point and 3D 7- and 27-point stencils on double
+ * grids, with optional spatial tiling, temporal blocking (a wavefront of
+ * time levels along the outermost dimension) and SIMD
+ */
+
+#include "common.h"
+
+#include <errno.h>
+#include <math.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <thread>
+
+enum StencilKind {
+    STENCIL_2D5 = 0,
+    STENCIL_3D7 = 1,
+    STENCIL_3D27 = 2,
+};
+
+struct stencil_result {
+    double gcells_s;       // cell updates per second, billions
+    double gflops;
+    double gb_s;           // effective: one read and one write of each cell per update
+    double max_abs_error;  // against naive sweeps of a small grid with the same options
+    uint64_t steps;
+    double seconds;
+};
+
+namespace {
+
+const double FLOPS_PER_CELL[] = {6, 8, 30};
+const size_t VALIDATE_EDGE_2D = 96;
+const size_t VALIDATE_EDGE_3D = 24;
+
+/**
+ * Grid view shared by all stencils: `outer` slices (z in 3D, y in 2D) of
+ * `rows` rows (y in 3D, 1 in 2D) of nx cells; the outermost layer of cells
+ * is a fixed boundary
+ */
+struct Grid {
+    int kind;
+    size_t nx, rows, outer;
+    size_t plane() const { return rows * nx; }
+    size_t cells() const { return outer * plane(); }
+    size_t interior() const { return (outer - 2) * (rows == 1 ? 1 : rows - 2) * (nx - 2); }
+};
+
+#define HS_INLINE inline __attribute__((always_inline))
+
+template <int K>
+HS_INLINE void row_update(const double* __restrict s, double* __restrict d, size_t n, ptrdiff_t ps, ptrdiff_t rs) {
+    for (size_t i = 0; i < n; ++i) {
+        const double* c = s + i;
+        if (K == STENCIL_2D5) {
+            d[i] = 0.5 * c[0] + 0.125 * (c[-1] + c[1] + c[-ps] + c[ps]);
+        } else if (K == STENCIL_3D7) {
+            d[i] = 0.4 * c[0] + 0.1 * (c[-1] + c[1] + c[-rs] + c[rs] + c[-ps] + c[ps]);
+        } else {
+            double faces = c[-1] + c[1] + c[-rs] + c[rs] + c[-ps] + c[ps];
+            double edges = c[-rs - 1] + c[-rs + 1] + c[rs - 1] + c[rs + 1] +
+                           c[-ps - 1] + c[-ps + 1] + c[ps - 1] + c[ps + 1] +
+                           c[-ps - rs] + c[-ps + rs] + c[ps - rs] + c[ps + rs];
+            double corners = c[-ps - rs - 1] + c[-ps - rs + 1] + c[-ps + rs - 1] + c[-ps + rs + 1] +
+                             c[ps - rs - 1] + c[ps - rs + 1] + c[ps + rs - 1] + c[ps + rs + 1];
+            d[i] = 0.25 * c[0] + 0.05 * faces + 0.025 * edges + 0.01875 * corners;
+        }
+    }
+}
+
+HS_INLINE void row_dispatch(int kind, const double* s, double* d, size_t n, ptrdiff_t ps, ptrdiff_t rs) {
+    switch (kind) {
+        case STENCIL_2D5: row_update<STENCIL_2D5>(s, d, n, ps, rs); break;
+        case STENCIL_3D7: row_update<STENCIL_3D7>(s, d, n, ps, rs); break;
+        case STENCIL_3D27: row_update<STENCIL_3D27>(s, d, n, ps, rs); break;
+    }
+}
+
+#if defined(__x86_64__)
+#define HS_MULTIVERSION __attribute__((target_clones("arch=x86-64-v4", "arch=x86-64-v3", "default")))
+#else
+#define HS_MULTIVERSION
+#endif
+
+HS_MULTIVERSION
+void row_simd(int kind, const double* s, double* d, size_t n, ptrdiff_t ps, ptrdiff_t rs) {
+    row_dispatch(kind, s, d, n, ps, rs);
+}
+
+__attribute__((optimize("no-tree-vectorize")))
+void row_scalar(int kind, const double* s, double* d, size_t n, ptrdiff_t ps, ptrdiff_t rs) {
+    row_dispatch(kind, s, d, n, ps, rs);
+}
+
+typedef void (*RowFn)(int, const double*, double*, size_t, ptrdiff_t, ptrdiff_t);
+
+/**
+ * Cells of one thread: rows [j0, j1) and columns [x0, x1) of every slice
+ */
+struct Part {
+    size_t j0, j1, x0, x1;
+};
+
+/**
+ * Split the interior across threads: by rows in 3D, by columns (in multiples
+ * of 8 cells) in 2D, where a slice is a single row
+ */
+std::vector<Part> partition(const Grid& g, int nthreads) {
+    std::vector<Part> parts;
+    if (g.rows > 1) {
+        size_t n = g.rows - 2;
+        for (int t = 0; t < nthreads; ++t) {
+            parts.push_back({1 + n * t / nthreads, 1 + n * (t + 1) / nthreads, 1, g.nx - 1});
+        }
+    } else {
+        size_t blocks = (g.nx - 2 + 7) / 8;
+        for (int t = 0; t < nthreads; ++t) {
+            size_t x0 = 1 + blocks * t / nthreads * 8, x1 = 1 + blocks * (t + 1) / nthreads * 8;
+            parts.push_back({0, 1, std::min(x0, g.nx - 1), std::min(x1, g.nx - 1)});
+        }
+    }
+    return parts;
+}
+
+/**
+ * Update slice o of part p from src into dst, one row at a time
+ */
+void update_slice(const Grid& g, RowFn row, const double* src, double* dst, size_t o, const Part& p) {
+    ptrdiff_t ps = g.plane(), rs = g.nx;
+    for (size_t j = p.j0; j < p.j1; ++j) {
+        size_t at = o * g.plane() + j * g.nx + p.x0;
+        row(g.kind, src + at, dst + at, p.x1 - p.x0, ps, rs);
+    }
+}
+
+/**
+ * One thread's share of `steps` time steps starting at buffer `cur`
+ * time_block == 1: plain sweeps, tiled; otherwise blocks of time_block steps
+ * advance as a wavefront over slices, level s one slice behind level s - 1,
+ * so only about time_block + 2 slices of the part are live in cache
+ * A slice of level s overwrites level s - 2, which by then no lower level
+ * still reads; the barrier after every level keeps neighbouring parts in step
+ */
+void sweep(const Grid& g, RowFn row, double* const* buf, int cur, const Part& part, size_t tile, int time_block,
+           int steps, hs::Barrier* barrier) {
+    size_t last = g.outer - 1;  // slices 1 .. last - 1 are interior
+    for (int done = 0; done < steps;) {
+        int levels = std::min(time_block, steps - done);
+        if (levels == 1) {
+            const double* src = buf[(cur + done) & 1];
+            double* dst = buf[(cur + done + 1) & 1];
+            bool by_rows = g.rows > 1;
+            size_t lo = by_rows ? part.j0 : part.x0, hi = by_rows ? part.j1 : part.x1;
+            size_t step = tile ? tile : std::max<size_t>(hi - lo, 1);
+            for (size_t t0 = lo; t0 < hi; t0 += step) {
+                Part p = part;
+                (by_rows ? p.j0 : p.x0) = t0;
+                (by_rows ? p.j1 : p.x1) = std::min(hi, t0 + step);
+                for (size_t o = 1; o < last; ++o) update_slice(g, row, src, dst, o, p);
+            }
+            barrier->wait();
+        } else {
+            for (size_t k = 1; k < last + levels - 1; ++k) {
+                for (int s = 1; s <= levels; ++s) {
+                    if (k >= (size_t)s && k - (s - 1) < last) {
+                        size_t o = k - (s - 1);
+                        update_slice(g, row, buf[(cur + done + s - 1) & 1], buf[(cur + done + s) & 1], o, part);
+                    }
+                    barrier->wait();
+                }
+            }
+        }
+        done += levels;
+    }
+}
+
+double initial_value(size_t i) {
+    return (double)((i * 2654435761u) % 1000) / 1000.0;
+}
+
+double* alloc_grid(const Grid& g) {
+    double* p = static_cast<double*>(aligned_alloc(64, (g.cells() * sizeof(double) + 63) / 64 * 64));
+    if (p) {
+        for (size_t i = 0; i < g.cells(); ++i) p[i] = initial_value(i);
+    }
+    return p;
+}
+
+/**
+ * Largest difference between the configured sweep and untiled, unblocked
+ * single-thread sweeps with the same row code on a small grid; every cell is
+ * computed the same way, so a correct schedule matches exactly
+ */
+double validate(const Grid& full, RowFn row, size_t tile, int time_block, int nthreads) {
+    size_t edge = full.rows == 1 ? VALIDATE_EDGE_2D : VALIDATE_EDGE_3D;
+    Grid g = {full.kind, edge, full.rows == 1 ? 1 : edge, edge};
+    int steps = 2 * time_block + 1;
+    double* a[2] = {alloc_grid(g), alloc_grid(g)};
+    double* b[2] = {alloc_grid(g), alloc_grid(g)};
+    double err = INFINITY;
+    if (a[0] && a[1] && b[0] && b[1]) {
+        hs::Barrier one(1);
+        Part whole = partition(g, 1)[0];
+        sweep(g, row, b, 0, whole, 0, 1, steps, &one);
+
+        hs::Barrier barrier(nthreads);
+        std::vector<Part> parts = partition(g, nthreads);
+        std::vector<std::thread> threads;
+        for (int id = 0; id < nthreads; ++id) {
+            threads.emplace_back([&, id] { sweep(g, row, a, 0, parts[id], tile, time_block, steps, &barrier); });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        err = 0.0;
+        for (size_t i = 0; i < g.cells(); ++i) err = std::max(err, fabs(a[steps & 1][i] - b[steps & 1][i]));
+    }
+    for (double* p : {a[0], a[1], b[0], b[1]}) free(p);
+    return err;
+}
+
+}  // namespace
+
+/**
+ * Run `kind` on an nx x ny (2D) or nx x ny x nz (3D) grid for about `seconds`
+ * on nthreads pinned threads, in rounds of `time_block` steps
+ * tile: rows (3D) or columns (2D) per spatial tile in plain sweeps, 0 = none
+ * time_block: time steps per wavefront block, 1 = no temporal blocking
+ * simd: 0 forces scalar code, otherwise the widest ISA the CPU supports
+ */
+HS_EXPORT int stencil_run(int kind, uint64_t nx, uint64_t ny, uint64_t nz, int tile, int time_block, int simd,
+                          int nthreads, double seconds, stencil_result* out) {
+    if (!out || kind < STENCIL_2D5 || kind > STENCIL_3D27 || nthreads <= 0 || seconds <= 0 || tile < 0 ||
+        time_block <= 0 || nx < 3 || ny < 3 || (kind != STENCIL_2D5 && nz < 3)) {
+        return -EINVAL;
+    }
+    memset(out, 0, sizeof(*out));
+    Grid g = kind == STENCIL_2D5 ? Grid{kind, nx, 1, ny} : Grid{kind, nx, ny, nz};
+    RowFn row = simd ? row_simd : row_scalar;
+    out->max_abs_error = validate(g, row, tile, time_block, nthreads);
+
+    double* buf[2] = {static_cast<double*>(aligned_alloc(64, (g.cells() * sizeof(double) + 63) / 64 * 64)),
+                      static_cast<double*>(aligned_alloc(64, (g.cells() * sizeof(double) + 63) / 64 * 64))};
+    if (!buf[0] || !buf[1]) {
+        free(buf[0]);
+        free(buf[1]);
+        return -ENOMEM;
+    }
+    std::vector<Part> parts = partition(g, nthreads);
+    cpu_set_t allowed;
+    sched_getaffinity(0, sizeof(allowed), &allowed);
+    std::vector<int> cpus;
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &allowed)) cpus.push_back(cpu);
+    }
+
+    hs::Barrier barrier(nthreads);
+    std::atomic<int> ready{0};
+    std::atomic<bool> go{false}, stop{false};
+    std::vector<std::thread> threads;
+    uint64_t budget_ns = (uint64_t)(seconds * 1e9);
+    uint64_t start = 0, end = 0;
+    int steps = 0;
+    for (int id = 0; id < nthreads; ++id) {
+        threads.emplace_back([&, id] {
+            hs::pin_to_cpu(cpus.empty() ? -1 : cpus[id % cpus.size()]);
+            // First touch: each thread initializes the slices' cells it updates
+            const Part& p = parts[id];
+            for (size_t o = 0; o < g.outer; ++o) {
+                size_t j0 = p.j0 == 1 ? 0 : p.j0, j1 = p.j1 == g.rows - 1 ? g.rows : p.j1;
+                size_t x0 = p.x0 == 1 ? 0 : p.x0, x1 = p.x1 == g.nx - 1 ? g.nx : p.x1;
+                for (size_t j = j0; j < j1; ++j) {
+                    for (size_t x = x0; x < x1; ++x) {
+                        size_t i = o * g.plane() + j * g.nx + x;
+                        buf[0][i] = buf[1][i] = initial_value(i);
+                    }
+                }
+            }
+            ready.fetch_add(1);
+            while (!go.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            int done = 0;
+            while (!stop.load(std::memory_order_acquire)) {
+                sweep(g, row, buf, done & 1, p, tile, time_block, time_block, &barrier);
+                done += time_block;
+                if (id == 0) {
+                    end = hs::now_ns();
+                    if (end - start >= budget_ns) stop.store(true, std::memory_order_release);
+                    steps = done;
+                }
+                barrier.wait();
+            }
+        });
+    }
+    while (ready.load() < nthreads) {
+        std::this_thread::yield();
+    }
+    start = hs::now_ns();
+    go.store(true, std::memory_order_release);
+    for (auto& t : threads) {
+        t.join();
+    }
+    free(buf[0]);
+    free(buf[1]);
+
+    double updates = (double)g.interior() * steps;
+    out->steps = steps;
+    out->seconds = (end - start) / 1e9;
+    out->gcells_s = updates / out->seconds / 1e9;
+    out->gflops = out->gcells_s * FLOPS_PER_CELL[kind];
+    out->gb_s = out->gcells_s * 2 * sizeof(double);
+    return 0;
+}
@@ -0,0 +1,257 @@
+/**
+ * Lock contention stress: std::mutex, spinlock, reader-writer lock,
+ * raw futex mutex and condition-variable hand-off
+ * Reports acquisitions/sec, per-thread fairness and hand-off latency
+ */
+
+#include "timing.h"
+
+#include <errno.h>
+#include <string.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+
+enum SyncLock {
+    SYNC_MUTEX = 0,
+    SYNC_SPINLOCK = 1,
+    SYNC_RWLOCK = 2,
+    SYNC_FUTEX = 3,
+    SYNC_CONDVAR = 4,
+};
+
+struct sync_result {
+    uint64_t total_acquisitions;
+    double acquisitions_per_sec;
+    double fairness_jain;   // 1.0 = perfectly even share across threads
+    double min_share;
+    double max_share;
+    uint64_t handoffs;      // exclusive acquisitions that followed a different owner
+    double handoff_avg_ns;
+    double handoff_p50_ns;
+    double handoff_p99_ns;
+};
+
+namespace {
+
+const size_t MAX_HANDOFF_SAMPLES = 1 << 18;
+
+/**
+ * Test-and-test-and-set spinlock
+ */
+class SpinLock {
+public:
+    void lock() {
+        for (;;) {
+            if (!locked_.exchange(true, std::memory_order_acquire)) return;
+            while (locked_.load(std::memory_order_relaxed)) hs::cpu_relax();
+        }
+    }
+    void unlock() { locked_.store(false, std::memory_order_release); }
+
+private:
+    std::atomic<bool> locked_{false};
+};
+
+/**
+ * Three-state futex mutex (0 free, 1 locked, 2 locked with waiters),
+ * after Drepper's "Futexes Are Tricky"
+ */
+class FutexMutex {
+public:
+    void lock() {
+        uint32_t c = 0;
+        if (state_.compare_exchange_strong(c, 1, std::memory_order_acquire)) return;
+        if (c != 2) c = state_.exchange(2, std::memory_order_acquire);
+        while (c != 0) {
+            hs::futex_wait(&state_, 2);
+            c = state_.exchange(2, std::memory_order_acquire);
+        }
+    }
+    void unlock() {
+        if (state_.fetch_sub(1, std::memory_order_release) != 1) {
+            state_.store(0, std::memory_order_release);
+            hs::futex_wake(&state_, 1);
+        }
+    }
+
+private:
+    std::atomic<uint32_t> state_{0};
+};
+
+/**
+ * State shared by all contending threads; owner fields are only touched
+ * while holding the lock exclusively
+ */
+struct Shared {
+    std::atomic<bool> stop{false};
+    alignas(64) int last_owner = -1;
+    uint64_t last_release_ticks = 0;
+    uint64_t protected_counter = 0;
+    alignas(64) std::mutex mutex;
+    SpinLock spin;
+    std::shared_mutex rw;
+    FutexMutex futex;
+    std::condition_variable cv;
+    int turn = 0;
+};
+
+struct ThreadStats {
+    uint64_t acquisitions = 0;
+    uint64_t handoff_total = 0;  // ticks
+    uint64_t handoffs = 0;
+    std::vector<uint64_t> handoff_samples;  // ticks
+};
+
+/**
+ * Called right after an exclusive acquisition: time the hand-off if the
+ * lock came from another thread, then run the critical section
+ */
+inline void exclusive_section(Shared& s, int id, uint64_t cs_ns, ThreadStats& st) {
+    uint64_t now = hs::ticks();
+    if (s.last_owner >= 0 && s.last_owner != id) {
+        uint64_t handoff = now - s.last_release_ticks;
+        st.handoff_total += handoff;
+        st.handoffs++;
+        if (st.handoff_samples.size() < MAX_HANDOFF_SAMPLES) st.handoff_samples.push_back(handoff);
+    }
+    s.protected_counter++;
+    hs::spin_for_ns(cs_ns);
+    s.last_owner = id;
+    s.last_release_ticks = hs::ticks();
+}
+
+template <typename Lock>
+void contend(Lock& lock, Shared& s, int id, uint64_t cs_ns, uint64_t think_ns, ThreadStats& st) {
+    while (!s.stop.load(std::memory_order_relaxed)) {
+        lock.lock();
+        exclusive_section(s, id, cs_ns, st);
+        lock.unlock();
+        st.acquisitions++;
+        hs::spin_for_ns(think_ns);
+    }
+}
+
+void contend_rw(Shared& s, int id, uint64_t cs_ns, uint64_t think_ns, int read_percent,
+                ThreadStats& st) {
+    uint64_t rng = 0x9e3779b97f4a7c15ull * (id + 1);
+    while (!s.stop.load(std::memory_order_relaxed)) {
+        rng ^= rng << 13;
+        rng ^= rng >> 7;
+        rng ^= rng << 17;
+        if ((int)(rng % 100) < read_percent) {
+            std::shared_lock<std::shared_mutex> guard(s.rw);
+            hs::spin_for_ns(cs_ns);
+        } else {
+            std::unique_lock<std::shared_mutex> guard(s.rw);
+            exclusive_section(s, id, cs_ns, st);
+        }
+        st.acquisitions++;
+        hs::spin_for_ns(think_ns);
+    }
+}
+
+/**
+ * Token ring: each thread waits on the condition variable for its turn,
+ * so every acquisition is a hand-off through a wakeup
+ */
+void contend_condvar(Shared& s, int id, int nthreads, uint64_t cs_ns, uint64_t think_ns,
+                     ThreadStats& st) {
+    for (;;) {
+        std::unique_lock<std::mutex> guard(s.mutex);
+        s.cv.wait(guard, [&] { return s.turn == id || s.stop.load(); });
+        if (s.stop.load()) return;
+        exclusive_section(s, id, cs_ns, st);
+        s.turn = (id + 1) % nthreads;
+        guard.unlock();
+        s.cv.notify_all();
+        st.acquisitions++;
+        hs::spin_for_ns(think_ns);
+    }
+}
+
+}  // namespace
+
+/**
+ * Run nthreads contending on one lock for the given time
+ * per_thread receives each thread's acquisition count (nthreads entries)
+ * Returns 0 on success or a negative errno
+ */
+HS_EXPORT int sync_contention_run(int lock_type, int nthreads, uint64_t cs_ns, uint64_t think_ns,
+                                  int read_percent, double seconds, uint64_t* per_thread,
+                                  sync_result* out) {
+    if (nthreads <= 0 || lock_type < SYNC_MUTEX || lock_type > SYNC_CONDVAR ||
+        read_percent < 0 || read_percent > 100 || !per_thread || !out) {
+        return -EINVAL;
+    }
+    memset(out, 0, sizeof(*out));
+    Shared shared;
+    std::vector<ThreadStats> stats(nthreads);
+    std::vector<std::thread> threads;
+
+    uint64_t start = hs::now_ns();
+    for (int id = 0; id < nthreads; ++id) {
+        threads.emplace_back([&, id] {
+            ThreadStats& st = stats[id];
+            switch (lock_type) {
+                case SYNC_MUTEX:
+                    contend(shared.mutex, shared, id, cs_ns, think_ns, st);
+                    break;
+                case SYNC_SPINLOCK:
+                    contend(shared.spin, shared, id, cs_ns, think_ns, st);
+                    break;
+                case SYNC_RWLOCK:
+                    contend_rw(shared, id, cs_ns, think_ns, read_percent, st);
+                    break;
+                case SYNC_FUTEX:
+                    contend(shared.futex, shared, id, cs_ns, think_ns, st);
+                    break;
+                case SYNC_CONDVAR:
+                    contend_condvar(shared, id, nthreads, cs_ns, think_ns, st);
+                    break;
+            }
+        });
+    }
+    struct timespec ts;
+    ts.tv_sec = (time_t)seconds;
+    ts.tv_nsec = (long)((seconds - ts.tv_sec) * 1e9);
+    nanosleep(&ts, nullptr);
+    {
+        std::lock_guard<std::mutex> guard(shared.mutex);
+        shared.stop = true;
+    }
+    shared.cv.notify_all();
+    for (auto& t : threads) {
+        t.join();
+    }
+    double elapsed = (hs::now_ns() - start) / 1e9;
+
+    std::vector<uint64_t> samples;
+    uint64_t handoff_total = 0;
+    double sum = 0.0, sum_sq = 0.0;
+    for (int id = 0; id < nthreads; ++id) {
+        const ThreadStats& st = stats[id];
+        per_thread[id] = st.acquisitions;
+        out->total_acquisitions += st.acquisitions;
+        out->handoffs += st.handoffs;
+        handoff_total += st.handoff_total;
+        samples.insert(samples.end(), st.handoff_samples.begin(), st.handoff_samples.end());
+        sum += st.acquisitions;
+        sum_sq += (double)st.acquisitions * st.acquisitions;
+    }
+    out->acquisitions_per_sec = out->total_acquisitions / elapsed;
+    if (out->total_acquisitions) {
+        out->fairness_jain = sum * sum / (nthreads * sum_sq);
+        auto minmax = std::minmax_element(per_thread, per_thread + nthreads);
+        out->min_share = (double)*minmax.first / out->total_acquisitions;
+        out->max_share = (double)*minmax.second / out->total_acquisitions;
+    }
+    if (out->handoffs) {
+        out->handoff_avg_ns = hs::ticks_to_ns((double)handoff_total / out->handoffs);
+        out->handoff_p50_ns = hs::ticks_to_ns(hs::percentile(samples, 0.50));
+        out->handoff_p99_ns = hs::ticks_to_ns(hs::percentile(samples, 0.99));
+    }
+    return 0;
+}
@@ -0,0 +1,126 @@
+/**
+ * Syscall-overhead microbenchmarks: getpid, vDSO clock_gettime, pipe
+ * read/write, mmap/munmap and page faults, timed with the calibrated TSC
+ */
+
+#include "timing.h"
+
+#include <errno.h>
+#include <string.h>
+#include <sys/mman.h>
+
+enum SyscallBench {
+    SYSCALL_GETPID = 0,
+    SYSCALL_CLOCK_GETTIME = 1,
+    SYSCALL_PIPE_RW = 2,
+    SYSCALL_MMAP_MUNMAP = 3,
+    SYSCALL_PAGE_FAULT = 4,
+};
+
+struct syscall_bench_result {
+    double ns_per_call_min;     // best batch
+    double ns_per_call_median;  // median batch
+    double tsc_ghz;             // 0 when timed with clock_gettime
+    uint64_t calls;
+};
+
+namespace {
+
+const int BATCHES = 15;
+const size_t PAGE = sysconf(_SC_PAGESIZE);  // 16/64 KB on some arm64 and ppc64 kernels
+
+/**
+ * Time one batch of `calls` operations; returns ticks, or 0 on failure
+ */
+uint64_t run_batch(int which, uint64_t calls, int* pipe_fds) {
+    char byte = 0;
+    switch (which) {
+        case SYSCALL_GETPID: {
+            uint64_t start = hs::ticks_begin();
+            for (uint64_t i = 0; i < calls; ++i) {
+                syscall(SYS_getpid);
+            }
+            return hs::ticks_end() - start;
+        }
+        case SYSCALL_CLOCK_GETTIME: {
+            struct timespec ts;
+            uint64_t start = hs::ticks_begin();
+            for (uint64_t i = 0; i < calls; ++i) {
+                clock_gettime(CLOCK_MONOTONIC, &ts);
+            }
+            return hs::ticks_end() - start;
+        }
+        case SYSCALL_PIPE_RW: {
+            uint64_t start = hs::ticks_begin();
+            for (uint64_t i = 0; i < calls; ++i) {
+                if (write(pipe_fds[1], &byte, 1) != 1 || read(pipe_fds[0], &byte, 1) != 1) return 0;
+            }
+            return hs::ticks_end() - start;
+        }
+        case SYSCALL_MMAP_MUNMAP: {
+            uint64_t start = hs::ticks_begin();
+            for (uint64_t i = 0; i < calls; ++i) {
+                void* p = mmap(nullptr, PAGE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                if (p == MAP_FAILED) return 0;
+                munmap(p, PAGE);
+            }
+            return hs::ticks_end() - start;
+        }
+        case SYSCALL_PAGE_FAULT: {
+            // One first-touch write fault per page; the mapping cost is excluded
+            size_t len = calls * PAGE;
+            char* p = static_cast<char*>(mmap(nullptr, len, PROT_READ | PROT_WRITE,
+                                              MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+            if (p == MAP_FAILED) return 0;
+            madvise(p, len, MADV_NOHUGEPAGE);
+            uint64_t start = hs::ticks_begin();
+            for (uint64_t i = 0; i < calls; ++i) {
+                *(volatile char*)(p + i * PAGE) = 1;
+            }
+            uint64_t ticks = hs::ticks_end() - start;
+            munmap(p, len);
+            return ticks;
+        }
+    }
+    return 0;
+}
+
+}  // namespace
+
+/**
+ * Run BATCHES batches of `calls` operations of one kind
+ * Returns 0 on success or a negative errno
+ */
+HS_EXPORT int syscall_bench_run(int which, uint64_t calls, syscall_bench_result* out) {
+    if (which < SYSCALL_GETPID || which > SYSCALL_PAGE_FAULT || calls == 0 || !out) {
+        return -EINVAL;
+    }
+    memset(out, 0, sizeof(*out));
+    int pipe_fds[2] = {-1, -1};
+    if (which == SYSCALL_PIPE_RW && pipe(pipe_fds) < 0) {
+        return -errno;
+    }
+    std::vector<uint64_t> batches;
+    run_batch(which, calls / 10 + 1, pipe_fds);  // warm up caches and the vDSO page
+    for (int b = 0; b < BATCHES; ++b) {
+        uint64_t ticks = run_batch(which, calls, pipe_fds);
+        if (ticks == 0) {
+            int err = errno ? errno : EIO;
+            if (pipe_fds[0] >= 0) {
+                close(pipe_fds[0]);
+                close(pipe_fds[1]);
+            }
+            return -err;
+        }
+        batches.push_back(ticks);
+    }
+    if (pipe_fds[0] >= 0) {
+        close(pipe_fds[0]);
+        close(pipe_fds[1]);
+    }
+    out->ns_per_call_median = hs::ticks_to_ns(hs::percentile(batches, 0.5)) / calls;
+    out->ns_per_call_min = hs::ticks_to_ns(*std::min_element(batches.begin(), batches.end())) / calls;
+    out->tsc_ghz = hs::g_tsc.use_tsc ? hs::g_tsc.ticks_per_ns : 0.0;
+    out->calls = calls * BATCHES;
+    return 0;
+}
@@ -0,0 +1,122 @@
+/**
+ * TSC detection and calibration for timing.h
+ */
+
+#include "timing.h"
+
+#if HS_HAVE_TSC
+#include <cpuid.h>
+#endif
+#include <stdlib.h>
+#include <string.h>
+
+struct timing_info {
+    int invariant_tsc;
+    int rdtscp;
+    int using_tsc;
+    double tsc_ghz;
+    double ticks_overhead_ns;  // cost of one ticks() call
+};
+
+namespace hs {
+
+namespace {
+
+const int CALIBRATION_ROUNDS = 5;
+const uint64_t CALIBRATION_WINDOW_NS = 2000000;
+
+#if HS_HAVE_TSC
+/**
+ * Read CLOCK_MONOTONIC and the TSC as close together as possible
+ */
+void paired_sample(uint64_t& ns, uint64_t& tsc) {
+    uint64_t best = UINT64_MAX;
+    for (int i = 0; i < 8; ++i) {
+        uint64_t before = now_ns();
+        uint64_t t = __rdtsc();
+        uint64_t after = now_ns();
+        if (after - before < best) {
+            best = after - before;
+            ns = before + (after - before) / 2;
+            tsc = t;
+        }
+    }
+}
+
+#endif
+
+TscCalibration calibrate() {
+    TscCalibration cal;
+    memset(&cal, 0, sizeof(cal));
+    cal.ticks_per_ns = 1.0;
+#if HS_HAVE_TSC
+    unsigned a, b, c, d;
+    if (__get_cpuid(0x80000001, &a, &b, &c, &d)) {
+        cal.rdtscp = (d >> 27) & 1;
+    }
+    if (__get_cpuid(0x80000007, &a, &b, &c, &d)) {
+        cal.invariant = (d >> 8) & 1;
+    }
+    const char* disable = getenv("HOSTSTRESS_NO_TSC");
+    cal.use_tsc = cal.invariant && !(disable && *disable && strcmp(disable, "0") != 0);
+    if (!cal.use_tsc) {
+        return cal;
+    }
+
+    // Median of several short windows rejects a window disturbed by preemption
+    std::vector<double> rates;
+    for (int r = 0; r < CALIBRATION_ROUNDS; ++r) {
+        uint64_t ns0 = 0, tsc0 = 0, ns1 = 0, tsc1 = 0;
+        paired_sample(ns0, tsc0);
+        while (now_ns() - ns0 < CALIBRATION_WINDOW_NS) {
+        }
+        paired_sample(ns1, tsc1);
+        rates.push_back((double)(tsc1 - tsc0) / (double)(ns1 - ns0));
+    }
+    std::sort(rates.begin(), rates.end());
+    cal.ticks_per_ns = rates[CALIBRATION_ROUNDS / 2];
+    if (!(cal.ticks_per_ns > 0.01)) {
+        // Nonsensical rate (broken virtualized TSC): fall back to the clock
+        cal.use_tsc = false;
+        cal.ticks_per_ns = 1.0;
+    }
+#endif
+    return cal;
+}
+
+}  // namespace
+
+// Constant-initialized to the clock fallback, then calibrated by a constructor:
+// engines calling in from other static initializers never see a zero rate
+TscCalibration g_tsc = {false, false, false, 1.0};
+
+namespace {
+
+__attribute__((constructor)) void calibrate_on_load() {
+    g_tsc = calibrate();
+}
+
+}  // namespace
+
+}  // namespace hs
+
+/**
+ * Report the timing source chosen at load time
+ */
+HS_EXPORT int timing_get_info(timing_info* out) {
+    if (!out) return -1;
+    out->invariant_tsc = hs::g_tsc.invariant;
+    out->rdtscp = hs::g_tsc.rdtscp;
+    out->using_tsc = hs::g_tsc.use_tsc;
+    out->tsc_ghz = hs::g_tsc.use_tsc ? hs::g_tsc.ticks_per_ns : 0.0;
+
+    const int calls = 100000;
+    uint64_t sink = 0;
+    uint64_t start = hs::now_ns();
+    for (int i = 0; i < calls; ++i) {
+        sink += hs::ticks();
+    }
+    out->ticks_overhead_ns = (double)(hs::now_ns() - start) / calls;
+    asm volatile("" : : "r"(sink));
+    return 0;
+}
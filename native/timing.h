@@ -0,0 +1,112 @@
+/**
+ * Low-overhead timing shared by the native engines
+ * Uses the invariant TSC (rdtsc/rdtscp) calibrated against CLOCK_MONOTONIC
+ * when CPUID reports it, and falls back to clock_gettime otherwise (always
+ * on non-x86 hosts)
+ */
+
+#pragma once
+
+#include "common.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define HS_HAVE_TSC 1
+#include <x86intrin.h>
+#else
+#define HS_HAVE_TSC 0
+#endif
+
+namespace hs {
+
+struct TscCalibration {
+    bool invariant;        // CPUID.80000007H:EDX[8]
+    bool rdtscp;           // CPUID.80000001H:EDX[27]
+    bool use_tsc;          // invariant TSC present and not disabled by HOSTSTRESS_NO_TSC
+    double ticks_per_ns;   // 1.0 when falling back to clock_gettime
+};
+
+/**
+ * Calibrated once when the library is loaded (see timing.cpp); until then it
+ * reads as the clock_gettime fallback, so early callers still get nanoseconds
+ */
+extern TscCalibration g_tsc;
+
+/**
+ * Raw timestamp in ticks: cheapest, may be reordered around nearby code
+ */
+inline uint64_t ticks() {
+#if HS_HAVE_TSC
+    return g_tsc.use_tsc ? __rdtsc() : now_ns();
+#else
+    return now_ns();
+#endif
+}
+
+/**
+ * Timestamp that waits for earlier instructions, for the start of a timed region
+ */
+inline uint64_t ticks_begin() {
+#if HS_HAVE_TSC
+    if (!g_tsc.use_tsc) return now_ns();
+    _mm_lfence();
+    uint64_t t = __rdtsc();
+    _mm_lfence();
+    return t;
+#else
+    return now_ns();
+#endif
+}
+
+/**
+ * Timestamp taken after the timed region has completed
+ */
+inline uint64_t ticks_end() {
+#if HS_HAVE_TSC
+    if (!g_tsc.use_tsc) return now_ns();
+    uint64_t t;
+    if (g_tsc.rdtscp) {
+        unsigned aux;
+        t = __rdtscp(&aux);
+    } else {
+        _mm_lfence();
+        t = __rdtsc();
+    }
+    _mm_lfence();
+    return t;
+#else
+    return now_ns();
+#endif
+}
+
+inline double ticks_to_ns(double t) {
+    return g_tsc.use_tsc ? t / g_tsc.ticks_per_ns : t;
+}
+
+inline uint64_t ns_to_ticks(uint64_t ns) {
+    return g_tsc.use_tsc ? (uint64_t)(ns * g_tsc.ticks_per_ns) : ns;
+}
+
+/**
+ * Spin-wait hint for busy loops
+ */
+inline void cpu_relax() {
+#if HS_HAVE_TSC
+    _mm_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+/**
+ * Busy-wait for ns nanoseconds (models a critical section or think time)
+ */
+inline void spin_for_ns(uint64_t ns) {
+    if (ns == 0) {
+        return;
+    }
+    uint64_t end = ticks() + ns_to_ticks(ns);
+    while (ticks() < end) {
+    }
+}
+
+}  // namespace hs
@@ -0,0 +1,305 @@
+/**
+ * Transcendental math throughput and accuracy: scalar libm (expf, logf,
+ * sinf, cosf, sqrtf) against branch-free polynomial versions (Cephes-style
+ * range reduction and minimax polynomials) vectorized by the compiler for
+ * the baseline SSE2, AVX2 and AVX-512 targets
+ * Accuracy is the max/mean ULP distance from a double-precision reference
+ */
+
+#include "timing.h"
+
+#include <errno.h>
+#include <math.h>
+#include <string.h>
+
+// Selects in the polynomial code compute both arms; GCC only if-converts (and
+// so vectorizes) them without AVX-512 masking when FP traps are not modeled.
+// Nothing here reads the FP exception flags, so results are unchanged
+#pragma GCC optimize("no-trapping-math")
+
+enum MathFunc {
+    MATH_EXP = 0,
+    MATH_LOG = 1,
+    MATH_SIN = 2,
+    MATH_COS = 3,
+    MATH_SQRT = 4,
+};
+
+enum MathImpl {
+    MATH_LIBM = 0,
+    MATH_POLY_SSE2 = 1,  // baseline x86-64 target
+    MATH_POLY_AVX2 = 2,
+    MATH_POLY_AVX512 = 3,
+};
+
+struct transcendental_result {
+    double gelem_s;    // results per second, billions
+    double ns_per_elem;
+    double max_ulp;
+    double mean_ulp;
+    uint64_t evaluations;
+};
+
+namespace {
+
+const size_t BATCH = 4096;          // L1-resident inputs per timed pass
+const size_t ACCURACY_POINTS = 1 << 20;
+const int BATCHES = 15;
+
+#define HS_INLINE inline __attribute__((always_inline))
+
+HS_INLINE uint32_t as_bits(float f) {
+    uint32_t u;
+    memcpy(&u, &f, sizeof(u));
+    return u;
+}
+
+HS_INLINE float as_float(uint32_t u) {
+    float f;
+    memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+// ---------------------------------------------------------------------------
+// Polynomial implementations: straight-line code (selects, no branches) so the
+// loops in map() vectorize for whichever target they are inlined into
+// ---------------------------------------------------------------------------
+
+HS_INLINE float exp_poly(float x) {
+    x = x < -87.3f ? -87.3f : x;
+    x = x > 88.7f ? 88.7f : x;
+    // n = round(x / ln 2) via the 1.5 * 2^23 rounding trick
+    float n = (x * 1.44269504088896341f + 12582912.0f) - 12582912.0f;
+    float r = x - n * 0.693359375f;
+    r = r - n * -2.12194440e-4f;
+    float z = r * r;
+    float p = 1.9875691500e-4f;
+    p = p * r + 1.3981999507e-3f;
+    p = p * r + 8.3334519073e-3f;
+    p = p * r + 4.1665795894e-2f;
+    p = p * r + 1.6666665459e-1f;
+    p = p * r + 5.0000001201e-1f;
+    p = p * z + r + 1.0f;
+    // Two half-steps of 2^n keep 2^n representable at both ends of the range
+    int32_t e = (int32_t)n;
+    int32_t e1 = e >> 1;
+    return p * as_float((uint32_t)(e1 + 127) << 23) * as_float((uint32_t)(e - e1 + 127) << 23);
+}
+
+HS_INLINE float log_poly(float x) {
+    uint32_t bits = as_bits(x);
+    float e = (float)((int32_t)(bits >> 23) - 126);
+    float m = as_float((bits & 0x007fffffu) | 0x3f000000u);  // mantissa in [0.5, 1)
+    bool small = m < 0.707106781186547524f;
+    e = small ? e - 1.0f : e;
+    m = small ? m + m - 1.0f : m - 1.0f;
+    float z = m * m;
+    float p = 7.0376836292e-2f;
+    p = p * m - 1.1514610310e-1f;
+    p = p * m + 1.1676998740e-1f;
+    p = p * m - 1.2420140846e-1f;
+    p = p * m + 1.4249322787e-1f;
+    p = p * m - 1.6668057665e-1f;
+    p = p * m + 2.0000714765e-1f;
+    p = p * m - 2.4999993993e-1f;
+    p = p * m + 3.3333331174e-1f;
+    float y = m * z * p;
+    y = y + e * -2.12194440e-4f;
+    y = y - 0.5f * z;
+    return m + y + e * 0.693359375f;
+}
+
+/**
+ * Shared sin/cos: reduce |x| by multiples of pi/4 (three-part Cody-Waite),
+ * then pick the sine or cosine polynomial and sign from the octant
+ */
+HS_INLINE float sincos_poly(float x, bool cosine) {
+    float ax = fabsf(x);
+    int32_t j = (int32_t)(ax * 1.27323954473516f);  // 4 / pi
+    j = (j + 1) & ~1;
+    float y = (float)j;
+    float r = ((ax - y * 0.78515625f) - y * 2.4187564849853515625e-4f) - y * 3.77489497744594108e-8f;
+    int32_t octant = cosine ? j + 2 : j;
+    bool negate = ((octant & 4) != 0) != (!cosine && x < 0.0f);
+    bool use_cos = (octant & 2) != 0;
+    float z = r * r;
+    float s = ((-1.9515295891e-4f * z + 8.3321608736e-3f) * z - 1.6666654611e-1f) * z * r + r;
+    float c = ((2.443315711809948e-5f * z - 1.388731625493765e-3f) * z + 4.166664568298827e-2f) * z * z -
+              0.5f * z + 1.0f;
+    float v = use_cos ? c : s;
+    return negate ? -v : v;
+}
+
+HS_INLINE float sin_poly(float x) {
+    return sincos_poly(x, false);
+}
+
+HS_INLINE float cos_poly(float x) {
+    return sincos_poly(x, true);
+}
+
+/**
+ * Reciprocal square root from the exponent bit trick, three Newton steps,
+ * then one correction of x * rsqrt(x)
+ */
+HS_INLINE float sqrt_poly(float x) {
+    float y = as_float(0x5f375a86u - (as_bits(x) >> 1));
+    float h = 0.5f * x;
+    y = y * (1.5f - h * y * y);
+    y = y * (1.5f - h * y * y);
+    y = y * (1.5f - h * y * y);
+    float s = x * y;
+    // s * (1 + (1 - s * y) / 2) rather than s + y * (x - s * s) / 2, whose
+    // residual goes subnormal for small x
+    return s + 0.5f * s * (1.0f - s * y);
+}
+
+template <float (*F)(float)>
+HS_INLINE void map(const float* in, float* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) out[i] = F(in[i]);
+}
+
+HS_INLINE void map_poly(int func, const float* in, float* out, size_t n) {
+    switch (func) {
+        case MATH_EXP: map<exp_poly>(in, out, n); break;
+        case MATH_LOG: map<log_poly>(in, out, n); break;
+        case MATH_SIN: map<sin_poly>(in, out, n); break;
+        case MATH_COS: map<cos_poly>(in, out, n); break;
+        case MATH_SQRT: map<sqrt_poly>(in, out, n); break;
+    }
+}
+
+void map_poly_sse2(int func, const float* in, float* out, size_t n) {
+    map_poly(func, in, out, n);
+}
+
+__attribute__((target("avx2,fma")))
+void map_poly_avx2(int func, const float* in, float* out, size_t n) {
+    map_poly(func, in, out, n);
+}
+
+__attribute__((target("avx512f")))
+void map_poly_avx512(int func, const float* in, float* out, size_t n) {
+    map_poly(func, in, out, n);
+}
+
+void map_libm(int func, const float* in, float* out, size_t n) {
+    switch (func) {
+        case MATH_EXP: for (size_t i = 0; i < n; ++i) out[i] = expf(in[i]); break;
+        case MATH_LOG: for (size_t i = 0; i < n; ++i) out[i] = logf(in[i]); break;
+        case MATH_SIN: for (size_t i = 0; i < n; ++i) out[i] = sinf(in[i]); break;
+        case MATH_COS: for (size_t i = 0; i < n; ++i) out[i] = cosf(in[i]); break;
+        case MATH_SQRT: for (size_t i = 0; i < n; ++i) out[i] = sqrtf(in[i]); break;
+    }
+}
+
+typedef void (*MapFn)(int, const float*, float*, size_t);
+
+MapFn select(int impl) {
+    __builtin_cpu_init();
+    switch (impl) {
+        case MATH_LIBM: return map_libm;
+        case MATH_POLY_SSE2: return map_poly_sse2;
+        case MATH_POLY_AVX2:
+            return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") ? map_poly_avx2 : nullptr;
+        case MATH_POLY_AVX512: return __builtin_cpu_supports("avx512f") ? map_poly_avx512 : nullptr;
+    }
+    return nullptr;
+}
+
+double reference(int func, double x) {
+    switch (func) {
+        case MATH_EXP: return exp(x);
+        case MATH_LOG: return log(x);
+        case MATH_SIN: return sin(x);
+        case MATH_COS: return cos(x);
+        case MATH_SQRT: return sqrt(x);
+    }
+    return 0.0;
+}
+
+/**
+ * Inputs spread over each function's tested domain: linear for exp and the
+ * trig functions, log-spaced over normal floats for log and sqrt
+ */
+void fill_inputs(int func, float* x, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        double t = (i + 0.5) / n;
+        switch (func) {
+            case MATH_EXP: x[i] = (float)(-87.0 + 175.0 * t); break;
+            case MATH_SIN:
+            case MATH_COS: x[i] = (float)(-1000.0 + 2000.0 * t); break;
+            case MATH_LOG:
+            case MATH_SQRT: x[i] = (float)pow(10.0, -37.0 + 75.0 * t); break;
+        }
+    }
+    // Interleave so each batch covers the whole domain
+    for (size_t i = 0; i < n; ++i) {
+        size_t j = (i * 2654435761u) % n;
+        std::swap(x[i], x[j]);
+    }
+}
+
+/**
+ * Distance in representable floats between two finite values
+ */
+double ulp_distance(float a, float b) {
+    if (a == b) return 0.0;
+    if (!isfinite(a) || !isfinite(b)) return INFINITY;
+    int64_t ia = (int32_t)as_bits(a), ib = (int32_t)as_bits(b);
+    if (ia < 0) ia = INT32_MIN - ia;  // map negative floats to a monotonic integer line
+    if (ib < 0) ib = INT32_MIN - ib;
+    return (double)(ia > ib ? ia - ib : ib - ia);
+}
+
+}  // namespace
+
+/**
+ * Time one function and implementation over L1-resident inputs (BATCHES
+ * batches filling about `seconds`, median reported) and measure its ULP error
+ * over ACCURACY_POINTS inputs; -ENOTSUP when the CPU lacks the target ISA
+ */
+HS_EXPORT int transcendental_run(int func, int impl, double seconds, transcendental_result* out) {
+    if (!out || func < MATH_EXP || func > MATH_SQRT || seconds <= 0) return -EINVAL;
+    MapFn fn = impl >= MATH_LIBM && impl <= MATH_POLY_AVX512 ? select(impl) : nullptr;
+    if (!fn) return impl >= MATH_LIBM && impl <= MATH_POLY_AVX512 ? -ENOTSUP : -EINVAL;
+    memset(out, 0, sizeof(*out));
+
+    std::vector<float> x(ACCURACY_POINTS), y(ACCURACY_POINTS);
+    fill_inputs(func, x.data(), x.size());
+    fn(func, x.data(), y.data(), x.size());
+    double sum = 0.0;
+    for (size_t i = 0; i < x.size(); ++i) {
+        double ulp = ulp_distance(y[i], (float)reference(func, x[i]));
+        out->max_ulp = std::max(out->max_ulp, ulp);
+        sum += ulp;
+    }
+    out->mean_ulp = sum / x.size();
+
+    // Throughput on the first BATCH inputs, which already span the domain
+    uint64_t start = hs::ticks_begin();
+    fn(func, x.data(), y.data(), BATCH);
+    uint64_t one = std::max<uint64_t>(1, hs::ticks_end() - start);
+    uint64_t budget = hs::ns_to_ticks((uint64_t)(seconds * 1e9 / BATCHES));
+    uint64_t passes = std::max<uint64_t>(1, budget / one);
+    std::vector<uint64_t> batches;
+    for (int b = 0; b < BATCHES; ++b) {
+        start = hs::ticks_begin();
+        for (uint64_t p = 0; p < passes; ++p) {
+            fn(func, x.data(), y.data(), BATCH);
+            asm volatile("" : : : "memory");
+        }
+        batches.push_back(hs::ticks_end() - start);
+    }
+    out->ns_per_elem = hs::ticks_to_ns(hs::percentile(batches, 0.5)) / (passes * BATCH);
+    out->gelem_s = 1.0 / out->ns_per_elem;
+    out->evaluations = passes * BATCH * BATCHES;
+    return 0;
+}
+
+/**
+ * Compiler that built the polynomial kernels, recorded next to the glibc version
+ */
+HS_EXPORT const char* transcendental_compiler() {
+    return "gcc " __VERSION__;
+}
@@ -0,0 +1,76 @@
+"""
+Payload generation for disk and network stressors
+Fills reusable buffers with zero, fixed-pattern, incompressible or
+tunable-compressibility data so that compressing/deduplicating SSD
+controllers and links cannot optimize the load away
+"""
+
+import array
+import mmap
+import os
+
+PAYLOAD_MODES = ('zeros', 'pattern', 'random', 'compressible')
+SECTOR_SIZE = 4096
+DEFAULT_BLOCK_SIZE = 4 * 1024 * 1024
+DEFAULT_PATTERN = bytes.fromhex('deadbeefcafef00d')
+
+_WORDS_PER_SECTOR = SECTOR_SIZE // 8
+
+
+class PayloadGenerator:
+    """Produces payload blocks into a single page-aligned reusable buffer"""
+
+    def __init__(self, mode='random', block_size=DEFAULT_BLOCK_SIZE,
+                 compress_ratio=0.5, pattern=DEFAULT_PATTERN):
+        if mode not in PAYLOAD_MODES:
+            raise ValueError(f"Unknown payload mode: {mode}")
+        if block_size <= 0 or block_size % SECTOR_SIZE:
+            raise ValueError(f"Block size must be a multiple of {SECTOR_SIZE} bytes")
+        if not 0.0 <= compress_ratio <= 1.0:
+            raise ValueError("Compress ratio must be between 0.0 and 1.0")
+
+        self.mode = mode
+        self.block_size = block_size
+        self.compress_ratio = compress_ratio
+        self.sectors = block_size // SECTOR_SIZE
+        self.buffer = mmap.mmap(-1, block_size)  # page-aligned, usable with O_DIRECT
+        self._words = memoryview(self.buffer).cast('Q')
+        self._sequence = 0
+        # Per-generator salt keeps data unique across runs and processes
+        salt = int.from_bytes(os.urandom(8), 'little')
+        self._salt = array.array('Q', [salt]) * self.sectors
+        self._fill(pattern)
+
+    def _fill(self, pattern):
+        """Generate the base contents once; only sector stamps change later"""
+        if self.mode == 'zeros':
+            return
+        if self.mode == 'pattern':
+            reps = self.block_size // len(pattern) + 1
+            self.buffer[:] = (pattern * reps)[:self.block_size]
+            return
+        self.buffer[:] = os.urandom(self.block_size)
+        if self.mode == 'compressible':
+            # Each sector keeps a random head and a zero tail sized to the ratio
+            random_bytes = int(SECTOR_SIZE * (1.0 - self.compress_ratio))
+            zero_tail = bytes(SECTOR_SIZE - random_bytes)
+            for offset in range(0, self.block_size, SECTOR_SIZE):
+                self.buffer[offset + random_bytes:offset + SECTOR_SIZE] = zero_tail
+
+    @property
+    def stamped(self):
+        """Whether blocks carry per-sector stamps that defeat deduplication"""
+        return self.mode in ('random', 'compressible')
+
+    def next_block(self):
+        """
+        Return a memoryview of the next payload block
+        The buffer is reused; consume it before calling again
+        """
+        if self.stamped:
+            # Stamp the first 16 bytes of every sector with (sequence, salt)
+            start = self._sequence
+            self._words[0::_WORDS_PER_SECTOR] = array.array('Q', range(start, start + self.sectors))
+            self._words[1::_WORDS_PER_SECTOR] = self._salt
+            self._sequence += self.sectors
+        return memoryview(self.buffer)
@@ -0,0 +1,770 @@
+"""
+Offline report generator
+Reads an exported run (CSV, JSON or the binary run format), computes
+statistics in one streaming pass and writes a single self-contained HTML
+file with LTTB-decimated SVG charts, per-phase tables and events
+
+Usage:
+    python stress_tool.py report run.hsrun -o run.html
+"""
+
+import argparse
+import csv
+import html
+import json
+import math
+import os
+import time
+
+import numpy as np
+
+from rollup import Rollups
+from runfile import MAGIC, RunFile
+
+DEFAULT_POINTS = 1500
+CHUNK_ROWS = 4096
+RESERVOIR_SIZE = 8192
+QUANTILES = (0.5, 0.95, 0.99)
+RATE_PREFIX = 'net_'  # cumulative byte counters, charted as rates
+ROOFLINE_COLORS = ('#1f77b4', '#d62728', '#2ca02c')  # per backend
+
+
+# ---------------------------------------------------------------------------
+# Input formats: each loader returns (meta, chunks) where chunks yields
+# (timestamps, {metric: values}) NumPy arrays; NaN marks missing values
+# ---------------------------------------------------------------------------
+
+class _Clock:
+    """Seconds for legacy exports that only carry an HH:MM:SS column, assuming no gap spans a day"""
+
+    def __init__(self):
+        self.day = 0
+        self.previous = None
+
+    def __call__(self, value):
+        h, m, s = (int(x) for x in value.split(':'))
+        t = h * 3600 + m * 60 + s
+        if self.previous is not None and t < self.previous:
+            self.day += 1
+        self.previous = t
+        return self.day * 86400 + t
+
+
+def _chunk_records(records, metrics):
+    """Turn sample dicts into column chunks of CHUNK_ROWS rows"""
+    for start in range(0, len(records), CHUNK_ROWS):
+        chunk = records[start:start + CHUNK_ROWS]
+        timestamps = np.array([r['timestamp'] for r in chunk], dtype=float)
+        columns = {}
+        for metric in metrics:
+            values = [r.get(metric) for r in chunk]
+            columns[metric] = np.array([np.nan if v in (None, '') else float(v) for v in values])
+        yield timestamps, columns
+
+
+def _load_records(records, meta):
+    if records and 'timestamp' not in records[0]:
+        clock = _Clock()
+        for record in records:
+            record['timestamp'] = clock(record['time'])
+    metrics = [k for k in (records[0] if records else {}) if k not in ('time', 'timestamp', 'gap_s')]
+    meta.setdefault('events', [{'timestamp': r['timestamp'], 'type': 'gap', 'seconds': r['gap_s']}
+                               for r in records if r.get('gap_s') not in (None, '')])
+    if records:
+        meta['time_range'] = (records[0]['timestamp'], records[-1]['timestamp'])
+    return meta, _chunk_records(records, metrics)
+
+
+def _load_csv(path):
+    def chunks():
+        with open(path, newline='') as f:
+            reader = csv.DictReader(f)
+            metrics = [k for k in reader.fieldnames if k not in ('time', 'timestamp', 'gap_s')]
+            clock = _Clock()
+            batch = []
+            for row in reader:
+                if not row.get('timestamp'):
+                    row['timestamp'] = clock(row['time'])
+                batch.append(row)
+                if len(batch) == CHUNK_ROWS:
+                    yield from _chunk_records(batch, metrics)
+                    batch = []
+            yield from _chunk_records(batch, metrics)
+    # CSV carries no metadata; gaps are rows whose metrics are all empty
+    return {'events': None}, chunks()
+
+
+def _array_lines(f):
+    """Element lines of a one-element-per-line JSON array, up to its closing bracket"""
+    for line in f:
+        line = line.strip()
+        if line.startswith(']'):
+            return
+        yield line.rstrip(',')
+
+
+def load_json(path):
+    """
+    JSON run export, object or legacy list form, as (meta, chunks); streams the
+    layout monitoring.export_json writes (one sample per line inside
+    "samples": [...], metadata after the arrays): a first pass parses only the
+    metadata, the first and last samples and gap rows, the second yields chunks.
+    Any other JSON is parsed whole
+    """
+    if first_byte(path) == b'[':
+        # --export-json output from before the run metadata: a bare list of samples
+        with open(path) as f:
+            return _load_records(json.load(f), {})
+    with open(path) as f:
+        if f.readline().strip() != '{' or f.readline().strip() != '"samples": [':
+            f.seek(0)
+            run = json.load(f)
+            meta = {k: v for k, v in run.items() if k not in ('samples', 'domain_samples')}
+            return _load_records(run.get('samples', []), meta)
+        first = last = None
+        events = []
+        for line in _array_lines(f):
+            if first is None:
+                first = json.loads(line)
+            if '"gap_s"' in line:
+                sample = json.loads(line)
+                if sample.get('gap_s') not in (None, ''):
+                    events.append({'timestamp': sample['timestamp'], 'type': 'gap', 'seconds': sample['gap_s']})
+            last = line
+        rest = f.readline().strip()
+        if rest == '"domain_samples": [':
+            for _ in _array_lines(f):
+                pass
+            rest = ''
+        meta = json.loads('{' + rest + f.read())
+    meta.setdefault('events', events)
+    if first is None:
+        return meta, iter(())
+    meta['time_range'] = (first['timestamp'], json.loads(last)['timestamp'])
+    metrics = [k for k in first if k not in ('time', 'timestamp', 'gap_s')]
+
+    def chunks():
+        with open(path) as f:
+            f.readline()
+            f.readline()
+            batch = []
+            for line in _array_lines(f):
+                batch.append(json.loads(line))
+                if len(batch) == CHUNK_ROWS:
+                    yield from _chunk_records(batch, metrics)
+                    batch = []
+            yield from _chunk_records(batch, metrics)
+    return meta, chunks()
+
+
+def _load_bin(path):
+    run = RunFile(path)
+    return dict(run.meta, time_range=run.time_range()), run.blocks()
+
+
+def first_byte(path):
+    """First non-blank byte of a file, b'' when it is all whitespace"""
+    with open(path, 'rb') as f:
+        for block in iter(lambda: f.read(65536), b''):
+            block = block.lstrip()
+            if block:
+                return block[:1]
+    return b''
+
+
+def load_run(path):
+    """Open a run export by content: binary run file, JSON (object or legacy list) or CSV"""
+    with open(path, 'rb') as f:
+        head = f.read(len(MAGIC))
+    if head == MAGIC:
+        return _load_bin(path)
+    if first_byte(path) in (b'{', b'['):
+        return load_json(path)
+    return _load_csv(path)
+
+
+# ---------------------------------------------------------------------------
+# Streaming statistics and decimation
+# ---------------------------------------------------------------------------
+
+class MetricStats:
+    """Count, min, max, mean and variance (merged per chunk) plus a reservoir for quantiles"""
+
+    def __init__(self, reservoir=RESERVOIR_SIZE, seed=0):
+        self.count = 0
+        self.mean = 0.0
+        self.m2 = 0.0
+        self.min = math.inf
+        self.max = -math.inf
+        self._reservoir = np.empty(reservoir) if reservoir else None
+        self._rng = np.random.default_rng(seed)
+
+    def add(self, values):
+        values = values[np.isfinite(values)]
+        n = len(values)
+        if not n:
+            return
+        mean = float(values.mean())
+        m2 = float(((values - mean) ** 2).sum())
+        total = self.count + n
+        delta = mean - self.mean
+        self.m2 += m2 + delta * delta * self.count * n / total
+        self.mean += delta * n / total
+        self.min = min(self.min, float(values.min()))
+        self.max = max(self.max, float(values.max()))
+        if self._reservoir is not None:
+            self._sample(values)
+        self.count = total
+
+    def _sample(self, values):
+        """Vectorized Algorithm R over one chunk"""
+        size = len(self._reservoir)
+        fill = max(0, min(size - self.count, len(values)))
+        self._reservoir[self.count:self.count + fill] = values[:fill]
+        rest = values[fill:]
+        if len(rest):
+            seen = self.count + fill + np.arange(1, len(rest) + 1)
+            slots = (self._rng.random(len(rest)) * seen).astype(np.int64)
+            keep = slots < size
+            self._reservoir[slots[keep]] = rest[keep]
+
+    def quantile(self, q):
+        if self._reservoir is None or not self.count:
+            return math.nan
+        return float(np.quantile(self._reservoir[:min(self.count, len(self._reservoir))], q))
+
+    @property
+    def std(self):
+        return math.sqrt(self.m2 / self.count) if self.count else math.nan
+
+
+def _minmax(t, y, group):
+    """
+    Reduce each run of `group` points to its lowest and highest point, in time
+    order, so spikes and dips survive; a run containing a gap (NaN) keeps the
+    gap and its highest point
+    """
+    if group <= 2:
+        return t, y
+    t, y = t.reshape(-1, group), y.reshape(-1, group)
+    gap = np.isnan(y)
+    lo = np.where(gap, np.inf, y).argmin(axis=1)
+    hi = np.where(gap, -np.inf, y).argmax(axis=1)
+    lo = np.where(gap.any(axis=1), gap.argmax(axis=1), lo)
+    rows = np.arange(len(t))[:, None]
+    order = np.stack([np.minimum(lo, hi), np.maximum(lo, hi)], axis=1)
+    return t[rows, order].ravel(), y[rows, order].ravel()
+
+
+class Decimator:
+    """
+    Bounded-memory pre-aggregation for one series: keeps at most ~2*cap points
+    by reducing runs of points to their minimum and maximum whenever it fills
+    up, so the extremes LTTB later picks from are never averaged away (NaN
+    gaps survive the reduction)
+    """
+
+    def __init__(self, cap):
+        self.cap = cap
+        self.factor = 1  # raw samples per kept point
+        self._t, self._y = [], []
+        self._size = 0
+        self._carry_t = np.empty(0)
+        self._carry_y = np.empty(0)
+
+    def add(self, t, y):
+        t = np.concatenate([self._carry_t, t])
+        y = np.concatenate([self._carry_y, y])
+        group = 2 * self.factor
+        usable = len(t) // group * group
+        self._carry_t, self._carry_y = t[usable:], y[usable:]
+        if not usable:
+            return
+        t, y = _minmax(t[:usable], y[:usable], group)
+        self._t.append(t)
+        self._y.append(y)
+        self._size += len(t)
+        if self._size > 2 * self.cap:
+            t, y = np.concatenate(self._t), np.concatenate(self._y)
+            whole = len(t) // 4 * 4
+            reduced_t, reduced_y = _minmax(t[:whole], y[:whole], 4)
+            self._t = [reduced_t, t[whole:]]
+            self._y = [reduced_y, y[whole:]]
+            self._size = len(reduced_t) + len(t) - whole
+            self.factor *= 2
+
+    def series(self):
+        t, y = list(self._t), list(self._y)
+        if len(self._carry_t):
+            carry_t, carry_y = _minmax(self._carry_t, self._carry_y, len(self._carry_t))
+            t.append(carry_t)
+            y.append(carry_y)
+        if not t:
+            return np.empty(0), np.empty(0)
+        return np.concatenate(t), np.concatenate(y)
+
+
+def lttb(t, y, points):
+    """Largest-Triangle-Three-Buckets downsampling of a gap-free series to `points` points"""
+    n = len(t)
+    if points >= n or points < 3:
+        return t, y
+    keep = [0]
+    edges = np.linspace(1, n - 1, points - 1).astype(np.int64)
+    a = 0
+    for i in range(points - 2):
+        lo, hi = edges[i], max(edges[i + 1], edges[i] + 1)
+        nxt_lo, nxt_hi = edges[i + 1], edges[i + 2] if i + 2 < len(edges) else n
+        avg_t = t[nxt_lo:max(nxt_hi, nxt_lo + 1)].mean()
+        avg_y = y[nxt_lo:max(nxt_hi, nxt_lo + 1)].mean()
+        area = np.abs((t[a] - avg_t) * (y[lo:hi] - y[a]) - (t[a] - t[lo:hi]) * (avg_y - y[a]))
+        a = lo + int(area.argmax())
+        keep.append(a)
+    keep.append(n - 1)
+    return t[keep], y[keep]
+
+
+def decimate(t, y, points):
+    """LTTB per gap-free segment, sharing the point budget by segment length; NaN separates segments"""
+    finite = np.isfinite(y)
+    if not finite.any():
+        return np.empty(0), np.empty(0)
+    boundaries = np.flatnonzero(np.diff(finite.astype(np.int8))) + 1
+    segments = [s for s in np.split(np.arange(len(y)), boundaries) if finite[s[0]]]
+    total = sum(len(s) for s in segments)
+    out_t, out_y = [], []
+    for segment in segments:
+        budget = max(3, points * len(segment) // total)
+        st, sy = lttb(t[segment], y[segment], budget)
+        out_t.extend([st, [np.nan]])
+        out_y.extend([sy, [np.nan]])
+    return np.concatenate(out_t[:-1]), np.concatenate(out_y[:-1])
+
+
+# ---------------------------------------------------------------------------
+# Report
+# ---------------------------------------------------------------------------
+
+def _rollup_name(metric):
+    """Rollups hold counters as rates"""
+    return f'{metric}_rate' if metric.startswith(RATE_PREFIX) else metric
+
+
+def rollup_charts(meta, points):
+    """
+    Chart series straight from the run's rollup tiers, when the export has a
+    tier covering the whole run within the point budget
+    Returns: {rollup metric: (time, mean, min, max) arrays} or {}
+    """
+    if not meta.get('rollups') or not meta.get('time_range'):
+        return {}
+    rollups = Rollups.from_dict(meta['rollups'])
+    first, last = meta['time_range']
+    tier = rollups.tier_for(last - first, points)
+    if tier is None or not tier.buckets or tier.buckets[0][0] > first:
+        return {}
+    charts = {}
+    for metric in {m for _, acc in tier.buckets for m in acc}:
+        series = tier.series(metric)
+        t = np.array(series['time'], dtype=float) + tier.resolution / 2
+        columns = [np.array(series[k], dtype=float) for k in ('mean', 'min', 'max')]
+        # Break the line where buckets are missing (gaps), not merely sparser than the tier
+        spacing = np.diff(t)
+        if len(spacing):
+            breaks = np.flatnonzero(spacing > 3 * max(float(np.median(spacing)), tier.resolution)) + 1
+            t = np.insert(t, breaks, np.nan)
+            columns = [np.insert(c, breaks, np.nan) for c in columns]
+        charts[metric] = (t, *columns)
+    return charts
+
+
+class RunSummary:
+    """Everything the report needs, gathered in one pass over the chunks"""
+
+    def __init__(self, points, rollups=None):
+        """rollups: charts from rollup_charts(); those metrics skip raw decimation"""
+        self.points = points
+        self.rollups = rollups or {}
+        self.overall = {}
+        self.phases = []
+        self.charts = {}
+        self.samples = 0
+        self.first = None
+        self.last = None
+        self.gap_rows = []
+        self._last_counter = {}
+        self._in_gap = True
+
+    def add_chunk(self, timestamps, columns):
+        if not len(timestamps):
+            return
+        if self.first is None:
+            self.first = float(timestamps[0])
+        self.last = float(timestamps[-1])
+        self.samples += len(timestamps)
+        columns = dict(columns)
+        for metric in list(columns):
+            if metric.startswith(RATE_PREFIX):
+                columns[metric] = self._rate(metric, timestamps, columns[metric])
+
+        # Rows with every metric missing are gap markers and start a new phase
+        stacked = np.vstack(list(columns.values())) if columns else np.empty((0, len(timestamps)))
+        gap = ~np.isfinite(stacked).any(axis=0) if len(stacked) else np.zeros(len(timestamps), bool)
+        starts = [0] + list(np.flatnonzero(gap)) + [len(timestamps)]
+        for lo, hi in zip(starts[:-1], starts[1:]):
+            if gap[lo]:
+                self.gap_rows.append(float(timestamps[lo]))
+                self._in_gap = True
+                self._last_counter = {}
+                lo += 1
+            if lo >= hi:
+                continue
+            if self._in_gap:
+                self.phases.append({'start': float(timestamps[lo]), 'samples': 0, 'stats': {}})
+                self._in_gap = False
+            phase = self.phases[-1]
+            phase['end'] = float(timestamps[hi - 1])
+            phase['samples'] += hi - lo
+            for metric, values in columns.items():
+                phase['stats'].setdefault(metric, MetricStats(reservoir=0)).add(values[lo:hi])
+
+        for metric, values in columns.items():
+            self.overall.setdefault(metric, MetricStats()).add(values)
+            if _rollup_name(metric) not in self.rollups:
+                self.charts.setdefault(metric, Decimator(self.points * 8)).add(timestamps, values)
+
+    def _rate(self, metric, timestamps, values):
+        """Per-second deltas of a cumulative counter, continuing across chunks"""
+        previous = self._last_counter.get(metric)
+        t = np.concatenate([[previous[0]], timestamps]) if previous else timestamps
+        v = np.concatenate([[previous[1]], values]) if previous else values
+        rates = np.diff(v) / np.maximum(np.diff(t), 1e-9)
+        rates[rates < 0] = np.nan  # counter reset
+        if not previous:
+            rates = np.concatenate([[np.nan], rates])
+        finite = np.flatnonzero(np.isfinite(values))
+        if len(finite):
+            self._last_counter[metric] = (timestamps[finite[-1]], values[finite[-1]])
+        return rates
+
+
+def _format_time(t):
+    if t is None:
+        return ''
+    if t < 10 * 86400:  # relative seconds from a legacy clock-only CSV
+        return f"day {int(t // 86400)} {time.strftime('%H:%M:%S', time.gmtime(t))}"
+    return time.strftime('%Y-%m-%d %H:%M:%S', time.localtime(t))
+
+
+def _format_value(value):
+    if value is None or (isinstance(value, float) and not math.isfinite(value)):
+        return ''
+    if abs(value) >= 1e6:
+        return f'{value:.3g}'
+    return f'{value:.2f}'
+
+
+def _format_duration(seconds):
+    seconds = int(seconds)
+    return f'{seconds // 3600}h{seconds % 3600 // 60:02d}m{seconds % 60:02d}s'
+
+
+def _table(headers, rows):
+    out = ['<table><tr>' + ''.join(f'<th>{html.escape(str(h))}</th>' for h in headers) + '</tr>']
+    for row in rows:
+        out.append('<tr>' + ''.join(f'<td>{html.escape(str(c))}</td>' for c in row) + '</tr>')
+    out.append('</table>')
+    return '\n'.join(out)
+
+
+def _svg_chart(metric, t, y, t0, t1, band=None, width=900, height=160):
+    """Inline SVG line chart; NaN breaks the line; band = (min, max) arrays drawn shaded behind it"""
+    pad_left, pad_bottom = 60, 20
+    finite = y[np.isfinite(y)]
+    if not len(finite):
+        return ''
+    lo, hi = float(finite.min()), float(finite.max())
+    if band is not None:
+        lo, hi = min(lo, float(np.nanmin(band[0]))), max(hi, float(np.nanmax(band[1])))
+    if metric in ('cpu', 'ram', 'disk') or metric.endswith(('.cpu', '.mem_used')):
+        lo, hi = 0.0, max(hi, 100.0)
+    if hi == lo:
+        hi = lo + 1.0
+    span = max(t1 - t0, 1e-9)
+    plot_w, plot_h = width - pad_left - 10, height - pad_bottom - 10
+
+    def segments(values):
+        paths, current = [], []
+        for ti, yi in zip(t, values):
+            if not math.isfinite(ti) or not math.isfinite(yi):
+                if current:
+                    paths.append(current)
+                current = []
+                continue
+            x = pad_left + (ti - t0) / span * plot_w
+            yy = 10 + (1 - (yi - lo) / (hi - lo)) * plot_h
+            current.append(f'{x:.1f},{yy:.1f}')
+        if current:
+            paths.append(current)
+        return paths
+
+    lines = ''.join(f'<polyline points="{" ".join(p)}"/>' for p in segments(y))
+    if band is not None:
+        # Upper edge left to right, lower edge back, per gap-free segment
+        polygons = ''.join(f'<polygon points="{" ".join(upper + lower[::-1])}"/>'
+                           for upper, lower in zip(segments(band[1]), segments(band[0])))
+        lines = f'<g class="band">{polygons}</g>' + lines
+    return (f'<svg width="{width}" height="{height}" viewBox="0 0 {width} {height}">'
+            f'<rect x="{pad_left}" y="10" width="{plot_w}" height="{plot_h}" class="frame"/>'
+            f'<text x="{pad_left - 4}" y="18" class="axis" text-anchor="end">{_format_value(hi)}</text>'
+            f'<text x="{pad_left - 4}" y="{10 + plot_h}" class="axis" text-anchor="end">{_format_value(lo)}</text>'
+            f'<text x="{pad_left}" y="{height - 4}" class="axis">{html.escape(_format_time(t0))}</text>'
+            f'<text x="{width - 10}" y="{height - 4}" class="axis" text-anchor="end">'
+            f'{html.escape(_format_time(t1))}</text>'
+            f'<g class="line">{lines}</g></svg>')
+
+
+def _svg_roofline(fits, width=900, height=360):
+    """
+    Log-log roofline chart: fitted ceilings (bandwidth slope and compute roof)
+    per backend as lines, measured points as dots
+    """
+    pad_left, pad_bottom = 60, 30
+    points = [p for fit in fits.values() for p in fit['points'] if p['gflops'] > 0]
+    if not points:
+        return ''
+    x_lo = math.log10(min(p['intensity'] for p in points))
+    x_hi = math.log10(max(p['intensity'] for p in points))
+    y_lo = math.log10(min(p['gflops'] for p in points))
+    y_hi = math.log10(max(fit['peak_gflops'] for fit in fits.values()))
+    x_hi, y_hi = max(x_hi, x_lo + 1), max(y_hi, y_lo + 1)
+    plot_w, plot_h = width - pad_left - 10, height - pad_bottom - 10
+
+    def xy(intensity, gflops):
+        x = pad_left + (math.log10(intensity) - x_lo) / (x_hi - x_lo) * plot_w
+        y = 10 + (1 - (math.log10(gflops) - y_lo) / (y_hi - y_lo)) * plot_h
+        return f'{x:.1f},{y:.1f}'
+
+    shapes, legend = [], []
+    for i, (backend, fit) in enumerate(fits.items()):
+        color = ROOFLINE_COLORS[i % len(ROOFLINE_COLORS)]
+        bandwidth, peak = fit['bandwidth_gb_s'], fit['peak_gflops']
+        if bandwidth > 0 and peak > 0:
+            ridge = min(max(fit['ridge_intensity'], 10 ** x_lo), 10 ** x_hi)
+            start = max(10 ** x_lo, 10 ** y_lo / bandwidth)
+            roof = [xy(start, start * bandwidth), xy(ridge, min(peak, ridge * bandwidth)), xy(10 ** x_hi, peak)]
+            shapes.append(f'<polyline points="{" ".join(roof)}" class="roof" stroke="{color}"/>')
+        for p in fit['points']:
+            if p['gflops'] > 0:
+                x, y = xy(p['intensity'], p['gflops']).split(',')
+                shapes.append(f'<circle cx="{x}" cy="{y}" r="3" fill="{color}"/>')
+        legend.append(f'<text x="{pad_left + 8}" y="{28 + 14 * i}" class="axis" fill="{color}">'
+                      f'{html.escape(backend)}: {bandwidth:.1f} GB/s, {peak:.1f} GFLOPS, '
+                      f'ridge {fit["ridge_intensity"]:.2g} FLOP/byte</text>')
+    return (f'<svg width="{width}" height="{height}" viewBox="0 0 {width} {height}">'
+            f'<rect x="{pad_left}" y="10" width="{plot_w}" height="{plot_h}" class="frame"/>'
+            f'<text x="{pad_left - 4}" y="18" class="axis" text-anchor="end">{_format_value(10 ** y_hi)}</text>'
+            f'<text x="{pad_left - 4}" y="{10 + plot_h}" class="axis" text-anchor="end">'
+            f'{_format_value(10 ** y_lo)}</text>'
+            f'<text x="{pad_left}" y="{height - 14}" class="axis">{10 ** x_lo:g}</text>'
+            f'<text x="{width - 10}" y="{height - 14}" class="axis" text-anchor="end">{10 ** x_hi:g}</text>'
+            f'<text x="{pad_left + plot_w / 2:.0f}" y="{height - 2}" class="axis" text-anchor="middle">'
+            f'FLOP/byte (GFLOPS on the vertical axis, both log scale)</text>'
+            f'{"".join(shapes)}{"".join(legend)}</svg>')
+
+
+STYLE = """
+body { font-family: sans-serif; margin: 2em; color: #222; }
+table { border-collapse: collapse; margin-bottom: 1.5em; }
+th, td { border: 1px solid #ccc; padding: 3px 8px; text-align: right; }
+th:first-child, td:first-child { text-align: left; }
+.frame { fill: #fafafa; stroke: #ccc; }
+.line polyline { fill: none; stroke: #1f77b4; stroke-width: 1.2; }
+.band polygon { fill: #1f77b4; opacity: 0.15; stroke: none; }
+.axis { font-size: 11px; fill: #555; }
+.roof { fill: none; stroke-width: 1.5; }
+"""
+
+
+def render_html(path, meta, summary):
+    title = f"Run report: {os.path.basename(path)}"
+    parts = [f'<!DOCTYPE html><html><head><meta charset="utf-8"><title>{html.escape(title)}</title>'
+             f'<style>{STYLE}</style></head><body><h1>{html.escape(title)}</h1>']
+
+    duration = (summary.last - summary.first) if summary.first is not None else 0
+    info = [('Start', _format_time(summary.first)), ('End', _format_time(summary.last)),
+            ('Duration', _format_duration(duration)), ('Samples', summary.samples)]
+    info += [(k, v) for k, v in (meta.get('manifest') or {}).items()]
+    parts.append('<h2>Run</h2>' + _table(('Field', 'Value'), info))
+
+    rows = []
+    for metric, stats in summary.overall.items():
+        rows.append([metric, stats.count, _format_value(stats.min), _format_value(stats.mean)] +
+                    [_format_value(stats.quantile(q)) for q in QUANTILES] +
+                    [_format_value(stats.max), _format_value(stats.std)])
+    parts.append('<h2>Statistics</h2>' + _table(
+        ['Metric', 'Samples', 'Min', 'Mean'] + [f'p{int(q * 100)}' for q in QUANTILES] + ['Max', 'Std'], rows))
+
+    if summary.phases:
+        metrics = list(summary.overall)
+        rows = []
+        for i, phase in enumerate(summary.phases):
+            row = [i + 1, _format_time(phase['start']), _format_duration(phase['end'] - phase['start']),
+                   phase['samples']]
+            for metric in metrics:
+                stats = phase['stats'].get(metric)
+                row.append(f"{_format_value(stats.mean)} / {_format_value(stats.max)}"
+                           if stats and stats.count else '')
+            rows.append(row)
+        parts.append('<h2>Phases</h2><p>A new phase starts after each gap (resumed soak run). '
+                     'Cells are mean / max.</p>' +
+                     _table(['Phase', 'Start', 'Duration', 'Samples'] + metrics, rows))
+
+    events = meta.get('events')
+    if events is None:
+        events = [{'timestamp': t, 'type': 'gap', 'seconds': None} for t in summary.gap_rows]
+    if events:
+        rows = [[_format_time(e['timestamp']), e['type'],
+                 _format_duration(e['seconds']) if e.get('seconds') is not None else ''] for e in events]
+        parts.append('<h2>Events</h2>' + _table(('Time', 'Event', 'Length'), rows))
+
+    results = meta.get('results') or {}
+    if results:
+        rows = [[name, result.get('summary', '')] for name, result in results.items()]
+        parts.append('<h2>Stressor Results</h2>' + _table(('Stressor', 'Summary'), rows))
+
+    roofline = results.get('roofline') or {}
+    fits = {backend: fit for backend, fit in roofline.items() if isinstance(fit, dict) and 'points' in fit}
+    if fits:
+        host = (meta.get('manifest') or {}).get('hostname', '')
+        chart = _svg_roofline(fits)
+        rows = [[backend, f"{p['intensity']:g}", _format_value(p['gflops']), _format_value(p['gb_s']), p['bound'],
+                 f"{p['efficiency'] * 100:.0f}%"] for backend, fit in fits.items() for p in fit['points']]
+        parts.append(f'<h2>Roofline{" of " + html.escape(host) if host else ""}</h2>{chart}' +
+                     _table(('Backend', 'FLOP/byte', 'GFLOPS', 'GB/s', 'Bound', 'Of roof'), rows))
+
+    loaded = (results.get('loaded_latency') or {}).get('points')
+    if loaded:
+        rows = [[p['ratio'], '' if p['delay_ns'] is None else p['delay_ns'], _format_value(p['latency_ns']),
+                 _format_value(p['bandwidth_gb_s']), _format_value(p['read_gb_s']), _format_value(p['write_gb_s'])]
+                for p in loaded]
+        parts.append('<h2>Loaded Latency</h2>' + _table(
+            ('Read:write', 'Delay (ns)', 'Latency (ns)', 'GB/s', 'Read GB/s', 'Write GB/s'), rows))
+
+    streams = (results.get('prefetch_streams') or {}).get('points')
+    if streams:
+        mixes = list(dict.fromkeys(p['mix'] for p in streams))
+        by_count = {}
+        for p in streams:
+            by_count.setdefault(p['streams'], {})[p['mix']] = p
+        rows = [[count] + [_format_value(row[m]['gb_s']) if m in row else '' for m in mixes]
+                for count, row in sorted(by_count.items())]
+        parts.append('<h2>Prefetch Streams</h2><p>GB/s by concurrent sequential streams per thread.</p>' +
+                     _table(['Streams'] + mixes, rows))
+
+    copies = results.get('memcpy') or {}
+    if copies.get('points'):
+        impls = list(dict.fromkeys(p['impl'] for p in copies['points']))
+        by_row = {}
+        for p in copies['points']:
+            by_row.setdefault((p['alignment'], p['size']), {})[p['impl']] = p['gb_s']
+        fastest = {alignment: {int(size): impl for size, impl in entry['winners']}
+                   for alignment, entry in copies['crossovers'].items()}
+        rows = [[alignment, size] + [_format_value(row.get(impl)) for impl in impls] +
+                [fastest.get(alignment, {}).get(int(size), '')]
+                for (alignment, size), row in by_row.items()]
+        parts.append('<h2>memcpy</h2><p>GB/s per implementation.</p>' +
+                     _table(['Alignment', 'Bytes'] + impls + ['Fastest'], rows))
+
+    faults = (results.get('page_faults') or {}).get('points')
+    if faults:
+        rows = [[p['mode'], p['page'], p['threads'], _format_value(p['gb_s']),
+                 _format_value(p['faults_per_sec']), _format_value(p['ns_per_fault'])] for p in faults]
+        parts.append('<h2>Page Faults</h2>' + _table(
+            ('Mode', 'Pages', 'Threads', 'GB/s', 'Faults/s', 'ns/fault'), rows))
+
+    math_points = (results.get('math') or {}).get('points')
+    if math_points:
+        rows = [[p['function'], p['impl'], _format_value(p['gelem_s']), _format_value(p['speedup']),
+                 _format_value(p['max_ulp']), _format_value(p['mean_ulp'])] for p in math_points]
+        parts.append('<h2>Transcendental Math</h2>' + _table(
+            ('Function', 'Implementation', 'Gelem/s', 'vs libm', 'Max ULP', 'Mean ULP'), rows))
+
+    spmv = (results.get('spmv') or {}).get('points')
+    if spmv:
+        rows = [[p['pattern'], p['format'] + ('' if p.get('numa_local', True) else ' (no first touch)'), p['threads'],
+                 _format_value(p['gflops']), _format_value(p['gb_s']), _format_value(p['fill']), p['max_row_nnz']]
+                for p in spmv]
+        parts.append('<h2>SpMV</h2>' + _table(
+            ('Pattern', 'Format', 'Threads', 'GFLOPS', 'GB/s', 'Fill', 'Longest row'), rows))
+
+    stencils = (results.get('stencil') or {}).get('points')
+    if stencils:
+        rows = [[p['stencil'], p['variant'], p['tile'], p['time_block'], _format_value(p['gcells_s']),
+                 _format_value(p['gflops']), _format_value(p['gb_s'])] for p in stencils]
+        parts.append('<h2>Stencils</h2><p>GB/s is effective: one read and one write per cell update.</p>' + _table(
+            ('Stencil', 'Variant', 'Tile', 'Steps/block', 'Gcells/s', 'GFLOPS', 'GB/s'), rows))
+
+    radix_join = (results.get('radix_join') or {}).get('points')
+    if radix_join:
+        rows = [[p['workload'], p['rows'], p['variant'], p.get('partition_bits', ''), p['threads'],
+                 _format_value(p['tuples_s'] / 1e6),
+                 _format_value(p['partition_share'] * 100) if 'partition_share' in p else '',
+                 'yes' if p.get('sorted', p.get('valid')) else 'no'] for p in radix_join]
+        parts.append('<h2>Radix Sort / Hash Join</h2><p>Join rows are build tuples; each join probes '
+                     'four times as many, and M tuples/s counts both sides.</p>' + _table(
+            ('Workload', 'Rows', 'Variant', 'Partition bits', 'Threads', 'M tuples/s', 'Partitioning %', 'Checked'),
+            rows))
+
+    domains = meta.get('domains') or {}
+    for kind, label in (('socket', 'Per-Socket'), ('node', 'Per-NUMA-Node')):
+        if domains.get(kind):
+            fields = ('cpu_avg', 'cpu_max', 'temp_max', 'mem_used_avg', 'mem_used_max', 'remote_alloc_percent')
+            rows = [[f'{kind} {d}', entry.get('cpus', '')] + [_format_value(entry.get(f)) for f in fields]
+                    for d, entry in domains[kind].items()]
+            parts.append(f'<h2>{label}</h2>' + _table(('Domain', 'CPUs') + fields, rows))
+
+    parts.append('<h2>Charts</h2>')
+    for metric in summary.overall:
+        band = None
+        if _rollup_name(metric) in summary.rollups:
+            t, y, low, high = summary.rollups[_rollup_name(metric)]
+            band = (low, high)
+        elif metric in summary.charts:
+            t, y = decimate(*summary.charts[metric].series(), summary.points)
+        else:
+            continue
+        label = f'{metric} (per second)' if metric.startswith(RATE_PREFIX) else metric
+        chart = _svg_chart(metric, t, y, summary.first, summary.last, band)
+        if chart:
+            parts.append(f'<h3>{html.escape(label)}</h3>{chart}')
+    parts.append('</body></html>')
+    return '\n'.join(parts)
+
+
+def generate_report(path, output, points=DEFAULT_POINTS):
+    """Build the HTML report for one exported run; returns the RunSummary"""
+    meta, chunks = load_run(path)
+    summary = RunSummary(points, rollup_charts(meta, points))
+    for timestamps, columns in chunks:
+        summary.add_chunk(timestamps, columns)
+    with open(output, 'w') as f:
+        f.write(render_html(path, meta, summary))
+    return summary
+
+
+def main(argv=None):
+    parser = argparse.ArgumentParser(prog='stress_tool.py report',
+                                     description='Render an exported run (CSV, JSON or .hsrun) as a self-contained HTML report')
+    parser.add_argument('input', help='Run export (--export-csv, --export-json or --export-bin)')
+    parser.add_argument('-o', '--output', default=None, help='HTML file to write (default: <input>.html)')
+    parser.add_argument('--points', type=int, default=DEFAULT_POINTS, help='Points per chart after LTTB downsampling')
+    args = parser.parse_args(argv)
+    output = args.output or os.path.splitext(args.input)[0] + '.html'
+    start = time.time()
+    summary = generate_report(args.input, output, args.points)
+    print(f"[INFO] Report written to {output} ({summary.samples} samples in {time.time() - start:.1f}s)")
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,103 @@
+"""
+Multi-resolution rollups of monitoring samples
+Each tier keeps min/max/sum/count per metric in fixed time buckets, updated
+incrementally as samples arrive, so the live graph and reports can read a
+pre-aggregated series instead of scanning raw samples
+"""
+
+from collections import deque
+
+# (bucket seconds, buckets retained): 1 s for an hour, 10 s for a day, 1 min for a week
+ROLLUP_TIERS = ((1, 3600), (10, 8640), (60, 10080))
+
+
+class RollupTier:
+    """Fixed-width buckets of [min, max, sum, count] per metric; the newest bucket is the open one"""
+
+    def __init__(self, resolution, retention):
+        self.resolution = resolution
+        self.retention = retention
+        self.buckets = deque(maxlen=retention)  # [bucket start, {metric: [min, max, sum, count]}]
+
+    def add(self, timestamp, values):
+        start = timestamp - timestamp % self.resolution
+        if not self.buckets or self.buckets[-1][0] != start:
+            self.buckets.append([start, {}])
+        acc = self.buckets[-1][1]
+        for metric, value in values.items():
+            if value is None:
+                continue
+            entry = acc.get(metric)
+            if entry is None:
+                acc[metric] = [value, value, value, 1]
+            else:
+                entry[0] = min(entry[0], value)
+                entry[1] = max(entry[1], value)
+                entry[2] += value
+                entry[3] += 1
+
+    def span(self):
+        """Seconds covered by the retained buckets"""
+        if not self.buckets:
+            return 0.0
+        return self.buckets[-1][0] - self.buckets[0][0] + self.resolution
+
+    def series(self, metric, since=None):
+        """
+        Buckets holding the metric, oldest first
+        Returns: dict of lists 'time' (bucket start), 'min', 'max', 'mean', 'count'
+        """
+        out = {'time': [], 'min': [], 'max': [], 'mean': [], 'count': []}
+        for start, acc in self.buckets:
+            entry = acc.get(metric)
+            if entry is None or (since is not None and start + self.resolution <= since):
+                continue
+            out['time'].append(start)
+            out['min'].append(entry[0])
+            out['max'].append(entry[1])
+            out['mean'].append(entry[2] / entry[3])
+            out['count'].append(entry[3])
+        return out
+
+
+class Rollups:
+    """All tiers, fed from one add() per sample"""
+
+    def __init__(self, tiers=ROLLUP_TIERS):
+        self.tiers = [RollupTier(resolution, retention) for resolution, retention in tiers]
+
+    def add(self, timestamp, values):
+        for tier in self.tiers:
+            tier.add(timestamp, values)
+
+    def tier_for(self, span, max_points):
+        """Finest tier that still covers `span` seconds in at most max_points buckets, or None"""
+        for tier in self.tiers:
+            if tier.span() >= span * 0.99 and span / tier.resolution <= max_points:
+                return tier
+        return None
+
+    def series(self, metric, max_points, span=None):
+        """
+        Pre-aggregated series for the last `span` seconds (default: everything
+        retained) with at most about max_points buckets; falls back to the
+        coarsest tier when none fits
+        """
+        if not self.tiers[-1].buckets:
+            return RollupTier(1, 0).series(metric)
+        end = self.tiers[0].buckets[-1][0] + self.tiers[0].resolution
+        if span is None:
+            span = max(tier.span() for tier in self.tiers)
+        tier = self.tier_for(span, max_points) or self.tiers[-1]
+        return tier.series(metric, since=end - span)
+
+    def to_dict(self):
+        return [{'resolution': tier.resolution, 'retention': tier.retention,
+                 'buckets': [[start, acc] for start, acc in tier.buckets]} for tier in self.tiers]
+
+    @classmethod
+    def from_dict(cls, tiers):
+        rollups = cls([(tier['resolution'], tier['retention']) for tier in tiers])
+        for tier, saved in zip(rollups.tiers, tiers):
+            tier.buckets.extend([start, acc] for start, acc in saved['buckets'])
+        return rollups
@@ -0,0 +1,387 @@
+"""
+Binary run format (.hsrun)
+Columnar float64 blocks of monitoring samples with a block index and a JSON
+metadata trailer, so long runs can be written incrementally and read back
+block by block
+
+Layout:
+    header   MAGIC, u32 length, JSON {'version', 'metrics', 'block_rows', 'manifest'}
+    blocks   u32 rows, u32 columns, then one float64[rows] array per column
+             (column 0 is the Unix timestamp, then one per metric; NaN = missing)
+    index    one INDEX_ENTRY per block: offset, rows, first and last timestamp
+    meta     JSON (host manifest, results, events, ...)
+    footer   index offset, block count, meta offset, END_MAGIC
+"""
+
+import ctypes
+import errno
+import json
+import math
+import mmap
+import os
+import platform
+import struct
+
+import numpy as np
+
+MAGIC = b'HSRUN001'
+END_MAGIC = b'HSRUNEND'
+FORMAT_VERSION = 1
+DEFAULT_BLOCK_ROWS = 4096
+
+HEADER_LENGTH = struct.Struct('<I')
+BLOCK_HEADER = struct.Struct('<II')
+INDEX_ENTRY = struct.Struct('<QIIdd')
+FOOTER = struct.Struct('<QQQ8s')
+
+
+def host_manifest():
+    """Identify the host a run came from: CPU model, kernel, firmware and microcode"""
+    manifest = {'hostname': platform.node(), 'kernel': platform.release(), 'cpu_model': platform.processor(),
+                'microcode': '', 'firmware': ''}
+    try:
+        with open('/proc/cpuinfo') as f:
+            for line in f:
+                key, _, value = line.partition(':')
+                key = key.strip()
+                if key == 'model name' and value.strip():
+                    manifest['cpu_model'] = value.strip()
+                elif key == 'microcode':
+                    manifest['microcode'] = value.strip()
+                    break
+    except OSError:
+        pass
+    try:
+        with open('/sys/class/dmi/id/bios_version') as f:
+            manifest['firmware'] = f.read().strip()
+    except OSError:
+        pass
+    return manifest
+
+
+class RunWriter:
+    """Append samples row by row; rows are buffered and flushed as columnar blocks"""
+
+    def __init__(self, path, metrics, block_rows=DEFAULT_BLOCK_ROWS, manifest=None):
+        """manifest goes in the header so fleet scans never need the metadata trailer"""
+        self.metrics = list(metrics)
+        self.block_rows = block_rows
+        self._file = open(path, 'wb')
+        self._index = []
+        self._rows = []
+        header = json.dumps({'version': FORMAT_VERSION, 'metrics': self.metrics,
+                             'block_rows': block_rows, 'manifest': manifest or {}}).encode()
+        # Pad so every block, and so every column, starts 8-byte aligned
+        header += b' ' * (-(len(MAGIC) + HEADER_LENGTH.size + len(header)) % 8)
+        self._file.write(MAGIC + HEADER_LENGTH.pack(len(header)) + header)
+
+    def write(self, timestamp, values):
+        """values: {metric: number or None}; absent metrics are stored as NaN"""
+        row = [timestamp]
+        for metric in self.metrics:
+            value = values.get(metric)
+            row.append(float('nan') if value is None else value)
+        self._rows.append(row)
+        if len(self._rows) >= self.block_rows:
+            self._flush_block()
+
+    def _flush_block(self):
+        if not self._rows:
+            return
+        columns = np.array(self._rows, dtype='<f8').T
+        self._index.append((self._file.tell(), len(self._rows), float(columns[0, 0]), float(columns[0, -1])))
+        self._file.write(BLOCK_HEADER.pack(len(self._rows), columns.shape[0]))
+        self._file.write(np.ascontiguousarray(columns).tobytes())
+        self._rows = []
+
+    def close(self, meta=None):
+        """Flush the last block and write the index, metadata and footer"""
+        self._flush_block()
+        index_offset = self._file.tell()
+        for entry in self._index:
+            self._file.write(INDEX_ENTRY.pack(entry[0], entry[1], 0, entry[2], entry[3]))
+        meta_offset = self._file.tell()
+        self._file.write(json.dumps(meta or {}).encode())
+        self._file.write(FOOTER.pack(index_offset, len(self._index), meta_offset, END_MAGIC))
+        self._file.close()
+
+
+INDEX_DTYPE = np.dtype([('offset', '<u8'), ('rows', '<u4'), ('pad', '<u4'), ('first', '<f8'), ('last', '<f8')])
+
+
+class _PyRunReader:
+    """
+    Pure-Python fallback for RunReader when libhoststress.so is not built:
+    maps the file and applies the same layout checks as runfile_reader.cpp
+    """
+
+    def __init__(self, path):
+        self.path = path
+        with open(path, 'rb') as f:
+            self._map = mmap.mmap(f.fileno(), 0, access=mmap.ACCESS_READ)
+        try:
+            self._parse()
+        except (ValueError, struct.error):
+            self.close()
+            raise
+
+    def _parse(self):
+        data, size = self._map, len(self._map)
+        if size < len(MAGIC) + HEADER_LENGTH.size + FOOTER.size or data[:len(MAGIC)] != MAGIC:
+            raise ValueError(f"{self.path}: not a run file")
+        length, = HEADER_LENGTH.unpack_from(data, len(MAGIC))
+        header_end = len(MAGIC) + HEADER_LENGTH.size + length
+        self._footer_offset = size - FOOTER.size
+        index_offset, nblocks, self._meta_offset, end = FOOTER.unpack_from(data, self._footer_offset)
+        if (end != END_MAGIC or not header_end <= index_offset <= self._meta_offset <= self._footer_offset or
+                nblocks * INDEX_ENTRY.size > self._meta_offset - index_offset):
+            raise ValueError(f"{self.path}: truncated or corrupt run file")
+        self.header = json.loads(data[len(MAGIC) + HEADER_LENGTH.size:header_end])
+        self.index = np.frombuffer(data, dtype=INDEX_DTYPE, count=nblocks, offset=index_offset)
+        for offset, rows in zip(self.index['offset'].tolist(), self.index['rows'].tolist()):
+            if offset % 8 or not header_end <= offset <= index_offset - BLOCK_HEADER.size:
+                raise ValueError(f"{self.path}: block outside the data section")
+            count, ncols = BLOCK_HEADER.unpack_from(data, offset)
+            if (count != rows or ncols != len(self.header['metrics']) + 1 or
+                    offset + BLOCK_HEADER.size + count * ncols * 8 > index_offset):
+                raise ValueError(f"{self.path}: corrupt block at offset {offset}")
+        self.metrics = self.header['metrics']
+        self.manifest = self.header.get('manifest', {})
+        self.rows = int(self.index['rows'].sum())
+        self.blocks = nblocks
+        self.time_range = (float(self.index['first'][0]), float(self.index['last'][-1])) if nblocks else None
+
+    def close(self):
+        """Unmap the file, or leave it to the last array from block() still referencing it"""
+        if self._map is not None:
+            self.index = None
+            try:
+                self._map.close()
+            except BufferError:
+                pass
+            self._map = None
+
+    @property
+    def meta(self):
+        return json.loads(self._map[self._meta_offset:self._footer_offset])
+
+    def block(self, i):
+        """(timestamps, {metric: values}) of block i as views into the mapping"""
+        offset = int(self.index['offset'][i])
+        count, ncols = BLOCK_HEADER.unpack_from(self._map, offset)
+        data = np.frombuffer(self._map, dtype='<f8', count=count * ncols,
+                             offset=offset + BLOCK_HEADER.size).reshape(ncols, count)
+        return data[0], dict(zip(self.metrics, data[1:]))
+
+
+class RunFileInfo(ctypes.Structure):
+    _fields_ = [
+        ('rows', ctypes.c_uint64),
+        ('blocks', ctypes.c_uint32),
+        ('columns', ctypes.c_uint32),
+        ('header_length', ctypes.c_uint32),
+        ('first_time', ctypes.c_double),
+        ('last_time', ctypes.c_double),
+    ]
+
+
+_libraries = {}
+
+
+def _load_reader_library(build_dir):
+    """Load libhoststress.so once per build directory and declare the run-file reader signatures"""
+    lib_path = os.path.abspath(os.path.join(build_dir, "libhoststress.so"))
+    if lib_path in _libraries:
+        return _libraries[lib_path]
+    if not os.path.exists(lib_path):
+        raise FileNotFoundError(
+            f"Library not found: {lib_path}. Run 'make host' first to compile the native run-file reader."
+        )
+    lib = ctypes.CDLL(lib_path)
+    handle_p = ctypes.POINTER(ctypes.c_void_p)
+    lib.runfile_open.argtypes = [ctypes.c_char_p, handle_p]
+    lib.runfile_open.restype = ctypes.c_int
+    lib.runfile_close.argtypes = [ctypes.c_void_p]
+    lib.runfile_close.restype = None
+    lib.runfile_get_info.argtypes = [ctypes.c_void_p, ctypes.POINTER(RunFileInfo)]
+    lib.runfile_get_info.restype = ctypes.c_int
+    lib.runfile_header.argtypes = [ctypes.c_void_p]
+    lib.runfile_header.restype = ctypes.c_void_p
+    lib.runfile_meta.argtypes = [ctypes.c_void_p, ctypes.POINTER(ctypes.c_void_p), ctypes.POINTER(ctypes.c_uint64)]
+    lib.runfile_meta.restype = ctypes.c_int
+    lib.runfile_seek.argtypes = [ctypes.c_void_p, ctypes.c_double, ctypes.c_double,
+                                 ctypes.POINTER(ctypes.c_uint32), ctypes.POINTER(ctypes.c_uint32)]
+    lib.runfile_seek.restype = ctypes.c_int
+    lib.runfile_block_rows.argtypes = [ctypes.c_void_p, ctypes.c_uint32, ctypes.c_double, ctypes.c_double,
+                                       ctypes.POINTER(ctypes.c_uint64), ctypes.POINTER(ctypes.c_uint64)]
+    lib.runfile_block_rows.restype = ctypes.c_int
+    lib.runfile_column.argtypes = [ctypes.c_void_p, ctypes.c_uint32, ctypes.c_uint32,
+                                   ctypes.POINTER(ctypes.POINTER(ctypes.c_double)), ctypes.POINTER(ctypes.c_uint64)]
+    lib.runfile_column.restype = ctypes.c_int
+    _libraries[lib_path] = lib
+    return lib
+
+
+def _check(rc, what):
+    if rc < 0:
+        raise OSError(-rc, f"{what} failed: {os.strerror(-rc)}")
+
+
+class _Mapping:
+    """Owns the native handle; every array handed out references it, so the file stays mapped while in use"""
+
+    def __init__(self, lib, handle):
+        self.lib = lib
+        self.handle = handle
+
+    def __del__(self):
+        if self.handle:
+            self.lib.runfile_close(self.handle)
+            self.handle = None
+
+
+class RunReader:
+    """
+    Random access to a run file through the native reader: seeks to a time
+    range with the block index and returns read-only NumPy views of the
+    requested metric columns, touching only the blocks that overlap
+    """
+
+    def __init__(self, path, build_dir="build"):
+        lib = _load_reader_library(build_dir)
+        handle = ctypes.c_void_p()
+        _check(lib.runfile_open(os.fsencode(path), ctypes.byref(handle)), f"Opening {path}")
+        self._mapping = _Mapping(lib, handle)
+        self.lib = lib
+        self.path = path
+        info = RunFileInfo()
+        _check(lib.runfile_get_info(handle, ctypes.byref(info)), "Reading run info")
+        self.rows = info.rows
+        self.blocks = info.blocks
+        self.time_range = (info.first_time, info.last_time) if info.blocks else None
+        self.header = json.loads(ctypes.string_at(lib.runfile_header(handle), info.header_length))
+        self.metrics = self.header['metrics']
+        self.manifest = self.header.get('manifest', {})
+        if info.blocks and info.columns != len(self.metrics) + 1:
+            raise ValueError(f"{path}: blocks have {info.columns} columns for {len(self.metrics)} metrics")
+
+    def close(self):
+        """Drop the reader's handle; the file stays mapped while views from it are alive"""
+        self._mapping = None
+
+    @property
+    def meta(self):
+        """Metadata trailer (results, events, ...), parsed on each access"""
+        data, length = ctypes.c_void_p(), ctypes.c_uint64()
+        _check(self.lib.runfile_meta(self._mapping.handle, ctypes.byref(data), ctypes.byref(length)),
+               "Reading run metadata")
+        return json.loads(ctypes.string_at(data, length.value))
+
+    def block(self, i):
+        """(timestamps, {metric: values}) of one whole block as zero-copy views"""
+        return (self._view(i, 0),
+                {m: self._view(i, c) for c, m in enumerate(self.metrics, start=1)})
+
+    def _view(self, block, column, lo=0, hi=None):
+        data = ctypes.POINTER(ctypes.c_double)()
+        rows = ctypes.c_uint64()
+        _check(self.lib.runfile_column(self._mapping.handle, block, column, ctypes.byref(data), ctypes.byref(rows)),
+               f"Reading block {block}")
+        hi = rows.value if hi is None else hi
+        if hi <= lo:
+            return np.empty(0)
+        buffer = (ctypes.c_double * (hi - lo)).from_address(ctypes.addressof(data.contents) + lo * 8)
+        buffer._mapping = self._mapping
+        array = np.frombuffer(buffer, dtype=np.float64)
+        array.flags.writeable = False
+        return array
+
+    def read(self, start=-math.inf, end=math.inf, metrics=None):
+        """
+        Samples with start <= timestamp <= end, one segment per overlapping block
+        Returns: list of (timestamps, {metric: values}) zero-copy views
+        """
+        columns = [(m, self.metrics.index(m) + 1) for m in (metrics or self.metrics)]
+        first, last = ctypes.c_uint32(), ctypes.c_uint32()
+        rc = self.lib.runfile_seek(self._mapping.handle, start, end, ctypes.byref(first), ctypes.byref(last))
+        if rc == -errno.ENOENT:
+            return []
+        _check(rc, "Seeking run file")
+        segments = []
+        lo, hi = ctypes.c_uint64(), ctypes.c_uint64()
+        for block in range(first.value, last.value + 1):
+            _check(self.lib.runfile_block_rows(self._mapping.handle, block, start, end,
+                                               ctypes.byref(lo), ctypes.byref(hi)), f"Seeking block {block}")
+            if hi.value > lo.value:
+                segments.append((self._view(block, 0, lo.value, hi.value),
+                                 {m: self._view(block, c, lo.value, hi.value) for m, c in columns}))
+        return segments
+
+    def read_range(self, start=-math.inf, end=math.inf, metrics=None):
+        """
+        Like read() but as single arrays: a view when the range lies in one
+        block, a concatenated copy when it spans several
+        Returns: (timestamps, {metric: values})
+        """
+        segments = self.read(start, end, metrics)
+        names = metrics or self.metrics
+        if len(segments) == 1:
+            return segments[0]
+        if not segments:
+            return np.empty(0), {m: np.empty(0) for m in names}
+        return (np.concatenate([t for t, _ in segments]),
+                {m: np.concatenate([c[m] for _, c in segments]) for m in names})
+
+
+class RunFile:
+    """
+    Whole-run reader for report and analytics: the native RunReader when
+    libhoststress.so is built, otherwise the Python fallback over the same
+    layout. Blocks come back as zero-copy views; format errors raise ValueError
+    """
+
+    def __init__(self, path, build_dir="build"):
+        self.path = path
+        try:
+            self._reader = RunReader(path, build_dir)
+        except FileNotFoundError:
+            if not os.path.exists(path):
+                raise
+            self._reader = _PyRunReader(path)
+        except OSError as e:
+            if e.errno != errno.EINVAL:
+                raise
+            raise ValueError(f"{path}: truncated or corrupt run file") from e
+        self.header = self._reader.header
+        self.metrics = self._reader.metrics
+        self.manifest = self._reader.manifest
+        self.rows = self._reader.rows
+        self.block_count = self._reader.blocks
+        self._meta = None
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+    def close(self):
+        self._reader.close()
+
+    @property
+    def meta(self):
+        if self._meta is None:
+            self._meta = self._reader.meta
+        return self._meta
+
+    def time_range(self):
+        return self._reader.time_range
+
+    def block(self, i):
+        """(timestamps, {metric: values}) of block i"""
+        return self._reader.block(i)
+
+    def blocks(self):
+        """Yield (timestamps, {metric: values}) per block"""
+        for i in range(self.block_count):
+            yield self.block(i)
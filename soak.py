@@ -0,0 +1,97 @@
+"""
+Checkpoints for long-duration soak runs
+A checkpoint records the run's arguments, its position in the scenario,
+the monitor's running totals and the stressor results (including latency
+histograms) so the run can resume after the host restarts
+Each resume starts a new segment; results from earlier segments are carried
+in the checkpoint and merged with the new ones, so the run's summary covers
+every segment
+"""
+
+import json
+import os
+import time
+
+CHECKPOINT_VERSION = 2
+# Stressors that fold their checkpointed results back in themselves on resume
+CUMULATIVE_RESULTS = ('sched_latency',)
+# Per-segment series that are concatenated across segments
+SEGMENT_SERIES = ('points', 'rounds')
+
+
+def spill_path(checkpoint_path):
+    """JSON-lines file holding the samples spilled from memory at each checkpoint"""
+    return checkpoint_path + '.samples.jsonl'
+
+
+def write_checkpoint(path, args, position, monitor_state, results):
+    """
+    Atomically replace the checkpoint at path (write, fsync, rename)
+    position: {'segment': 1-based segment number, 'elapsed_s': seconds of the
+    scenario completed, counted on the monotonic clock of each segment}
+    """
+    state = {
+        'version': CHECKPOINT_VERSION,
+        'saved_at': time.time(),
+        'position': position,
+        'args': args,
+        'monitor': monitor_state,
+        'results': results,
+    }
+    tmp_path = path + '.tmp'
+    with open(tmp_path, 'w') as f:
+        json.dump(state, f)
+        f.flush()
+        os.fsync(f.fileno())
+    os.replace(tmp_path, path)
+    directory = os.open(os.path.dirname(os.path.abspath(path)), os.O_RDONLY)
+    try:
+        os.fsync(directory)
+    finally:
+        os.close(directory)
+
+
+def load_checkpoint(path):
+    """Read a checkpoint written by write_checkpoint; ValueError if it is from another version"""
+    with open(path) as f:
+        state = json.load(f)
+    if state.get('version') != CHECKPOINT_VERSION:
+        raise ValueError(f"{path}: unsupported checkpoint version {state.get('version')}")
+    return state
+
+
+def merge_segment(before, now):
+    """
+    Combine one stressor's result from earlier segments with the current
+    segment's: SEGMENT_SERIES lists are concatenated (disk rounds keep counting),
+    scalar fields come from the current segment and the summary lists every
+    segment's own summary
+    """
+    merged = dict(now)
+    for key in SEGMENT_SERIES:
+        if isinstance(before.get(key), list) and isinstance(now.get(key), list):
+            offset = len(before[key])
+            merged[key] = before[key] + [dict(item, round=item['round'] + offset)
+                                         if key == 'rounds' and isinstance(item, dict) and 'round' in item else item
+                                         for item in now[key]]
+    summaries = before.get('segment_summaries') or [before.get('summary', '')]
+    merged['segment_summaries'] = summaries + [now.get('summary', '')]
+    merged['summary'] = '; '.join(f"segment {i + 1}: {text}"
+                                  for i, text in enumerate(merged['segment_summaries']))
+    return merged
+
+
+def merge_results(carried, current):
+    """
+    Results for the whole run: carried (from the checkpoint, all earlier
+    segments) merged with current (this segment); CUMULATIVE_RESULTS already
+    include the earlier segments and are taken as they are
+    """
+    merged = dict(carried)
+    for name, now in current.items():
+        before = carried.get(name)
+        if name in CUMULATIVE_RESULTS or not isinstance(before, dict) or not isinstance(now, dict):
+            merged[name] = now
+        else:
+            merged[name] = merge_segment(before, now)
+    return merged
@@ -0,0 +1,283 @@
+"""
+Disk benchmarking helpers for SSD stress
+Target file/device management with fallocate preallocation, SNIA PTS-style
+preconditioning (sequential fill, then random overwrite), timed random-write
+measurement rounds and steady-state detection
+"""
+
+import ctypes
+import errno
+import fcntl
+import os
+import random
+import stat
+import struct
+import time
+
+DEFAULT_IO_SIZE = 4096
+STEADY_STATE_WINDOW = 5
+MAX_DATA_EXCURSION = 0.20   # max - min within the window, relative to its average
+MAX_SLOPE_EXCURSION = 0.10  # excursion of the least-squares fit, relative to its average
+BLKSSZGET = 0x1268          # ioctl: logical block size of a block device
+
+
+def open_direct(path, flags):
+    """Open with O_DIRECT so writes reach the device, falling back where unsupported (e.g. tmpfs)"""
+    try:
+        return os.open(path, flags | getattr(os, 'O_DIRECT', 0), 0o644), True
+    except OSError:
+        return os.open(path, flags, 0o644), False
+
+
+try:
+    _libc = ctypes.CDLL(None, use_errno=True)
+    _fallocate = _libc.fallocate
+    _fallocate.argtypes = [ctypes.c_int, ctypes.c_int, ctypes.c_longlong, ctypes.c_longlong]
+    _fallocate.restype = ctypes.c_int
+except (OSError, AttributeError):
+    _fallocate = None
+
+
+def _queue_block_size(dev, sys_dev='/sys/dev/block'):
+    """queue/logical_block_size of device number dev (a partition reads its disk's queue), or None"""
+    base = os.path.join(sys_dev, f'{os.major(dev)}:{os.minor(dev)}')
+    for queue in (os.path.join(base, 'queue'), os.path.join(base, '..', 'queue')):
+        try:
+            with open(os.path.join(queue, 'logical_block_size')) as f:
+                return int(f.read())
+        except (OSError, ValueError):
+            continue
+    return None
+
+
+def logical_block_size(path, sys_dev='/sys/dev/block'):
+    """
+    Granularity O_DIRECT writes to path must respect: the logical block size
+    of a block device (BLKSSZGET), otherwise that of the device backing the
+    file or, if it does not exist yet, its directory. Filesystems without a
+    backing block device (NFS, tmpfs, ...) fall back to 512 bytes; st_blksize
+    is the preferred I/O size there, not an alignment
+    """
+    if not os.path.exists(path):
+        path = os.path.dirname(os.path.abspath(path))
+    st = os.stat(path)
+    if stat.S_ISBLK(st.st_mode):
+        try:
+            fd = os.open(path, os.O_RDONLY)
+            try:
+                return struct.unpack('i', fcntl.ioctl(fd, BLKSSZGET, struct.pack('i', 0)))[0]
+            finally:
+                os.close(fd)
+        except OSError:
+            return _queue_block_size(st.st_rdev, sys_dev) or 512
+    return _queue_block_size(st.st_dev, sys_dev) or 512
+
+
+def check_io_size(path, io_size, payload_block_size):
+    """
+    Raise ValueError unless io_size can be written to path with O_DIRECT
+    (a multiple of its logical block size, which keeps slices of the
+    page-aligned payload buffer aligned too) and evenly splits payload blocks
+    """
+    block = logical_block_size(path)
+    if io_size <= 0 or io_size % block:
+        raise ValueError(f"I/O size {io_size} is not a multiple of the {block}-byte logical block size of {path}")
+    if payload_block_size % io_size:
+        raise ValueError(f"I/O size {io_size} does not evenly divide the {payload_block_size}-byte payload block")
+
+
+class DiskTarget:
+    """An open disk stress target: a regular file or a raw block device"""
+
+    def __init__(self, fd, path, size_bytes, direct, raw_device, reused):
+        self.fd = fd
+        self.path = path
+        self.size_bytes = size_bytes
+        self.direct = direct
+        self.raw_device = raw_device
+        self.reused = reused
+
+    def close(self):
+        os.close(self.fd)
+
+
+def preallocate(fd, size_bytes):
+    """
+    Reserve size_bytes without writing them
+    Uses fallocate(2) directly (glibc's posix_fallocate emulates by writing
+    every block) and falls back to a sparse ftruncate. Returns True if the
+    blocks were actually reserved
+    """
+    if _fallocate is not None and _fallocate(fd, 0, 0, size_bytes) == 0:
+        return True
+    err = ctypes.get_errno() if _fallocate is not None else errno.EOPNOTSUPP
+    if err not in (errno.EOPNOTSUPP, errno.ENOSYS, errno.EINVAL):
+        raise OSError(err, f"fallocate failed: {os.strerror(err)}")
+    os.ftruncate(fd, size_bytes)
+    return False
+
+
+def _device_numbers(path):
+    """st_rdev of a block device, or None for anything else"""
+    try:
+        st = os.stat(path)
+    except OSError:
+        return None
+    return st.st_rdev if stat.S_ISBLK(st.st_mode) else None
+
+
+def _partitions(name, sys_block='/sys/class/block'):
+    """Partition names of a whole-disk block device (e.g. sda -> sda1, sda2)"""
+    try:
+        entries = os.listdir(os.path.join(sys_block, name))
+    except OSError:
+        return []
+    return [e for e in entries if os.path.exists(os.path.join(sys_block, name, e, 'partition'))]
+
+
+def device_in_use(device, sys_block='/sys/class/block', proc='/proc'):
+    """
+    Why writing to a block device would destroy live data, or None if it
+    looks free: the device or one of its partitions is mounted, active swap,
+    or held by another block device (LVM/dm, md RAID, bcache)
+    """
+    name = os.path.basename(os.path.realpath(device))
+    names = [name] + _partitions(name, sys_block)
+    for part in names:
+        try:
+            holders = os.listdir(os.path.join(sys_block, part, 'holders'))
+        except OSError:
+            holders = []
+        if holders:
+            return f"/dev/{part} is held by {', '.join(sorted(holders))}"
+    numbers = {n for n in (_device_numbers(os.path.join('/dev', part)) for part in names) if n is not None}
+    paths = {os.path.realpath(os.path.join('/dev', part)) for part in names}
+    for table, label in (('mounts', 'mounted'), ('swaps', 'active swap')):
+        try:
+            with open(os.path.join(proc, table)) as f:
+                sources = [line.split()[0] for line in f if line.startswith('/')]
+        except OSError:
+            continue
+        for source in sources:
+            if os.path.realpath(source) in paths or _device_numbers(source) in numbers:
+                return f"{source} is {label}"
+    return None
+
+
+def open_target(path, size_bytes, confirm_raw_device=None):
+    """
+    Open (creating or reusing) a disk stress target
+    Regular files are preallocated so random I/O can start immediately; an
+    existing file at least size_bytes long is reused as-is (size_bytes=0 means
+    the whole existing file or device). Raw block devices
+    are destroyed by the stress, so they are only opened when confirm_raw_device
+    names the same device and neither it nor any partition is mounted, swap or
+    held by another device; the exclusive open keeps it claimed while in use
+    """
+    raw_device = os.path.exists(path) and stat.S_ISBLK(os.stat(path).st_mode)
+    if raw_device:
+        if confirm_raw_device is None or os.path.realpath(confirm_raw_device) != os.path.realpath(path):
+            raise PermissionError(
+                f"{path} is a block device; its contents will be destroyed. "
+                f"Pass --disk-confirm-raw-device {path} to proceed."
+            )
+        reason = device_in_use(path)
+        if reason:
+            raise PermissionError(f"{reason}; refusing to write to {path}")
+        # O_EXCL claims the device: EBUSY if it or a partition is claimed by anything we missed
+        try:
+            fd, direct = open_direct(path, os.O_RDWR | os.O_EXCL)
+        except OSError as e:
+            if e.errno == errno.EBUSY:
+                raise PermissionError(f"{path} or one of its partitions is in use; refusing to write to it") from e
+            raise
+        device_size = os.lseek(fd, 0, os.SEEK_END)
+        size = min(size_bytes, device_size) if size_bytes else device_size
+        return DiskTarget(fd, path, size, direct, raw_device=True, reused=True)
+
+    fd, direct = open_direct(path, os.O_RDWR | os.O_CREAT)
+    existing_size = os.fstat(fd).st_size
+    size_bytes = size_bytes or existing_size
+    reused = existing_size >= size_bytes
+    if not reused:
+        preallocate(fd, size_bytes)
+    return DiskTarget(fd, path, size_bytes, direct, raw_device=False, reused=reused)
+
+
+def sequential_fill(fd, size_bytes, generator):
+    """Write the whole region once in generator-sized blocks"""
+    offset = 0
+    while offset < size_bytes:
+        block = generator.next_block()
+        length = min(len(block), size_bytes - offset)
+        offset += os.pwrite(fd, block[:length], offset)
+
+
+class RandomWriter:
+    """Issues io_size-aligned random writes over a region from payload blocks"""
+
+    def __init__(self, fd, size_bytes, generator, io_size=DEFAULT_IO_SIZE):
+        if generator.block_size % io_size:
+            raise ValueError("Payload block size must be a multiple of the I/O size")
+        self.fd = fd
+        self.io_size = io_size
+        self.slots = size_bytes // io_size
+        if self.slots == 0:
+            raise ValueError("Region is smaller than one I/O")
+        self.generator = generator
+        self._block = None
+        self._offset = self.generator.block_size
+
+    def write(self, count):
+        """Issue count random writes"""
+        io_size = self.io_size
+        for _ in range(count):
+            if self._offset >= self.generator.block_size:
+                self._block = self.generator.next_block()
+                self._offset = 0
+            os.pwrite(self.fd, self._block[self._offset:self._offset + io_size],
+                      random.randrange(self.slots) * io_size)
+            self._offset += io_size
+
+    def run_round(self, seconds):
+        """Write randomly for the given time, returning (ios, elapsed seconds)"""
+        ios = 0
+        start = time.perf_counter()
+        deadline = start + seconds
+        while time.perf_counter() < deadline:
+            self.write(64)
+            ios += 64
+        return ios, time.perf_counter() - start
+
+
+def random_overwrite(writer, size_bytes, passes=1.0):
+    """Overwrite the region randomly until passes x capacity has been written"""
+    remaining = int(size_bytes * passes) // writer.io_size
+    while remaining > 0:
+        batch = min(remaining, 4096)
+        writer.write(batch)
+        remaining -= batch
+
+
+def detect_steady_state(values, window=STEADY_STATE_WINDOW,
+                        max_excursion=MAX_DATA_EXCURSION,
+                        max_slope_excursion=MAX_SLOPE_EXCURSION):
+    """
+    SNIA PTS steady-state check over the last `window` rounds
+    Returns the window average once both the data excursion and the
+    least-squares slope excursion are within limits, otherwise None
+    """
+    if len(values) < window:
+        return None
+    tail = values[-window:]
+    average = sum(tail) / window
+    if average <= 0:
+        return None
+    if max(tail) - min(tail) > max_excursion * average:
+        return None
+    mean_x = (window - 1) / 2.0
+    slope = (sum((x - mean_x) * (y - average) for x, y in enumerate(tail)) /
+             sum((x - mean_x) ** 2 for x in range(window)))
+    if abs(slope) * (window - 1) > max_slope_excursion * average:
+        return None
+    return average
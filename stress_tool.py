@@ -3,6 +3,8 @@ Hardware Stress Tool (MVP)
 
 Usage Example:
     python stress_tool.py --cpu 4 --memory 2GB --disk 5GB --duration 60
+    python stress_tool.py report run.hsrun -o run.html
+    python stress_tool.py analytics runs/ --group-by cpu_model,kernel
 
 Features:
 - CPU, Memory, Disk stress
@@ -16,8 +18,12 @@ import time
 import os
 import sys
 import signal
-from stressors import burn_cpu, burn_memory, burn_disk, burn_network, burn_gpu
+import stat
+from stressors import burn_cpu, burn_memory, burn_disk, burn_network, burn_gpu, bench_ipc, bench_sched_latency, bench_sync, bench_syscalls, bench_roofline, bench_loaded_latency, bench_prefetch_streams, bench_memcpy, bench_page_faults, bench_mixed_precision, bench_math, bench_spmv, bench_stencil, bench_radix_join
 from monitoring import Monitor
+from storage import check_io_size
+from payloads import DEFAULT_BLOCK_SIZE, PAYLOAD_MODES
+from soak import CUMULATIVE_RESULTS, load_checkpoint, merge_results, spill_path, write_checkpoint
 import tempfile
 
 def parse_size(size_str):
@@ -34,6 +40,15 @@ def parse_size(size_str):
         return int(float(size_str))  # Assume GB
 
 def main():
+    if len(sys.argv) > 1 and sys.argv[1] == 'report':
+        from report import main as report_main
+        report_main(sys.argv[2:])
+        return
+    if len(sys.argv) > 1 and sys.argv[1] == 'analytics':
+        from analytics import main as analytics_main
+        analytics_main(sys.argv[2:])
+        return
+
     parser = argparse.ArgumentParser(description="Hardware Stress Tool")
     parser.add_argument('--cpu', type=int, default=0, help='Number of CPU stress workers')
     parser.add_argument('--memory', type=str, default='0', help='Memory to allocate (e.g., 2GB)')
@@ -41,32 +56,120 @@ def main():
     parser.add_argument('--duration', type=int, default=60, help='Duration in seconds')
     parser.add_argument('--monitor-interval', type=int, default=2, help='Monitoring interval (sec)')
     parser.add_argument('--network-url', type=str, default=None, help='URL to download repeatedly for network stress')
+    parser.add_argument('--network-upload', action='store_true', help='Upload payload blocks to --network-url instead of downloading')
+    parser.add_argument('--payload', type=str, default='random', choices=PAYLOAD_MODES, help='Payload written by disk and network upload stress')
+    parser.add_argument('--compress-ratio', type=float, default=0.5, help='Compressible fraction of each sector for --payload compressible (0.0-1.0)')
+    parser.add_argument('--disk-target', type=str, default=None, help='Named disk target file (kept and reused across runs) or raw block device')
+    parser.add_argument('--disk-confirm-raw-device', type=str, default=None, help='Repeat the block device path to confirm destroying its contents')
+    parser.add_argument('--disk-precondition', action='store_true', help='Precondition the disk target (sequential fill + random overwrite) before measuring')
+    parser.add_argument('--disk-io-size', type=int, default=4096, help='Random write size in bytes for disk stress')
+    parser.add_argument('--disk-round-seconds', type=int, default=5, help='Length of each disk measurement round for steady-state detection')
+    parser.add_argument('--ipc', action='store_true', help='Run the same-host IPC benchmark (requires make host)')
+    parser.add_argument('--sched-latency', action='store_true', help='Measure scheduler wake-up latency per CPU while stressing (requires make host)')
+    parser.add_argument('--sched-latency-interval', type=int, default=1000, help='Wake-up interval in microseconds for --sched-latency')
+    parser.add_argument('--sched-latency-priority', type=int, default=95, help='SCHED_FIFO priority for --sched-latency threads (0 disables RT)')
+    parser.add_argument('--sync', action='store_true', help='Run the lock contention stressor (requires make host)')
+    parser.add_argument('--sync-threads', type=int, default=None, help='Contending threads for --sync (default: 2x CPUs)')
+    parser.add_argument('--sync-cs-ns', type=int, default=100, help='Critical section length in nanoseconds for --sync')
+    parser.add_argument('--syscalls', action='store_true', help='Run the syscall-overhead microbenchmarks (requires make host)')
+    parser.add_argument('--roofline', action='store_true', help='Sweep arithmetic intensity and fit roofline ceilings on the CPU, and the GPU with --gpu (requires make host)')
+    parser.add_argument('--loaded-latency', action='store_true', help='Measure memory latency on one core while the others generate bandwidth load (requires make host)')
+    parser.add_argument('--loaded-latency-ratios', type=str, default='1:0,2:1,1:1', help='Comma-separated read:write ratios of the load threads for --loaded-latency')
+    parser.add_argument('--loaded-latency-delays', type=str, default=None, help='Comma-separated injection delays in ns for --loaded-latency (default: 0 to 10000)')
+    parser.add_argument('--prefetch-streams', action='store_true', help='Sweep concurrent sequential streams per thread to find prefetcher limits (requires make host)')
+    parser.add_argument('--prefetch-streams-threads', type=int, default=1, help='Threads for --prefetch-streams (0 = all CPUs)')
+    parser.add_argument('--memcpy', action='store_true', help='Compare host copy implementations across sizes and alignments (requires make host)')
+    parser.add_argument('--page-faults', action='store_true', help='Measure first-touch page-fault throughput across threads, 4 KB vs THP and populate modes (requires make host)')
+    parser.add_argument('--mixed-precision', action='store_true', help='FP64/FP32/BF16/INT8 GEMM-kernel compute stress with the best ISA per precision (requires make host)')
+    parser.add_argument('--mixed-precision-types', type=str, default='fp64,fp32,bf16,int8', help='Comma-separated precisions for --mixed-precision')
+    parser.add_argument('--math', action='store_true', help='Compare exp/log/sin/cos/sqrt throughput and ULP error of libm and SIMD polynomials (requires make host)')
+    parser.add_argument('--spmv', action='store_true', help='Sparse matrix-vector benchmark: CSR/ELL/SELL-C-sigma over banded, power-law and random matrices (requires make host)')
+    parser.add_argument('--stencil', action='store_true', help='2D/3D Jacobi stencil sweeps with SIMD, spatial tiling and temporal blocking (requires make host)')
+    parser.add_argument('--stencil-time-block', type=int, default=4, help='Time steps per wavefront block for --stencil')
+    parser.add_argument('--radix-join', action='store_true', help='Multithreaded radix sort and hash join build/probe across data sizes (requires make host)')
     parser.add_argument('--gpu', action='store_true', help='Enable GPU stress (requires pycuda)')
     parser.add_argument('--export-csv', type=str, default=None, help='Export monitoring log to CSV file')
     parser.add_argument('--export-json', type=str, default=None, help='Export monitoring log to JSON file')
+    parser.add_argument('--export-bin', type=str, default=None, help='Export monitoring log in the binary run format (.hsrun)')
     parser.add_argument('--live-graph', action='store_true', help='Show live matplotlib graph of system usage')
+    parser.add_argument('--checkpoint', type=str, default=None, help='Soak mode: periodically checkpoint progress, statistics and histograms to this file')
+    parser.add_argument('--checkpoint-interval', type=int, default=300, help='Seconds between soak checkpoints')
+    parser.add_argument('--resume', action='store_true', help='Resume the run recorded in --checkpoint (e.g. after a reboot)')
     args = parser.parse_args()
 
+    checkpoint = None
+    if args.resume:
+        if not args.checkpoint:
+            parser.error('--resume requires --checkpoint')
+        checkpoint = load_checkpoint(args.checkpoint)
+        # The checkpointed scenario becomes the defaults; options given now still win
+        parser.set_defaults(**checkpoint['args'])
+        args = parser.parse_args()
+
     cpu_workers = args.cpu
     mem_gb = parse_size(args.memory)
     disk_gb = parse_size(args.disk)
+    if not 0.0 <= args.compress_ratio <= 1.0:
+        parser.error(f"--compress-ratio must be between 0.0 and 1.0, got {args.compress_ratio}")
+    if args.disk_target and disk_gb <= 0:
+        # Without --disk the size comes from the target itself, so it has to exist already
+        target = args.disk_target
+        if not ((os.path.isfile(target) and os.path.getsize(target) > 0) or
+                (os.path.exists(target) and stat.S_ISBLK(os.stat(target).st_mode))):
+            parser.error(f"--disk-target {target} is not an existing file or block device; give its size with --disk")
+    if disk_gb > 0 or args.disk_target:
+        # A misaligned O_DIRECT size would fail every write; refuse it up front
+        try:
+            check_io_size(args.disk_target or tempfile.gettempdir(), args.disk_io_size, DEFAULT_BLOCK_SIZE)
+        except (ValueError, OSError) as e:
+            parser.error(f"--disk-io-size: {e}")
     duration = args.duration
     monitor_interval = args.monitor_interval
+    elapsed_before = 0.0
+    segment = 1
+    if checkpoint:
+        elapsed_before = checkpoint['position']['elapsed_s']
+        segment = checkpoint['position']['segment'] + 1
+        duration = max(0, int(args.duration - elapsed_before))
+        print(f"[INFO] Resuming run from {args.checkpoint} at {elapsed_before:.0f}s of {args.duration}s "
+              f"(segment {segment})")
 
     print(f"[INFO] Starting stress test: CPU={cpu_workers}, Memory={mem_gb}GB, Disk={disk_gb}GB, Duration={duration}s, Network={args.network_url is not None}, GPU={args.gpu}")
 
     stop_event = threading.Event()
     processes = []
+    manager = multiprocessing.Manager()
+    results = manager.dict()
     temp_disk_file = None
 
-    monitor = Monitor(interval=monitor_interval)
+    monitor = Monitor(interval=monitor_interval, spill_path=spill_path(args.checkpoint) if args.checkpoint else None)
+    # Results of earlier segments; the new segment's are merged into them
+    carried = checkpoint['results'] if checkpoint else {}
+    if checkpoint:
+        results.update({name: r for name, r in carried.items() if name in CUMULATIVE_RESULTS})
+        monitor.restore_state(checkpoint['monitor'], gap_seconds=time.time() - checkpoint['saved_at'])
+    segment_start = time.monotonic()
+
+    def save_checkpoint():
+        if not args.checkpoint or stop_event.is_set():
+            return
+        with monitor.instrumentation.scope('checkpoint'):
+            position = {'segment': segment, 'elapsed_s': elapsed_before + time.monotonic() - segment_start}
+            write_checkpoint(args.checkpoint, {k: v for k, v in vars(args).items() if k != 'resume'},
+                             position, monitor.checkpoint_state(), merge_results(carried, results.copy()))
 
     def cleanup():
+        if stop_event.is_set():
+            return
         monitor.stop()
         stop_event.set()
-        for p in processes:
-            if p.is_alive():
-                p.terminate()
+        with monitor.instrumentation.scope('scheduler'):
+            for p in processes:
+                if p.is_alive():
+                    p.terminate()
+        with monitor.instrumentation.scope('results_merge'):
+            monitor.add_results(merge_results(carried, results.copy()))
+        manager.shutdown()
         if temp_disk_file and os.path.exists(temp_disk_file):
             try:
                 os.remove(temp_disk_file)
@@ -76,43 +179,145 @@ def main():
 
     def signal_handler(sig, frame):
         print("\n[INFO] Caught signal, exiting...")
+        save_checkpoint()
         cleanup()
         sys.exit(0)
 
+    # Start workers, timing the tool's own scheduling cost
+    with monitor.instrumentation.scope('scheduler'):
+        # Start CPU stress
+        for _ in range(cpu_workers):
+            p = multiprocessing.Process(target=burn_cpu)
+            p.start()
+            processes.append(p)
+
+        # Start Memory stress
+        if mem_gb > 0:
+            p = multiprocessing.Process(target=burn_memory, args=(mem_gb,))
+            p.start()
+            processes.append(p)
+
+        # Start Disk stress
+        if disk_gb > 0 or args.disk_target:
+            if args.disk_target:
+                disk_path = args.disk_target
+            else:
+                disk_path = temp_disk_file = os.path.join(tempfile.gettempdir(), f"stress_disk_{os.getpid()}.bin")
+            p = multiprocessing.Process(target=burn_disk, args=(disk_path, disk_gb, args.payload, args.compress_ratio,
+                                                             args.disk_precondition, args.disk_io_size,
+                                                             args.disk_round_seconds, results,
+                                                             args.disk_confirm_raw_device))
+            p.start()
+            processes.append(p)
+
+        # Start Network stress
+        if args.network_url:
+            network_payload = args.payload if args.network_upload else None
+            p = multiprocessing.Process(target=burn_network, args=(args.network_url, duration, network_payload, args.compress_ratio))
+            p.start()
+            processes.append(p)
+
+        # Start IPC benchmark
+        if args.ipc:
+            p = multiprocessing.Process(target=bench_ipc, args=(duration, results))
+            p.start()
+            processes.append(p)
+
+        # Start scheduler latency measurement
+        if args.sched_latency:
+            p = multiprocessing.Process(target=bench_sched_latency,
+                                        args=(duration, results, args.sched_latency_interval,
+                                              args.sched_latency_priority))
+            p.start()
+            processes.append(p)
+
+        # Start lock contention stress
+        if args.sync:
+            p = multiprocessing.Process(target=bench_sync, args=(duration, results, args.sync_threads, args.sync_cs_ns))
+            p.start()
+            processes.append(p)
+
+        # Start syscall microbenchmarks
+        if args.syscalls:
+            p = multiprocessing.Process(target=bench_syscalls, args=(duration, results))
+            p.start()
+            processes.append(p)
+
+        # Start roofline sweep
+        if args.roofline:
+            p = multiprocessing.Process(target=bench_roofline, args=(duration, results, args.gpu))
+            p.start()
+            processes.append(p)
+
+        # Start loaded-latency curve
+        if args.loaded_latency:
+            ratios = [r.strip() for r in args.loaded_latency_ratios.split(',') if r.strip()]
+            delays = ([int(d) for d in args.loaded_latency_delays.split(',')]
+                      if args.loaded_latency_delays else None)
+            p = multiprocessing.Process(target=bench_loaded_latency, args=(duration, results, ratios, delays))
+            p.start()
+            processes.append(p)
+
+        # Start prefetcher stream-limit sweep
+        if args.prefetch_streams:
+            p = multiprocessing.Process(target=bench_prefetch_streams,
+                                        args=(duration, results, args.prefetch_streams_threads))
+            p.start()
+            processes.append(p)
+
+        # Start memcpy comparison
+        if args.memcpy:
+            p = multiprocessing.Process(target=bench_memcpy, args=(duration, results))
+            p.start()
+            processes.append(p)
+
+        # Start page-fault throughput sweep
+        if args.page_faults:
+            p = multiprocessing.Process(target=bench_page_faults, args=(duration, results))
+            p.start()
+            processes.append(p)
+
+        # Start mixed-precision compute stress
+        if args.mixed_precision:
+            precisions = [p.strip() for p in args.mixed_precision_types.split(',') if p.strip()]
+            p = multiprocessing.Process(target=bench_mixed_precision, args=(duration, results, precisions))
+            p.start()
+            processes.append(p)
+
+        # Start transcendental math comparison
+        if args.math:
+            p = multiprocessing.Process(target=bench_math, args=(duration, results))
+            p.start()
+            processes.append(p)
+
+        # Start sparse matrix-vector benchmark
+        if args.spmv:
+            p = multiprocessing.Process(target=bench_spmv, args=(duration, results))
+            p.start()
+            processes.append(p)
+
+        # Start stencil sweeps
+        if args.stencil:
+            p = multiprocessing.Process(target=bench_stencil, args=(duration, results, args.stencil_time_block))
+            p.start()
+            processes.append(p)
+
+        # Start radix sort and hash join workloads
+        if args.radix_join:
+            p = multiprocessing.Process(target=bench_radix_join, args=(duration, results))
+            p.start()
+            processes.append(p)
+
+        # Start GPU stress
+        if args.gpu:
+            p = multiprocessing.Process(target=burn_gpu, args=(duration,))
+            p.start()
+            processes.append(p)
+
+    # Install handlers only after forking so terminated workers don't run the parent's cleanup
     signal.signal(signal.SIGINT, signal_handler)
     signal.signal(signal.SIGTERM, signal_handler)
 
-    # Start CPU stress
-    for _ in range(cpu_workers):
-        p = multiprocessing.Process(target=burn_cpu)
-        p.start()
-        processes.append(p)
-
-    # Start Memory stress
-    if mem_gb > 0:
-        p = multiprocessing.Process(target=burn_memory, args=(mem_gb,))
-        p.start()
-        processes.append(p)
-
-    # Start Disk stress
-    if disk_gb > 0:
-        temp_disk_file = os.path.join(tempfile.gettempdir(), f"stress_disk_{os.getpid()}.bin")
-        p = multiprocessing.Process(target=burn_disk, args=(temp_disk_file, disk_gb))
-        p.start()
-        processes.append(p)
-
-    # Start Network stress
-    if args.network_url:
-        p = multiprocessing.Process(target=burn_network, args=(args.network_url, duration))
-        p.start()
-        processes.append(p)
-
-    # Start GPU stress
-    if args.gpu:
-        p = multiprocessing.Process(target=burn_gpu, args=(duration,))
-        p.start()
-        processes.append(p)
-
     # Start monitoring
     monitor.start()
 
@@ -121,12 +326,18 @@ def main():
         graph_thread = threading.Thread(target=monitor.live_graph, daemon=True)
         graph_thread.start()
 
-    # Wait for duration
+    # Wait for duration, checkpointing along the way in soak mode
     try:
-        time.sleep(duration)
+        while True:
+            remaining = duration - (time.monotonic() - segment_start)
+            if remaining <= 0:
+                break
+            time.sleep(min(remaining, args.checkpoint_interval) if args.checkpoint else remaining)
+            save_checkpoint()
     except KeyboardInterrupt:
         print("\n[INFO] Interrupted by user.")
     finally:
+        save_checkpoint()
         cleanup()
         if args.export_csv:
             monitor.export_csv(args.export_csv)
@@ -134,6 +345,9 @@ def main():
         if args.export_json:
             monitor.export_json(args.export_json)
             print(f"[INFO] Monitoring log exported to {args.export_json}")
+        if args.export_bin:
+            monitor.export_bin(args.export_bin)
+            print(f"[INFO] Monitoring log exported to {args.export_bin}")
         monitor.print_summary()
 
 if __name__ == "__main__":
@@ -1,7 +1,11 @@
+import errno
 import time
 import os
 import tempfile
 import requests
+from payloads import PayloadGenerator
+from storage import (DEFAULT_IO_SIZE, RandomWriter, detect_steady_state, open_target,
+                     random_overwrite, sequential_fill)
 try:
     import pycuda.autoinit
     import pycuda.driver as cuda
@@ -27,26 +31,555 @@ def burn_memory(size_gb):
         while True:
             time.sleep(1)
 
-def burn_disk(path, size_gb):
+def burn_disk(path, size_gb, payload='random', compress_ratio=0.5, precondition=False,
+              io_size=DEFAULT_IO_SIZE, round_seconds=5, results=None, confirm_raw_device=None):
+    """
+    Disk stress: preallocate (or reuse) the target, optionally precondition it,
+    then issue random writes in timed rounds until steady state is detected
+    The per-round IOPS series and steady-state IOPS are published to results['disk']
+    """
     try:
-        with open(path, 'wb') as f:
-            for _ in range(size_gb):
-                f.write(b'0' * 1024 * 1024 * 1024)  # Write 1GB at a time
-        while True:
-            time.sleep(1)
+        generator = PayloadGenerator(payload, compress_ratio=compress_ratio)
+        target = open_target(path, size_gb * 1024 * 1024 * 1024, confirm_raw_device)
+        fd, size_bytes, direct = target.fd, target.size_bytes, target.direct
+        try:
+            writer = RandomWriter(fd, size_bytes, generator, io_size)
+            print(f"[DISK] Target {path}: {size_bytes / 1024**3:.1f}GB, "
+                  f"{'raw device' if target.raw_device else 'reused' if target.reused else 'preallocated'}, "
+                  f"O_DIRECT={direct}")
+            if precondition:
+                print("[DISK] Preconditioning: sequential fill...")
+                sequential_fill(fd, size_bytes, generator)
+                print("[DISK] Preconditioning: random overwrite of full capacity...")
+                random_overwrite(writer, size_bytes)
+
+            rounds = []
+            steady_iops = None
+            while True:
+                ios, elapsed = writer.run_round(round_seconds)
+                iops = ios / elapsed
+                rounds.append({'round': len(rounds) + 1, 'iops': iops,
+                               'mb_s': iops * io_size / (1024 * 1024)})
+                if steady_iops is None:
+                    steady_iops = detect_steady_state([r['iops'] for r in rounds])
+                    if steady_iops is not None:
+                        print(f"[DISK] Steady state reached after {len(rounds)} rounds: {steady_iops:.0f} IOPS")
+                if results is not None:
+                    summary = (f"steady state {steady_iops:.0f} IOPS" if steady_iops is not None
+                               else f"steady state not reached, last round {iops:.0f} IOPS")
+                    results['disk'] = {
+                        'target': path,
+                        'size_bytes': size_bytes,
+                        'io_size': io_size,
+                        'direct': direct,
+                        'preconditioned': precondition,
+                        'round_seconds': round_seconds,
+                        'rounds': rounds,
+                        'burst_iops': rounds[0]['iops'],
+                        'steady_state_iops': steady_iops,
+                        'summary': f"{summary} ({len(rounds)} x {round_seconds}s rounds of {io_size}B random writes)",
+                    }
+        finally:
+            target.close()
     except Exception as e:
         print(f"[!] Disk stress error: {e}")
+        if results is not None:
+            # Keep any rounds measured before the failure
+            disk = dict(results.get('disk') or {'target': path, 'io_size': io_size})
+            rounds = len(disk.get('rounds', []))
+            disk['error'] = str(e)
+            disk['summary'] = f"failed after {rounds} rounds: {e}" if rounds else f"failed: {e}"
+            results['disk'] = disk
         while True:
             time.sleep(1)
 
-def burn_network(url, duration):
+def burn_network(url, duration, payload=None, compress_ratio=0.5):
+    """Download from url repeatedly, or upload payload blocks when a payload mode is given"""
+    try:
+        generator = PayloadGenerator(payload, compress_ratio=compress_ratio) if payload else None
+    except ValueError as e:
+        print(f"[!] Network stress error: {e}")
+        return
     end_time = time.time() + duration
     while time.time() < end_time:
         try:
-            requests.get(url)
+            if generator:
+                requests.post(url, data=generator.next_block().tobytes())
+            else:
+                requests.get(url)
         except Exception:
             pass
 
+def bench_ipc(duration, results=None):
+    """Same-host IPC benchmark (pipes, UNIX sockets, shared-memory ring) using native C++ code"""
+    try:
+        from host_benchmark import HostBenchmark, IPC_MESSAGE_SIZES, IPC_TRANSPORTS
+        benchmark = HostBenchmark()
+        placements = benchmark.ipc_placements()
+        npoints = len(IPC_TRANSPORTS) * len(IPC_MESSAGE_SIZES) * len(placements)
+        print("[IPC] Running IPC benchmark...")
+        points = benchmark.sweep_ipc(placements=placements,
+                                     seconds_per_point=max(0.1, duration * 0.9 / npoints))
+        for p in points:
+            print(f"[IPC] {p['transport']:>11} {p['msg_size']:>6}B {p['placement']:>10}: "
+                  f"{p['bandwidth_mb_s']:9.1f} MB/s, RTT p50={p['rtt_p50_ns'] / 1000:.1f}us "
+                  f"p99={p['rtt_p99_ns'] / 1000:.1f}us")
+        if results is not None:
+            fastest = max(points, key=lambda p: p['bandwidth_mb_s'])
+            lowest = min(points, key=lambda p: p['rtt_p50_ns'])
+            results['ipc'] = {
+                'points': points,
+                'summary': (f"peak {fastest['bandwidth_mb_s']:.0f} MB/s ({fastest['transport']}, "
+                            f"{fastest['msg_size']}B), lowest RTT p50 {lowest['rtt_p50_ns'] / 1000:.1f}us "
+                            f"({lowest['transport']}, {lowest['msg_size']}B)"),
+            }
+    except Exception as e:
+        print(f"[!] IPC benchmark error: {e}")
+
+def bench_sync(duration, results=None, threads=None, cs_ns=100):
+    """Lock contention stress across mutex, spinlock, rwlock, futex and condvar using native C++ code"""
+    try:
+        from host_benchmark import HostBenchmark, SYNC_LOCKS
+        benchmark = HostBenchmark()
+        threads = threads or max(2, 2 * os.cpu_count())
+        print(f"[SYNC] Running lock contention with {threads} threads, {cs_ns}ns critical sections...")
+        locks = {}
+        for lock in SYNC_LOCKS:
+            stats = benchmark.benchmark_sync(lock, threads, cs_ns=cs_ns,
+                                             seconds=max(0.2, duration * 0.9 / len(SYNC_LOCKS)))
+            print(f"[SYNC] {lock:>8}: {stats['acquisitions_per_sec'] / 1e6:.2f}M acq/s, "
+                  f"fairness={stats['fairness_jain']:.3f} (share {stats['min_share']:.1%}-{stats['max_share']:.1%}), "
+                  f"hand-off p50={stats['handoff_p50_ns']:.0f}ns p99={stats['handoff_p99_ns']:.0f}ns")
+            locks[lock] = stats
+        if results is not None:
+            fastest = max(locks, key=lambda l: locks[l]['acquisitions_per_sec'])
+            fairest = max(locks, key=lambda l: locks[l]['fairness_jain'])
+            results['sync'] = {
+                'threads': threads,
+                'cs_ns': cs_ns,
+                'locks': locks,
+                'summary': (f"fastest {fastest} {locks[fastest]['acquisitions_per_sec'] / 1e6:.2f}M acq/s, "
+                            f"fairest {fairest} (Jain {locks[fairest]['fairness_jain']:.3f}), {threads} threads"),
+            }
+    except Exception as e:
+        print(f"[!] Sync contention error: {e}")
+
+def bench_syscalls(duration, results=None):
+    """Syscall-overhead microbenchmark suite (ns per call) using native C++ code"""
+    try:
+        from host_benchmark import HostBenchmark, kernel_info
+        benchmark = HostBenchmark()
+        info = kernel_info()
+        info['timing'] = benchmark.timing_info()
+        source = (f"TSC @ {info['timing']['tsc_ghz']:.3f} GHz" if info['timing']['using_tsc']
+                  else "clock_gettime (no invariant TSC)")
+        print(f"[SYSCALL] Timing syscalls on kernel {info['kernel']} with {source}...")
+        timings = benchmark.benchmark_syscalls()
+        for name, t in timings.items():
+            print(f"[SYSCALL] {name:>14}: {t['ns_per_call_median']:8.1f} ns/call (min {t['ns_per_call_min']:.1f})")
+        if results is not None:
+            results['syscalls'] = dict(info, timings=timings, summary=(
+                f"getpid {timings['getpid']['ns_per_call_median']:.0f}ns, "
+                f"clock_gettime {timings['clock_gettime']['ns_per_call_median']:.0f}ns, "
+                f"page fault {timings['page_fault']['ns_per_call_median']:.0f}ns (kernel {info['kernel']})"))
+    except Exception as e:
+        print(f"[!] Syscall benchmark error: {e}")
+
+def bench_sched_latency(duration, results=None, interval_us=1000, priority=95):
+    """Cyclictest-style scheduler wake-up latency, measured while the other stressors run"""
+    try:
+        from host_benchmark import HostBenchmark, histogram_percentile, merge_sched_latency, unpack_sched_latency
+        from instrumentation import Instrumentation
+        benchmark = HostBenchmark()
+        instrumentation = Instrumentation()
+        print(f"[SCHED] Measuring wake-up latency every {interval_us}us on all CPUs...")
+        per_cpu = {}
+        if results is not None and 'sched_latency' in results:
+            # Resumed soak run: keep accumulating into the checkpointed histograms
+            per_cpu = unpack_sched_latency(results['sched_latency']['per_cpu'])
+        end_time = time.time() + duration
+        # Measure in short chunks so results survive the worker being terminated at the end
+        while time.time() < end_time:
+            chunk = benchmark.benchmark_sched_latency(min(1.0, end_time - time.time()),
+                                                      interval_us=interval_us, priority=priority)
+            with instrumentation.scope('histogram_merge'):
+                merge_sched_latency(per_cpu, chunk)
+            if results is None or not per_cpu:
+                continue
+            with instrumentation.scope('histogram_export'):
+                exported = {}
+                for cpu, stats in per_cpu.items():
+                    histogram = stats['histogram']
+                    exported[str(cpu)] = dict(
+                        {k: v for k, v in stats.items() if k != 'histogram'},
+                        p99_ns=histogram_percentile(histogram, 0.99),
+                        p9999_ns=histogram_percentile(histogram, 0.9999),
+                        histogram_us={str(i): n for i, n in enumerate(histogram) if n},
+                    )
+            worst = max(exported.values(), key=lambda s: s['max_ns'])
+            realtime = all(s['realtime'] for s in exported.values())
+            results['sched_latency'] = {
+                'interval_us': interval_us,
+                'priority': priority if realtime else 0,
+                'per_cpu': exported,
+                'summary': (f"max {worst['max_ns'] / 1000:.1f}us, worst-CPU p99 "
+                            f"{max(s['p99_ns'] for s in exported.values()) / 1000:.0f}us over "
+                            f"{len(exported)} CPUs ({'SCHED_FIFO' if realtime else 'SCHED_OTHER, no RT privilege'})"),
+                'overhead': instrumentation.report()['scopes'],
+            }
+    except Exception as e:
+        print(f"[!] Scheduler latency error: {e}")
+
+def bench_roofline(duration, results=None, gpu=False):
+    """Roofline sweep of arithmetic intensity on the CPU (native C++) and, with gpu=True, the GPU"""
+    try:
+        from host_benchmark import HostBenchmark, ROOFLINE_INTENSITIES, fit_roofline
+        benchmark = HostBenchmark()
+        gpu_benchmark = None
+        if gpu and HAS_PYCUDA:
+            try:
+                from gpu_benchmark import GPUBenchmark
+                gpu_benchmark = GPUBenchmark()
+            except Exception as e:
+                print(f"[!] GPU roofline error: {e}")
+        backends = 2 if gpu_benchmark else 1
+        # Leave headroom for buffer setup at each point
+        seconds_per_point = max(0.1, min(1.0, duration * 0.6 / (backends * len(ROOFLINE_INTENSITIES))))
+        threads = len(os.sched_getaffinity(0))
+        print(f"[ROOFLINE] Sweeping {ROOFLINE_INTENSITIES[0]:g}-{ROOFLINE_INTENSITIES[-1]:g} FLOP/byte "
+              f"on {threads} CPUs...")
+        points = {'cpu': []}
+        sweeps = [('cpu', lambda i: benchmark.benchmark_roofline([i], threads=threads,
+                                                                 seconds_per_point=seconds_per_point))]
+        if gpu_benchmark:
+            points['gpu'] = []
+            sweeps.append(('gpu', lambda i: gpu_benchmark.benchmark_roofline([i], seconds_per_point=seconds_per_point)))
+        for backend, run_point in sweeps:
+            for intensity in ROOFLINE_INTENSITIES:
+                for p in run_point(intensity):
+                    print(f"[ROOFLINE] {backend} {p['intensity']:>8g} FLOP/B: {p['gflops']:9.2f} GFLOPS, "
+                          f"{p['gb_s']:7.2f} GB/s")
+                    points[backend].append(p)
+                # Publish after every point so a sweep cut short by the run ending still reports
+                if results is not None and points['cpu']:
+                    fits = {b: fit_roofline(pts) for b, pts in points.items() if pts}
+                    results['roofline'] = dict(fits, threads=threads, summary=', '.join(
+                        f"{b} {fit['bandwidth_gb_s']:.1f} GB/s, {fit['peak_gflops']:.1f} GFLOPS, "
+                        f"ridge {fit['ridge_intensity']:.2g} FLOP/B" for b, fit in fits.items()))
+        for backend, pts in points.items():
+            fit = fit_roofline(pts)
+            print(f"[ROOFLINE] {backend}: {fit['bandwidth_gb_s']:.1f} GB/s, {fit['peak_gflops']:.1f} GFLOPS, "
+                  f"ridge at {fit['ridge_intensity']:.2g} FLOP/byte")
+    except Exception as e:
+        print(f"[!] Roofline benchmark error: {e}")
+
+def bench_loaded_latency(duration, results=None, ratios=None, delays=None):
+    """Memory latency on one core against the bandwidth generated by the others (loaded-latency curve)"""
+    try:
+        from host_benchmark import HostBenchmark, LOADED_LATENCY_DELAYS_NS, LOADED_LATENCY_RATIOS
+        benchmark = HostBenchmark()
+        ratios = ratios or list(LOADED_LATENCY_RATIOS)
+        delays = sorted(delays or LOADED_LATENCY_DELAYS_NS)
+        probe_cpu, load_cpus = benchmark.loaded_latency_cpus()
+        plan = [('idle', None)]
+        if load_cpus:
+            plan += [(ratio, delay) for ratio in ratios for delay in delays]
+        else:
+            print("[LOADED] Only one CPU available: measuring idle latency without load threads")
+        # Leave headroom for building the pointer chase at each point
+        seconds_per_point = max(0.2, min(2.0, duration * 0.5 / len(plan)))
+        print(f"[LOADED] Probing latency on CPU {probe_cpu} with {len(load_cpus)} load threads...")
+        print(f"[LOADED] {'ratio':>5} {'delay ns':>9} {'latency ns':>11} {'GB/s':>8}")
+        points = []
+        for ratio, delay in plan:
+            if ratio == 'idle':
+                point = benchmark.benchmark_loaded_latency(load_cpus=[], seconds=seconds_per_point)
+            else:
+                point = benchmark.benchmark_loaded_latency(ratio, delay, seconds=seconds_per_point)
+            point.update(ratio=ratio, delay_ns=delay)
+            points.append(point)
+            print(f"[LOADED] {ratio:>5} {'' if delay is None else delay:>9} {point['latency_ns']:11.1f} "
+                  f"{point['bandwidth_gb_s']:8.2f}")
+            if results is not None:
+                idle = points[0]['latency_ns']
+                loaded = [p for p in points if p['ratio'] != 'idle']
+                summary = f"idle {idle:.0f}ns"
+                if loaded:
+                    peak = max(loaded, key=lambda p: p['bandwidth_gb_s'])
+                    summary += (f", {peak['latency_ns']:.0f}ns at peak {peak['bandwidth_gb_s']:.1f} GB/s "
+                                f"({peak['ratio']})")
+                results['loaded_latency'] = {'probe_cpu': probe_cpu, 'load_cpus': load_cpus,
+                                             'points': points, 'summary': summary}
+    except Exception as e:
+        print(f"[!] Loaded latency error: {e}")
+
+def bench_prefetch_streams(duration, results=None, threads=1):
+    """Bandwidth per number of concurrent sequential streams per thread, for each read/write mix"""
+    try:
+        from host_benchmark import HostBenchmark, PREFETCH_STREAM_COUNTS, PREFETCH_STREAM_MIXES, stream_limits
+        benchmark = HostBenchmark()
+        threads = threads or len(os.sched_getaffinity(0))
+        npoints = len(PREFETCH_STREAM_COUNTS) * len(PREFETCH_STREAM_MIXES)
+        seconds_per_point = max(0.1, min(1.0, duration * 0.6 / npoints))
+        print(f"[STREAMS] Sweeping 1-{PREFETCH_STREAM_COUNTS[-1]} streams per thread on {threads} threads...")
+        points = []
+        for mix in PREFETCH_STREAM_MIXES:
+            for streams in PREFETCH_STREAM_COUNTS:
+                point = benchmark.benchmark_streams(streams, mix, threads, seconds=seconds_per_point)
+                point.update({'streams': streams, 'mix': mix, 'threads': threads})
+                points.append(point)
+                print(f"[STREAMS] {mix:>4} {streams:>3} streams: {point['gb_s']:7.2f} GB/s "
+                      f"({point['gb_s_per_stream']:.2f} GB/s per stream)")
+                if results is not None:
+                    limits = stream_limits(points)
+                    results['prefetch_streams'] = {
+                        'threads': threads, 'points': points, 'limits': limits,
+                        'summary': ', '.join(
+                            f"{m} peak {l['peak_gb_s']:.1f} GB/s at {l['peak_streams']} streams"
+                            + (f", drops from {l['limit_streams']}" if l['limit_streams'] else '')
+                            for m, l in limits.items()),
+                    }
+        for mix, limit in stream_limits(points).items():
+            print(f"[STREAMS] {mix}: peak {limit['peak_gb_s']:.2f} GB/s at {limit['peak_streams']} streams, "
+                  f"{'drops below 90% at ' + str(limit['limit_streams']) if limit['limit_streams'] else 'no drop'}")
+    except Exception as e:
+        print(f"[!] Prefetch stream benchmark error: {e}")
+
+def bench_memcpy(duration, results=None):
+    """Host copy implementations (libc, rep movsb, AVX2/AVX-512, non-temporal) across sizes and alignments"""
+    try:
+        from host_benchmark import HostBenchmark, MEMCPY_ALIGNMENTS, MEMCPY_SIZES, memcpy_crossovers
+        benchmark = HostBenchmark()
+        features = benchmark.memcpy_features()
+        impls = benchmark.memcpy_impls()
+        npoints = len(impls) * len(MEMCPY_SIZES) * len(MEMCPY_ALIGNMENTS)
+        seconds_per_point = max(0.01, min(0.2, duration * 0.5 / npoints))
+        print(f"[MEMCPY] Comparing {', '.join(impls)} "
+              f"({', '.join(name for name, present in features.items() if present) or 'no extensions'})...")
+        points = []
+        for alignment in MEMCPY_ALIGNMENTS:
+            for size in MEMCPY_SIZES:
+                row = []
+                for impl in impls:
+                    point = benchmark.benchmark_memcpy(impl, size, alignment, seconds_per_point)
+                    point.update({'impl': impl, 'size': size, 'alignment': alignment})
+                    points.append(point)
+                    row.append(f"{impl} {point['gb_s']:.1f}")
+                print(f"[MEMCPY] {alignment:>7} {size:>9}B: {', '.join(row)} GB/s")
+                if results is not None:
+                    crossovers = memcpy_crossovers(points)
+                    aligned = crossovers.get('aligned', {}).get('crossovers', [])
+                    results['memcpy'] = {
+                        'features': features, 'points': points, 'crossovers': crossovers,
+                        'summary': ('aligned crossovers: ' + ', '.join(
+                            f"{c['from']}->{c['to']} at {c['size']}B" for c in aligned)) if aligned
+                        else 'no crossovers (one implementation fastest at every size)',
+                    }
+        for alignment, entry in memcpy_crossovers(points).items():
+            for c in entry['crossovers']:
+                print(f"[MEMCPY] {alignment}: {c['to']} overtakes {c['from']} at {c['size']}B")
+    except Exception as e:
+        print(f"[!] memcpy benchmark error: {e}")
+
+def bench_page_faults(duration, results=None):
+    """First-touch page-fault throughput across thread counts, 4 KB vs THP and populate modes"""
+    try:
+        from host_benchmark import (HostBenchmark, PAGE_FAULT_MODES, PAGE_FAULT_PAGES, kernel_info,
+                                    page_fault_scaling, thp_setting)
+        benchmark = HostBenchmark()
+        thread_counts = benchmark.page_fault_threads()
+        npoints = len(PAGE_FAULT_MODES) * len(PAGE_FAULT_PAGES) * len(thread_counts)
+        seconds_per_point = max(0.1, min(1.0, duration * 0.6 / npoints))
+        info = {'kernel': kernel_info()['kernel'], 'thp': thp_setting()}
+        print(f"[FAULTS] Faulting in fresh memory with 1-{thread_counts[-1]} threads "
+              f"(kernel {info['kernel']}, THP {info['thp']})...")
+        points = []
+        for mode in PAGE_FAULT_MODES:
+            for page in PAGE_FAULT_PAGES:
+                swept = benchmark.sweep_page_faults([mode], [page], thread_counts, seconds_per_point)
+                for point in swept:
+                    print(f"[FAULTS] {mode:>13} {page:>3} {point['threads']:>3} threads: {point['gb_s']:7.2f} GB/s, "
+                          f"{point['faults_per_sec'] / 1e6:6.2f}M faults/s, {point['ns_per_fault']:8.0f} ns/fault")
+                if len(swept) < len(thread_counts):
+                    print(f"[FAULTS] {mode}/{page}: stopped after {len(swept)} of {len(thread_counts)} thread counts "
+                          f"(not supported or out of memory)")
+                points.extend(swept)
+                if results is not None:
+                    scaling = page_fault_scaling(points)
+                    touch = scaling.get('touch/4k')
+                    summary = (f"4k first touch {touch['gb_s_1']:.2f} GB/s on 1 thread, {touch['gb_s_n']:.2f} "
+                               f"GB/s on {touch['threads']} ({touch['efficiency'] * 100:.0f}% scaling), "
+                               f"THP {info['thp']}" if touch else f"no 4k first-touch baseline, THP {info['thp']}")
+                    results['page_faults'] = dict(info, points=points, scaling=scaling, summary=summary)
+    except Exception as e:
+        print(f"[!] Page fault benchmark error: {e}")
+
+def bench_mixed_precision(duration, results=None, precisions=None):
+    """FP64/FP32/BF16/INT8 GEMM-kernel compute stress on all CPUs with the best ISA per precision"""
+    try:
+        from host_benchmark import HostBenchmark, MIXED_PRECISIONS
+        benchmark = HostBenchmark()
+        precisions = precisions or list(MIXED_PRECISIONS)
+        # Rotate through the precisions for the whole run, keeping each one's best round
+        seconds_per_round = max(0.2, min(5.0, duration / (2 * len(precisions))))
+        print(f"[MIXED] Rotating {', '.join(precisions)} GEMM kernels on all CPUs...")
+        best = {}
+        end_time = time.time() + duration
+        while time.time() < end_time:
+            for precision in precisions:
+                point = benchmark.benchmark_mixed_precision(precision, seconds=seconds_per_round)
+                unit = 'TOPS' if precision == 'int8' else 'TFLOPS'
+                if precision not in best or point['gops'] > best[precision]['gops']:
+                    best[precision] = point
+                    print(f"[MIXED] {precision:>4} ({point['isa']}): {point['tops']:.3f} {unit}")
+                if results is not None:
+                    results['mixed_precision'] = {
+                        'precisions': best,
+                        'summary': ', '.join(f"{p} {r['tops']:.2f} {'TOPS' if p == 'int8' else 'TFLOPS'} "
+                                             f"({r['isa']})" for p, r in best.items()),
+                    }
+    except Exception as e:
+        print(f"[!] Mixed-precision stress error: {e}")
+
+def bench_math(duration, results=None):
+    """exp/log/sin/cos/sqrt throughput and ULP error: scalar libm vs SIMD polynomials per ISA"""
+    try:
+        from host_benchmark import HostBenchmark, MATH_FUNCTIONS, MATH_IMPLS
+        benchmark = HostBenchmark()
+        info = benchmark.math_build_info()
+        seconds_per_point = max(0.05, min(1.0, duration * 0.5 / (len(MATH_FUNCTIONS) * len(MATH_IMPLS))))
+        print(f"[MATH] Comparing libm and SIMD polynomials ({info['libc']}, {info['compiler']})...")
+        points = []
+        for function in MATH_FUNCTIONS:
+            row = []
+            for point in benchmark.sweep_math([function], seconds_per_point=seconds_per_point):
+                points.append(point)
+                row.append(f"{point['impl']} {point['gelem_s']:.2f} ({point['max_ulp']:.0f} ulp)")
+            print(f"[MATH] {function:>4}: {', '.join(row)} Gelem/s")
+            if results is not None:
+                best = {}
+                for p in points:
+                    if p['impl'] != 'libm' and (p['function'] not in best or p['gelem_s'] > best[p['function']]['gelem_s']):
+                        best[p['function']] = p
+                results['math'] = dict(info, points=points, summary=', '.join(
+                    f"{f} {p['speedup']:.1f}x libm ({p['impl']}, {p['max_ulp']:.0f} ulp)"
+                    for f, p in best.items() if p['speedup']))
+    except Exception as e:
+        print(f"[!] Math benchmark error: {e}")
+
+def bench_spmv(duration, results=None):
+    """CSR/ELL/SELL-C-sigma sparse matrix-vector product over banded, power-law and random matrices"""
+    try:
+        from host_benchmark import HostBenchmark, SPMV_FORMATS, SPMV_PATTERNS
+        from topology import Topology
+        benchmark = HostBenchmark()
+        cpus = benchmark.spmv_cpus()
+        nodes = len(Topology.from_sysfs().domains('node'))
+        # Matrix generation takes about a second per point on top of the timed part
+        seconds_per_point = max(0.2, min(2.0, duration * 0.3 / (len(SPMV_FORMATS) * len(SPMV_PATTERNS))))
+        print(f"[SPMV] y = Ax on {len(cpus)} threads over {nodes} NUMA node(s)...")
+        points = []
+        for pattern in SPMV_PATTERNS:
+            for fmt in SPMV_FORMATS:
+                variants = [True, False] if fmt == 'csr' and nodes > 1 else [True]
+                for numa_local in variants:
+                    try:
+                        point = benchmark.benchmark_spmv(fmt, pattern, numa_local=numa_local,
+                                                         seconds=seconds_per_point)
+                    except OSError as e:
+                        # Padded formats refuse matrices whose padding would blow up
+                        if e.errno != errno.E2BIG:
+                            raise
+                        print(f"[SPMV] {pattern:>9} {fmt:>4}: skipped ({e})")
+                        continue
+                    point.update({'format': fmt, 'pattern': pattern, 'numa_local': numa_local})
+                    points.append(point)
+                    print(f"[SPMV] {pattern:>9} {fmt:>4}{'' if numa_local else ' (no first touch)'}: "
+                          f"{point['gflops']:6.2f} GFLOPS, {point['gb_s']:6.2f} GB/s, fill {point['fill']:.2f}")
+                    if point['max_rel_error'] > 0:
+                        print(f"[SPMV] {pattern} {fmt}: result differs from serial CSR "
+                              f"(max relative error {point['max_rel_error']:.3g})")
+                    if results is not None:
+                        best = {}
+                        for p in points:
+                            if p['pattern'] not in best or p['gflops'] > best[p['pattern']]['gflops']:
+                                best[p['pattern']] = p
+                        results['spmv'] = {
+                            'points': points, 'nodes': nodes,
+                            'summary': ', '.join(f"{pat} {p['gflops']:.2f} GFLOPS ({p['format']}, {p['gb_s']:.1f} GB/s)"
+                                                 for pat, p in best.items()),
+                        }
+    except Exception as e:
+        print(f"[!] SpMV benchmark error: {e}")
+
+def bench_stencil(duration, results=None, time_block=4):
+    """2D 5-point and 3D 7/27-point Jacobi sweeps: scalar, SIMD, spatial tiling and temporal blocking"""
+    try:
+        from host_benchmark import HostBenchmark, STENCILS, STENCIL_VARIANTS
+        benchmark = HostBenchmark()
+        seconds_per_point = max(0.2, min(5.0, duration * 0.6 / (len(STENCILS) * len(STENCIL_VARIANTS))))
+        print(f"[STENCIL] Jacobi sweeps on {len(os.sched_getaffinity(0))} threads, "
+              f"temporal blocks of {time_block} steps...")
+        points = []
+        for stencil in STENCILS:
+            for variant in STENCIL_VARIANTS:
+                point = benchmark.sweep_stencil([stencil], [variant], time_block, seconds_per_point)[0]
+                points.append(point)
+                print(f"[STENCIL] {stencil:>4} {variant:>8}: {point['gcells_s']:6.3f} Gcells/s, "
+                      f"{point['gflops']:6.2f} GFLOPS, {point['gb_s']:6.1f} GB/s effective")
+                if point['max_abs_error'] > 0:
+                    print(f"[STENCIL] {stencil} {variant}: schedule differs from plain sweeps "
+                          f"(max error {point['max_abs_error']:.3g})")
+                if results is not None:
+                    best = {}
+                    for p in points:
+                        if p['stencil'] not in best or p['gcells_s'] > best[p['stencil']]['gcells_s']:
+                            best[p['stencil']] = p
+                    results['stencil'] = {
+                        'points': points, 'time_block': time_block,
+                        'summary': ', '.join(f"{s} {p['gcells_s']:.2f} Gcells/s ({p['variant']})"
+                                             for s, p in best.items()),
+                    }
+    except Exception as e:
+        print(f"[!] Stencil benchmark error: {e}")
+
+def bench_radix_join(duration, results=None):
+    """Multithreaded LSD radix sort and hash join build/probe across data sizes"""
+    try:
+        from host_benchmark import HostBenchmark, RADIX_SORT_SIZES, HASH_JOIN_SIZES
+        benchmark = HostBenchmark()
+        seconds_per_point = max(0.2, min(5.0, duration * 0.6 / (2 * (len(RADIX_SORT_SIZES) + len(HASH_JOIN_SIZES)))))
+        print(f"[RADIX-JOIN] Radix sort and hash join on {len(os.sched_getaffinity(0))} threads...")
+        points = []
+        runs = [([keys], []) for keys in RADIX_SORT_SIZES] + [([], [rows]) for rows in HASH_JOIN_SIZES]
+        for sort_sizes, join_sizes in runs:
+            for point in benchmark.sweep_radix_join(sort_sizes, join_sizes, seconds_per_point):
+                points.append(point)
+                if point['workload'] == 'sort':
+                    print(f"[RADIX-JOIN] sort {point['rows']:>9} keys {point['variant']:>11}: "
+                          f"{point['tuples_s'] / 1e6:7.1f} M keys/s, {point['gb_s']:5.1f} GB/s effective")
+                    if not point['sorted']:
+                        print(f"[RADIX-JOIN] sort {point['rows']} keys {point['variant']}: output not sorted")
+                else:
+                    print(f"[RADIX-JOIN] join {point['rows']:>9} rows {point['variant']:>11}: "
+                          f"{point['tuples_s'] / 1e6:7.1f} M tuples/s, "
+                          f"{point['partition_share'] * 100:4.1f}% partitioning")
+                    if not point['valid']:
+                        print(f"[RADIX-JOIN] join {point['rows']} rows {point['variant']}: wrong matches")
+            if results is not None:
+                best = {}
+                for p in points:
+                    key = (p['workload'], p['rows'])
+                    if key not in best or p['tuples_s'] > best[key]['tuples_s']:
+                        best[key] = p
+                results['radix_join'] = {
+                    'points': points,
+                    'summary': ', '.join(f"{w} {rows} {p['tuples_s'] / 1e6:.0f} M/s ({p['variant']})"
+                                         for (w, rows), p in best.items()),
+                }
+    except Exception as e:
+        print(f"[!] Radix sort / hash join benchmark error: {e}")
+
 def burn_gpu(duration):
     """GPU stress test using C++ CUDA kernels"""
     if not HAS_PYCUDA:
@@ -0,0 +1,83 @@
+"""
+Unit tests for multi-run analytics
+"""
+
+import unittest
+import sys
+import os
+import json
+import tempfile
+
+import numpy as np
+
+# Add parent directory to path
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+from analytics import Sketch, analyze, find_runs, summarize
+from runfile import RunWriter
+
+
+class TestSketch(unittest.TestCase):
+    """Mergeable relative-error quantile sketch"""
+
+    def test_quantiles_within_relative_error(self):
+        values = np.random.default_rng(1).lognormal(3, 1, 100000)
+        sketch = Sketch()
+        sketch.add(values)
+        for q in (0.5, 0.9, 0.99):
+            exact = np.quantile(values, q)
+            self.assertAlmostEqual(sketch.quantile(q) / exact, 1.0, delta=0.02)
+        self.assertEqual(sketch.max, values.max())
+
+    def test_merge_equals_single_pass(self):
+        values = np.random.default_rng(2).random(10000) * 100
+        whole, merged = Sketch(), Sketch()
+        whole.add(values)
+        for chunk in np.array_split(values, 4):
+            part = Sketch()
+            part.add(chunk)
+            merged.merge(part)
+        np.testing.assert_array_equal(whole.counts, merged.counts)
+        self.assertAlmostEqual(whole.mean, merged.mean)
+
+    def test_zero_and_nan(self):
+        sketch = Sketch()
+        sketch.add(np.array([0.0, 0.0, np.nan, 50.0]))
+        self.assertEqual(sketch.total, 3)
+        self.assertEqual(sketch.quantile(0.5), 0.0)
+
+
+class TestAnalyze(unittest.TestCase):
+    """Grouping binary and JSON exports by manifest"""
+
+    def test_group_by_manifest(self):
+        with tempfile.TemporaryDirectory() as tmp:
+            for i, model in enumerate(('Xeon', 'Xeon', 'EPYC')):
+                writer = RunWriter(os.path.join(tmp, f'run{i}.hsrun'), ['cpu'],
+                                   manifest={'cpu_model': model, 'kernel': '6.6'})
+                for t in range(100):
+                    writer.write(float(t), {'cpu': 10.0 if model == 'Xeon' else 90.0})
+                writer.close()
+            os.mkdir(os.path.join(tmp, 'old'))
+            with open(os.path.join(tmp, 'old', 'run.json'), 'w') as f:
+                json.dump({'manifest': {'cpu_model': 'EPYC', 'kernel': '6.6'},
+                           'samples': [{'time': '00:00:00', 'cpu': 90.0}, {'time': '00:00:02', 'cpu': None}]}, f)
+            with open(os.path.join(tmp, 'old', 'legacy.json'), 'w') as f:
+                json.dump([{'time': '00:00:00', 'cpu': 40.0}, {'time': '00:00:02', 'cpu': 60.0}], f, indent=2)
+            with open(os.path.join(tmp, 'notes.json'), 'w') as f:
+                f.write('not a run')
+
+            paths = find_runs(tmp)
+            self.assertEqual(len(paths), 6)
+            groups, errors = analyze(paths, ('cpu_model',), workers=2)
+            self.assertEqual(len(errors), 1)
+            self.assertEqual(groups[('?',)]['metrics']['cpu'].total, 2)
+            self.assertEqual(groups[('Xeon',)]['runs'], 2)
+            self.assertEqual(groups[('EPYC',)]['metrics']['cpu'].total, 101)
+            rows = summarize(groups, ('cpu_model',))
+            xeon = next(r for r in rows if r['cpu_model'] == 'Xeon')
+            self.assertAlmostEqual(xeon['p50'], 10.0, delta=0.2)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,293 @@
+"""
+Unit tests for native host benchmark module
+"""
+
+import unittest
+import sys
+import os
+import subprocess
+
+# Add parent directory to path
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+from host_benchmark import (HostBenchmark, IPC_TRANSPORTS, SYNC_LOCKS, SYSCALL_BENCHES,
+                            fit_roofline, hash_join_partition_bits, histogram_percentile, kernel_info,
+                            memcpy_crossovers, merge_sched_latency, page_fault_scaling, stream_limits)
+
+
+class TestHostBenchmark(unittest.TestCase):
+    """Unit tests for native host benchmarks"""
+
+    def setUp(self):
+        """Set up test fixtures"""
+        try:
+            self.benchmark = HostBenchmark()
+        except Exception as e:
+            self.skipTest(f"Failed to load native library: {e}")
+
+    def test_timing_info(self):
+        info = self.benchmark.timing_info()
+        self.assertGreater(info['ticks_overhead_ns'], 0.0)
+        self.assertLess(info['ticks_overhead_ns'], 1000.0)
+        if info['using_tsc']:
+            self.assertTrue(info['invariant_tsc'])
+            self.assertGreater(info['tsc_ghz'], 0.1)
+
+    def test_timing_fallback(self):
+        """HOSTSTRESS_NO_TSC forces the clock_gettime fallback in a fresh process"""
+        root = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+        code = "from host_benchmark import HostBenchmark; print(HostBenchmark().timing_info()['using_tsc'])"
+        env = dict(os.environ, HOSTSTRESS_NO_TSC='1')
+        output = subprocess.run([sys.executable, '-c', code], cwd=root, env=env,
+                                capture_output=True, text=True, check=True).stdout
+        self.assertEqual(output.strip(), 'False')
+
+    def test_ipc_all_transports(self):
+        """Every transport moves data and completes round trips"""
+        for transport in IPC_TRANSPORTS:
+            result = self.benchmark.benchmark_ipc(transport, 4096, seconds=0.1)
+            self.assertGreater(result['bandwidth_mb_s'], 0.0, transport)
+            self.assertGreater(result['round_trips'], 0, transport)
+            self.assertLessEqual(result['rtt_p50_ns'], result['rtt_p99_ns'], transport)
+
+    def test_ipc_dgram_size_limit(self):
+        """Oversized datagrams are rejected rather than truncated"""
+        with self.assertRaises(OSError):
+            self.benchmark.benchmark_ipc('unix_dgram', 1024 * 1024, seconds=0.1)
+
+    def test_ipc_sweep_tags_points(self):
+        points = self.benchmark.sweep_ipc(transports=['pipe'], sizes=[64],
+                                          placements={'unpinned': (-1, -1)},
+                                          seconds_per_point=0.1)
+        self.assertEqual(len(points), 1)
+        self.assertEqual(points[0]['transport'], 'pipe')
+        self.assertEqual(points[0]['placement'], 'unpinned')
+
+    def test_sched_latency_histogram(self):
+        """Every wake-up lands in exactly one histogram bucket"""
+        cpu = sorted(os.sched_getaffinity(0))[0]
+        per_cpu = self.benchmark.benchmark_sched_latency(0.2, cpus=[cpu], interval_us=1000, priority=0)
+        stats = per_cpu[cpu]
+        self.assertGreater(stats['samples'], 50)
+        self.assertEqual(sum(stats['histogram']), stats['samples'])
+        self.assertLessEqual(stats['min_ns'], stats['avg_ns'])
+        self.assertLessEqual(stats['avg_ns'], stats['max_ns'])
+
+        total = merge_sched_latency({}, per_cpu)
+        merge_sched_latency(total, per_cpu)
+        self.assertEqual(total[cpu]['samples'], 2 * stats['samples'])
+        self.assertEqual(sum(total[cpu]['histogram']), 2 * stats['samples'])
+
+    def test_sync_all_locks(self):
+        """Every lock type makes progress and per-thread counts add up"""
+        for lock in SYNC_LOCKS:
+            stats = self.benchmark.benchmark_sync(lock, 2, cs_ns=50, seconds=0.1)
+            self.assertGreater(stats['acquisitions_per_sec'], 0.0, lock)
+            self.assertEqual(sum(stats['per_thread']), stats['total_acquisitions'], lock)
+            self.assertGreater(stats['fairness_jain'], 0.0, lock)
+            self.assertLessEqual(stats['fairness_jain'], 1.0 + 1e-9, lock)
+
+    def test_sync_condvar_is_fair(self):
+        """The condition-variable token ring hands the lock to each thread in turn"""
+        stats = self.benchmark.benchmark_sync('condvar', 3, cs_ns=0, seconds=0.1)
+        self.assertLessEqual(max(stats['per_thread']) - min(stats['per_thread']), 1)
+
+    def test_syscall_timings(self):
+        """Every microbenchmark reports a plausible per-call cost"""
+        timings = self.benchmark.benchmark_syscalls(scale=0.01)
+        self.assertEqual(set(timings), set(SYSCALL_BENCHES))
+        for name, t in timings.items():
+            self.assertGreater(t['ns_per_call_min'], 0.0, name)
+            self.assertLessEqual(t['ns_per_call_min'], t['ns_per_call_median'], name)
+            self.assertLess(t['ns_per_call_median'], 1e6, name)
+            self.assertGreater(t['tsc_ghz'], 0.1, name)
+        # The vDSO path must not be slower than a real syscall round trip through a pipe
+        self.assertLess(timings['clock_gettime']['ns_per_call_median'],
+                        timings['pipe_rw']['ns_per_call_median'])
+
+    def test_roofline_sweep(self):
+        points = self.benchmark.benchmark_roofline([0.125, 1, 64], size_mb=16, threads=1, seconds_per_point=0.1)
+        self.assertEqual([p['intensity'] for p in points], [0.125, 1.0, 64.0])
+        for p in points:
+            self.assertAlmostEqual(p['gflops'] / p['gb_s'], p['intensity'], places=6)
+        # Longer chains per byte must buy more FLOPs per second
+        self.assertGreater(points[2]['gflops'], points[0]['gflops'])
+
+    def test_loaded_latency(self):
+        idle = self.benchmark.benchmark_loaded_latency(load_cpus=[], chase_mb=16, seconds=0.1)
+        self.assertGreater(idle['latency_ns'], 0.1)
+        self.assertEqual(idle['bandwidth_gb_s'], 0.0)
+        # One unpinned load thread writing every other line
+        loaded = self.benchmark.benchmark_loaded_latency('1:1', 0, load_cpus=[-1], chase_mb=16, load_mb=16,
+                                                         seconds=0.2)
+        self.assertGreater(loaded['read_gb_s'], 0.0)
+        self.assertAlmostEqual(loaded['read_gb_s'], loaded['write_gb_s'], delta=loaded['read_gb_s'] * 0.05)
+        with self.assertRaises(OSError):
+            self.benchmark.benchmark_loaded_latency('0:0', 0, load_cpus=[-1], seconds=0.1)
+
+    def test_stream_sweep(self):
+        points = self.benchmark.sweep_streams(counts=[1, 4], mixes=['read', 'rmw'], seconds_per_point=0.05)
+        self.assertEqual([(p['mix'], p['streams']) for p in points],
+                         [('read', 1), ('read', 4), ('rmw', 1), ('rmw', 4)])
+        for p in points:
+            self.assertGreater(p['read_gb_s'], 0.0)
+            self.assertEqual(p['write_gb_s'] > 0, p['mix'] == 'rmw')
+        # rmw writes back every stream it reads
+        self.assertAlmostEqual(points[3]['read_gb_s'], points[3]['write_gb_s'])
+
+    def test_memcpy_sweep(self):
+        impls = self.benchmark.memcpy_impls()
+        self.assertIn('libc', impls)
+        self.assertIn('rep_movsb', impls)
+        points = self.benchmark.sweep_memcpy(sizes=[256, 65536], alignments=['aligned', 'dst+1'],
+                                             seconds_per_point=0.005)
+        self.assertEqual(len(points), len(impls) * 4)
+        for p in points:
+            self.assertGreater(p['gb_s'], 0.0, p)
+            self.assertLessEqual(p['ns_per_copy_min'], p['ns_per_copy_median'], p)
+        if 'avx512' not in impls:
+            with self.assertRaises(OSError):
+                self.benchmark.benchmark_memcpy('avx512', 4096)
+
+    def test_page_fault_throughput(self):
+        touch = self.benchmark.benchmark_page_faults('touch', '4k', threads=1, mb_per_thread=8, seconds=0.05)
+        # Touching one byte per 4 KB page takes (at least) one fault per page
+        self.assertGreaterEqual(touch['faults'], touch['bytes'] // 4096)
+        self.assertGreater(touch['gb_s'], 0.0)
+        populated = self.benchmark.benchmark_page_faults('map_populate', '4k', threads=2, mb_per_thread=8,
+                                                         seconds=0.05)
+        self.assertGreater(populated['bytes'], 0)
+        with self.assertRaises(OSError):
+            self.benchmark.benchmark_page_faults('touch', '4k', mb_per_thread=0)
+
+    def test_mixed_precision_kernels(self):
+        for precision in ('fp64', 'fp32', 'bf16', 'int8'):
+            scalar = self.benchmark.benchmark_mixed_precision(precision, isa=0, threads=1, seconds=0.05)
+            self.assertEqual(scalar['max_rel_error'], 0.0, precision)
+            self.assertGreater(scalar['gops'], 0.0, precision)
+            best = self.benchmark.benchmark_mixed_precision(precision, threads=1, seconds=0.05)
+            self.assertEqual(best['max_rel_error'], 0.0, precision)
+            self.assertGreaterEqual(best['tier'], 0)
+        if self.benchmark.lib.mixed_precision_best_isa(2) < 2:
+            with self.assertRaises(OSError):
+                self.benchmark.benchmark_mixed_precision('bf16', isa=2, threads=1, seconds=0.05)
+
+    def test_math_accuracy(self):
+        points = self.benchmark.sweep_math(seconds_per_point=0.01)
+        self.assertEqual({p['function'] for p in points}, {'exp', 'log', 'sin', 'cos', 'sqrt'})
+        for p in points:
+            self.assertGreater(p['gelem_s'], 0.0, p)
+            self.assertLessEqual(p['max_ulp'], 4.0, p)
+            if p['impl'] == 'libm':
+                self.assertEqual(p['speedup'], 1.0)
+        with self.assertRaises(KeyError):
+            self.benchmark.benchmark_math('tan', 'libm')
+
+    def test_spmv_formats(self):
+        points = self.benchmark.sweep_spmv(rows=4096, nnz_per_row=8, cpus=[min(os.sched_getaffinity(0))] * 2,
+                                           seconds_per_point=0.01)
+        for p in points:
+            self.assertEqual(p['max_rel_error'], 0.0, p)
+            self.assertGreater(p['gflops'], 0.0, p)
+            self.assertGreaterEqual(p['fill'], 1.0, p)
+        banded = {p['format']: p for p in points if p['pattern'] == 'banded'}
+        self.assertEqual(set(banded), {'csr', 'ell', 'sell'})
+        self.assertEqual(banded['csr']['nnz'], 4096 * 8)
+        with self.assertRaises(OSError):
+            self.benchmark.benchmark_spmv('csr', 'banded', rows=4, seconds=0.01)
+
+    def test_stencil_schedules(self):
+        grids = {'2d5': (130, 66, 1), '3d7': (34, 34, 34), '3d27': (34, 34, 34)}
+        for stencil, grid in grids.items():
+            for point in self.benchmark.sweep_stencil([stencil], time_block=3, seconds_per_point=0.01, grid=grid,
+                                                      threads=2):
+                self.assertEqual(point['max_abs_error'], 0.0, point)
+                self.assertGreater(point['gcells_s'], 0.0, point)
+                self.assertGreaterEqual(point['steps'], point['time_block'])
+        with self.assertRaises(OSError):
+            self.benchmark.benchmark_stencil('3d7', grid=(34, 34, 2), seconds=0.01)
+
+    def test_radix_sort_and_hash_join(self):
+        points = self.benchmark.sweep_radix_join([1000, 1 << 14], [1000, 1 << 14], seconds_per_point=0.01,
+                                                 threads=3)
+        self.assertEqual(len(points), 8)
+        for point in points:
+            self.assertTrue(point['sorted'] if point['workload'] == 'sort' else point['valid'], point)
+            self.assertGreater(point['tuples_s'], 0.0, point)
+        joins = [p for p in points if p['workload'] == 'join']
+        self.assertEqual([p['partition_bits'] for p in joins], [0, 1, 0, 1])
+        self.assertTrue(all(p['matches'] == p['probe_rows'] for p in joins))
+        self.assertEqual(hash_join_partition_bits(1 << 22), 9)
+        with self.assertRaises(OSError):
+            self.benchmark.benchmark_hash_join(1000, partition_bits=20, seconds=0.01)
+
+    def test_kernel_info(self):
+        info = kernel_info()
+        self.assertTrue(info['kernel'])
+        self.assertIsInstance(info['mitigations'], dict)
+
+
+class TestHistogramPercentile(unittest.TestCase):
+    """Unit tests for histogram quantiles"""
+
+    def test_percentile_bucket_edges(self):
+        histogram = [0] * 100
+        histogram[2] = 98
+        histogram[50] = 2
+        self.assertEqual(histogram_percentile(histogram, 0.5, 1000), 3000.0)
+        self.assertEqual(histogram_percentile(histogram, 0.99, 1000), 51000.0)
+        self.assertEqual(histogram_percentile([0] * 10, 0.99, 1000), 0.0)
+
+
+class TestRooflineFit(unittest.TestCase):
+    """Unit tests for roofline ceilings"""
+
+    def test_ceilings_and_ridge(self):
+        points = [{'intensity': ai, 'gflops': min(100.0, ai * 20.0), 'gb_s': min(100.0, ai * 20.0) / ai}
+                  for ai in (0.25, 1, 4, 16, 64)]
+        fit = fit_roofline(points)
+        self.assertEqual(fit['bandwidth_gb_s'], 20.0)
+        self.assertEqual(fit['peak_gflops'], 100.0)
+        self.assertEqual(fit['ridge_intensity'], 5.0)
+        self.assertEqual([p['bound'] for p in fit['points']], ['memory'] * 3 + ['compute'] * 2)
+        self.assertTrue(all(p['efficiency'] == 1.0 for p in fit['points']))
+
+
+class TestStreamLimits(unittest.TestCase):
+    """Unit tests for prefetch stream-limit detection"""
+
+    def test_limit_after_peak(self):
+        curve = {1: 5.0, 2: 9.0, 4: 12.0, 8: 11.5, 16: 7.0, 32: 6.0}
+        points = [{'mix': 'read', 'streams': n, 'gb_s': g} for n, g in curve.items()]
+        points.append({'mix': 'rmw', 'streams': 1, 'gb_s': 3.0})
+        limits = stream_limits(points)
+        self.assertEqual(limits['read'], {'peak_streams': 4, 'peak_gb_s': 12.0, 'limit_streams': 16})
+        self.assertIsNone(limits['rmw']['limit_streams'])
+
+
+class TestMemcpyCrossovers(unittest.TestCase):
+    """Unit tests for copy crossover detection"""
+
+    def test_winner_changes(self):
+        speeds = {64: {'libc': 10, 'rep_movsb': 5}, 4096: {'libc': 50, 'rep_movsb': 60},
+                  1 << 20: {'libc': 20, 'rep_movsb': 25, 'nontemporal': 30}}
+        points = [{'alignment': 'aligned', 'size': size, 'impl': impl, 'gb_s': gb_s}
+                  for size, row in speeds.items() for impl, gb_s in row.items()]
+        result = memcpy_crossovers(points)['aligned']
+        self.assertEqual(result['winners'], [[64, 'libc'], [4096, 'rep_movsb'], [1 << 20, 'nontemporal']])
+        self.assertEqual(result['crossovers'], [{'size': 4096, 'from': 'libc', 'to': 'rep_movsb'},
+                                                {'size': 1 << 20, 'from': 'rep_movsb', 'to': 'nontemporal'}])
+
+
+class TestPageFaultScaling(unittest.TestCase):
+    """Unit tests for page-fault scaling efficiency"""
+
+    def test_efficiency(self):
+        points = [{'mode': 'touch', 'page': '4k', 'threads': t, 'gb_s': g} for t, g in ((1, 2.0), (2, 3.0), (4, 4.0))]
+        scaling = page_fault_scaling(points)['touch/4k']
+        self.assertEqual(scaling['threads'], 4)
+        self.assertEqual(scaling['efficiency'], 0.5)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,58 @@
+"""
+Unit tests for the tool's self-instrumentation
+"""
+
+import unittest
+import sys
+import os
+import time
+
+# Add parent directory to path
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+from instrumentation import Instrumentation
+
+
+class TestInstrumentation(unittest.TestCase):
+    """Unit tests for scoped timers and counters"""
+
+    def test_scope_accumulates(self):
+        instrumentation = Instrumentation()
+        for _ in range(3):
+            with instrumentation.scope('sampler'):
+                time.sleep(0.01)
+        scope = instrumentation.report()['scopes']['sampler']
+        self.assertEqual(scope['calls'], 3)
+        self.assertGreaterEqual(scope['wall_s'], 0.03)
+        self.assertGreaterEqual(scope['max_wall_s'], 0.01)
+        # Sleeping is wall time, not CPU time
+        self.assertLess(scope['cpu_s'], scope['wall_s'])
+
+    def test_scope_records_on_exception(self):
+        instrumentation = Instrumentation()
+        with self.assertRaises(ValueError):
+            with instrumentation.scope('export_json'):
+                raise ValueError('disk full')
+        self.assertEqual(instrumentation.scopes['export_json']['calls'], 1)
+
+    def test_merge_worker_scopes(self):
+        worker = Instrumentation()
+        with worker.scope('histogram_merge'):
+            pass
+        parent = Instrumentation()
+        parent.merge_scopes(worker.report()['scopes'], prefix='sched_latency.')
+        parent.merge_scopes(worker.report()['scopes'], prefix='sched_latency.')
+        self.assertEqual(parent.scopes['sched_latency.histogram_merge']['calls'], 2)
+
+    def test_report(self):
+        instrumentation = Instrumentation()
+        instrumentation.count('sampler_wakeups')
+        instrumentation.count('sampler_wakeups', 2)
+        report = instrumentation.report()
+        self.assertEqual(report['counters'], {'sampler_wakeups': 3})
+        for key in ('wall_s', 'cpu_s', 'cpu_percent', 'wakeups_per_sec', 'max_rss_kb'):
+            self.assertGreaterEqual(report[key], 0)
+
+
+if __name__ == '__main__':
+    unittest.main()
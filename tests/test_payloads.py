@@ -0,0 +1,62 @@
+"""
+Unit tests for disk/network payload generation
+"""
+
+import unittest
+import sys
+import os
+import zlib
+
+# Add parent directory to path
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+from payloads import PayloadGenerator, SECTOR_SIZE
+
+
+def compression_ratio(data):
+    return len(zlib.compress(data, 1)) / len(data)
+
+
+class TestPayloadGenerator(unittest.TestCase):
+    """Unit tests for payload modes"""
+
+    def test_zeros_are_compressible(self):
+        block = PayloadGenerator('zeros', block_size=64 * 1024).next_block().tobytes()
+        self.assertEqual(block, bytes(64 * 1024))
+
+    def test_pattern_repeats(self):
+        generator = PayloadGenerator('pattern', block_size=8192, pattern=b'\xaa\x55')
+        block = generator.next_block().tobytes()
+        self.assertEqual(block, b'\xaa\x55' * 4096)
+
+    def test_random_is_incompressible(self):
+        block = PayloadGenerator('random', block_size=256 * 1024).next_block().tobytes()
+        self.assertGreater(compression_ratio(block), 0.99)
+
+    def test_compressible_ratio(self):
+        generator = PayloadGenerator('compressible', block_size=256 * 1024, compress_ratio=0.75)
+        ratio = compression_ratio(generator.next_block().tobytes())
+        self.assertGreater(ratio, 0.2)
+        self.assertLess(ratio, 0.35)
+
+    def test_sectors_are_unique_across_blocks(self):
+        """Every sector must differ so block-level dedup finds nothing"""
+        generator = PayloadGenerator('random', block_size=64 * 1024)
+        sectors = set()
+        for _ in range(4):
+            block = generator.next_block().tobytes()
+            for offset in range(0, len(block), SECTOR_SIZE):
+                sectors.add(block[offset:offset + SECTOR_SIZE])
+        self.assertEqual(len(sectors), 4 * 64 * 1024 // SECTOR_SIZE)
+
+    def test_invalid_arguments(self):
+        with self.assertRaises(ValueError):
+            PayloadGenerator('bogus')
+        with self.assertRaises(ValueError):
+            PayloadGenerator('random', block_size=1000)
+        with self.assertRaises(ValueError):
+            PayloadGenerator('compressible', compress_ratio=1.5)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,254 @@
+"""
+Unit tests for the binary run format and the offline report generator
+"""
+
+import unittest
+import sys
+import os
+import csv
+import json
+import struct
+import tempfile
+
+import numpy as np
+
+# Add parent directory to path
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+from host_benchmark import memcpy_crossovers
+from monitoring import Monitor
+from report import Decimator, MetricStats, decimate, generate_report, load_run, lttb
+from runfile import BLOCK_HEADER, FOOTER, RunFile, RunReader, RunWriter
+
+
+class TestRunFile(unittest.TestCase):
+    """Round trip through the binary run format"""
+
+    def test_round_trip(self):
+        with tempfile.TemporaryDirectory() as tmp:
+            path = os.path.join(tmp, 'run.hsrun')
+            writer = RunWriter(path, ['cpu', 'ram'], block_rows=4)
+            for i in range(10):
+                writer.write(100.0 + i, {'cpu': float(i), 'ram': None if i == 5 else 50.0})
+            writer.close({'events': [{'timestamp': 105.0, 'type': 'gap', 'seconds': 3}]})
+
+            # The native reader when built, and the Python fallback without it
+            for build_dir in ('build', os.path.join(tmp, 'no-build')):
+                run = RunFile(path, build_dir)
+                self.assertEqual(run.metrics, ['cpu', 'ram'])
+                self.assertEqual(run.rows, 10)
+                self.assertEqual(run.block_count, 3)
+                self.assertEqual(run.time_range(), (100.0, 109.0))
+                self.assertEqual(run.meta['events'][0]['seconds'], 3)
+                timestamps = np.concatenate([t for t, _ in run.blocks()])
+                ram = np.concatenate([c['ram'] for _, c in run.blocks()])
+                np.testing.assert_array_equal(timestamps, np.arange(100.0, 110.0))
+                self.assertTrue(np.isnan(ram[5]))
+                run.close()
+
+    def test_rejects_corrupt_offsets(self):
+        with tempfile.TemporaryDirectory() as tmp:
+            path = os.path.join(tmp, 'run.hsrun')
+            writer = RunWriter(path, ['cpu'], block_rows=8)
+            for i in range(8):
+                writer.write(100.0 + i, {'cpu': float(i)})
+            writer.close({})
+            with open(path, 'rb') as f:
+                data = bytearray(f.read())
+            index_offset, blocks, meta_offset, end = FOOTER.unpack_from(data, len(data) - FOOTER.size)
+            corruptions = [
+                # index_offset + blocks * entry size wraps past 2^64
+                FOOTER.pack(2 ** 64 - 16, 1, meta_offset, end),
+                FOOTER.pack(index_offset, 2 ** 32, meta_offset, end),
+                FOOTER.pack(index_offset, 2 ** 61, meta_offset, end),
+            ]
+            for footer in corruptions:
+                with open(path, 'wb') as f:
+                    f.write(data[:-FOOTER.size] + footer)
+                for build_dir in ('build', os.path.join(tmp, 'no-build')):
+                    with self.assertRaises(ValueError):
+                        RunFile(path, build_dir)
+            # rows * columns * 8 wraps to 0: a block header claiming 2^31 rows of 2^30 columns
+            block = data[:]
+            offset = int(np.frombuffer(block, dtype='<u8', count=1, offset=index_offset)[0])
+            BLOCK_HEADER.pack_into(block, offset, 2 ** 31, 2 ** 30)
+            struct.pack_into('<I', block, index_offset + 8, 2 ** 31)
+            with open(path, 'wb') as f:
+                f.write(block)
+            for build_dir in ('build', os.path.join(tmp, 'no-build')):
+                with self.assertRaises(ValueError):
+                    RunFile(path, build_dir)
+
+
+class TestRunReader(unittest.TestCase):
+    """Native time-range reader over the same format"""
+
+    def setUp(self):
+        self.tmp = tempfile.TemporaryDirectory()
+        self.path = os.path.join(self.tmp.name, 'run.hsrun')
+        writer = RunWriter(self.path, ['cpu', 'ram'], block_rows=100)
+        for i in range(1000):
+            writer.write(1000.0 + i, {'cpu': float(i), 'ram': 2.0 * i})
+        writer.close({})
+        try:
+            self.reader = RunReader(self.path)
+        except FileNotFoundError as e:
+            self.skipTest(f"Failed to load native library: {e}")
+
+    def tearDown(self):
+        self.tmp.cleanup()
+
+    def test_seek_touches_only_overlapping_blocks(self):
+        self.assertEqual(self.reader.rows, 1000)
+        self.assertEqual(self.reader.time_range, (1000.0, 1999.0))
+        segments = self.reader.read(1250.0, 1420.5, metrics=['ram'])
+        self.assertEqual(len(segments), 3)
+        self.assertEqual(list(segments[0][1]), ['ram'])
+        t, columns = self.reader.read_range(1250.0, 1420.5, metrics=['ram'])
+        np.testing.assert_array_equal(t, np.arange(1250.0, 1421.0))
+        np.testing.assert_array_equal(columns['ram'], 2.0 * np.arange(250.0, 421.0))
+        self.assertEqual(self.reader.read(5000.0, 6000.0), [])
+
+    def test_views_are_zero_copy_and_outlive_reader(self):
+        t, columns = self.reader.read_range(1310.0, 1320.0)
+        self.assertFalse(t.flags.owndata)
+        self.assertFalse(columns['cpu'].flags.writeable)
+        del self.reader
+        self.assertEqual(columns['cpu'][0], 310.0)
+
+    def test_rejects_truncated_file(self):
+        with open(self.path, 'r+b') as f:
+            f.truncate(os.path.getsize(self.path) - 8)
+        with self.assertRaises(OSError):
+            RunReader(self.path)
+
+
+class TestDecimation(unittest.TestCase):
+    """LTTB and streaming statistics"""
+
+    def test_lttb_keeps_endpoints_and_peaks(self):
+        t = np.arange(10000, dtype=float)
+        y = np.zeros(10000)
+        y[4321] = 100.0
+        dt, dy = lttb(t, y, 100)
+        self.assertEqual(len(dt), 100)
+        self.assertEqual((dt[0], dt[-1]), (0.0, 9999.0))
+        self.assertEqual(dy.max(), 100.0)
+
+    def test_gaps_break_the_series(self):
+        y = np.concatenate([np.ones(500), [np.nan], np.ones(500)])
+        _, dy = decimate(np.arange(1001, dtype=float), y, 50)
+        self.assertEqual(int(np.isnan(dy).sum()), 1)
+
+    def test_decimator_memory_is_bounded(self):
+        decimator = Decimator(cap=100)
+        for start in range(0, 100000, 1000):
+            t = np.arange(start, start + 1000, dtype=float)
+            decimator.add(t, t)
+        t, y = decimator.series()
+        self.assertLessEqual(len(t), 202)
+        self.assertAlmostEqual(t[0], y[0])
+
+    def test_decimator_keeps_spikes(self):
+        decimator = Decimator(cap=100)
+        y = np.full(100000, 50.0)
+        y[31337], y[77777] = 100.0, 0.0
+        y[50000] = np.nan
+        for start in range(0, len(y), 1000):
+            decimator.add(np.arange(start, start + 1000, dtype=float), y[start:start + 1000])
+        t, dy = decimator.series()
+        self.assertLessEqual(len(t), 202)
+        self.assertEqual((np.nanmax(dy), np.nanmin(dy)), (100.0, 0.0))
+        self.assertTrue(np.isnan(dy).any())
+        self.assertTrue((np.diff(t) >= 0).all())
+
+    def test_streaming_stats_match_numpy(self):
+        values = np.random.default_rng(3).normal(10, 2, 50000)
+        stats = MetricStats()
+        for chunk in np.array_split(values, 7):
+            stats.add(chunk)
+        self.assertAlmostEqual(stats.mean, values.mean(), places=9)
+        self.assertAlmostEqual(stats.std, values.std(), places=9)
+        self.assertEqual(stats.max, values.max())
+        self.assertAlmostEqual(stats.quantile(0.5), np.median(values), delta=0.1)
+
+
+class TestReport(unittest.TestCase):
+    """End-to-end report from a CSV export with a resume gap"""
+
+    def test_csv_report(self):
+        with tempfile.TemporaryDirectory() as tmp:
+            path = os.path.join(tmp, 'run.csv')
+            with open(path, 'w', newline='') as f:
+                writer = csv.writer(f)
+                writer.writerow(['time', 'cpu', 'ram', 'disk', 'net_sent', 'net_recv'])
+                writer.writerow(['23:59:58', 10, 20, 30, 0, 0])
+                writer.writerow(['23:59:59', 90, 20, 30, 100, 100])
+                writer.writerow(['00:00:30', '', '', '', '', ''])
+                writer.writerow(['00:00:31', 50, 20, 30, 5, 5])
+            output = os.path.join(tmp, 'run.html')
+            summary = generate_report(path, output)
+            self.assertEqual(len(summary.phases), 2)
+            self.assertEqual(summary.last - summary.first, 33)
+            self.assertEqual(summary.overall['cpu'].max, 90)
+            with open(output) as f:
+                page = f.read()
+            self.assertIn('<svg', page)
+            self.assertIn('Phases', page)
+
+    def test_legacy_list_json(self):
+        # The checked-in run.json is the list-form export from before the run metadata
+        path = os.path.join(os.path.dirname(os.path.dirname(os.path.abspath(__file__))), 'run.json')
+        with tempfile.TemporaryDirectory() as tmp:
+            output = os.path.join(tmp, 'run.html')
+            summary = generate_report(path, output)
+            self.assertGreater(summary.samples, 0)
+            self.assertIn('cpu', summary.overall)
+            with open(output) as f:
+                self.assertIn('<svg', f.read())
+
+    def test_streamed_json_export(self):
+        with tempfile.TemporaryDirectory() as tmp:
+            monitor = Monitor()
+            for i in range(10):
+                stat = {'time': f'00:00:{i:02d}', 'timestamp': 1000.0 + i, 'cpu': float(i), 'ram': 50.0,
+                        'disk': 10.0, 'net_sent': 1000 * i, 'net_recv': 2000 * i}
+                monitor._record(stat, {'time': stat['time'], 'socket': {}, 'node': {}})
+            monitor.results['disk'] = {'summary': 'ok'}
+            path = os.path.join(tmp, 'run.json')
+            monitor.export_json(path)
+            meta, chunks = load_run(path)
+            self.assertEqual(meta['time_range'], (1000.0, 1009.0))
+            self.assertEqual(meta['results']['disk']['summary'], 'ok')
+            self.assertNotIn('samples', meta)
+            rows = sum(len(timestamps) for timestamps, _ in chunks)
+            self.assertEqual(rows, 10)
+            summary = generate_report(path, os.path.join(tmp, 'run.html'))
+            self.assertEqual(summary.overall['cpu'].max, 9.0)
+
+    def test_json_after_leading_whitespace(self):
+        with tempfile.TemporaryDirectory() as tmp:
+            path = os.path.join(tmp, 'run.json')
+            with open(path, 'w') as f:
+                f.write('\n' * 16 + json.dumps([{'time': '10:00:00', 'cpu': 10}, {'time': '10:00:02', 'cpu': 30}]))
+            summary = generate_report(path, os.path.join(tmp, 'run.html'))
+            self.assertEqual(summary.overall['cpu'].max, 30)
+
+    def test_memcpy_fastest_after_json_round_trip(self):
+        points = [{'alignment': 'aligned', 'size': 64, 'impl': 'libc', 'gb_s': 5.0},
+                  {'alignment': 'aligned', 'size': 64, 'impl': 'rep_movsb', 'gb_s': 3.0}]
+        memcpy = {'points': points, 'crossovers': memcpy_crossovers(points), 'summary': ''}
+        with tempfile.TemporaryDirectory() as tmp:
+            path = os.path.join(tmp, 'run.json')
+            with open(path, 'w') as f:
+                json.dump({'results': {'memcpy': memcpy},
+                           'samples': [{'timestamp': 100.0, 'cpu': 10}, {'timestamp': 101.0, 'cpu': 20}]}, f)
+            output = os.path.join(tmp, 'run.html')
+            generate_report(path, output)
+            with open(output) as f:
+                page = f.read()
+            self.assertIn('<td>aligned</td><td>64</td><td>5.00</td><td>3.00</td><td>libc</td>', page)
+
+
+if __name__ == '__main__':
+    unittest.main()
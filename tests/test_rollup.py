@@ -0,0 +1,60 @@
+"""
+Unit tests for multi-resolution monitoring rollups
+"""
+
+import unittest
+import sys
+import os
+import json
+
+# Add parent directory to path
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+from rollup import RollupTier, Rollups
+
+
+class TestRollups(unittest.TestCase):
+    """Incremental min/max/mean/count tiers"""
+
+    def test_bucket_aggregates(self):
+        tier = RollupTier(10, 100)
+        for t, value in ((100.0, 1.0), (104.0, 5.0), (109.9, 3.0), (110.0, 7.0)):
+            tier.add(t, {'cpu': value, 'temp': None})
+        series = tier.series('cpu')
+        self.assertEqual(series['time'], [100.0, 110.0])
+        self.assertEqual(series['min'], [1.0, 7.0])
+        self.assertEqual(series['max'], [5.0, 7.0])
+        self.assertEqual(series['mean'], [3.0, 7.0])
+        self.assertEqual(series['count'], [3, 1])
+        self.assertEqual(tier.series('temp')['time'], [])
+
+    def test_retention_bounds_memory(self):
+        tier = RollupTier(1, 60)
+        for t in range(1000):
+            tier.add(float(t), {'cpu': 1.0})
+        self.assertEqual(len(tier.buckets), 60)
+        self.assertEqual(tier.span(), 60)
+
+    def test_picks_finest_tier_within_budget(self):
+        rollups = Rollups()
+        for t in range(0, 7200, 2):
+            rollups.add(float(t), {'cpu': float(t % 100)})
+        # The 1 s tier only keeps an hour, so two hours come from the 10 s tier
+        self.assertEqual(rollups.tier_for(7200, 1000).resolution, 10)
+        self.assertEqual(rollups.tier_for(600, 1000).resolution, 1)
+        self.assertEqual(rollups.tier_for(7200, 200).resolution, 60)
+        series = rollups.series('cpu', max_points=1000, span=600)
+        self.assertEqual(len(series['time']), 300)  # one sample every 2 s
+
+    def test_serialization(self):
+        rollups = Rollups()
+        for t in range(120):
+            rollups.add(float(t), {'cpu': float(t)})
+        restored = Rollups.from_dict(json.loads(json.dumps(rollups.to_dict())))
+        self.assertEqual(restored.tiers[2].series('cpu'), rollups.tiers[2].series('cpu'))
+        restored.add(120.0, {'cpu': 0.0})
+        self.assertEqual(restored.tiers[2].series('cpu')['count'], [60, 60, 1])
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,105 @@
+"""
+Unit tests for soak-mode checkpoints and resumable monitoring
+"""
+
+import unittest
+import sys
+import os
+import json
+import tempfile
+
+# Add parent directory to path
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+from monitoring import Monitor
+from soak import load_checkpoint, merge_results, spill_path, write_checkpoint
+
+
+def sample(i, cpu):
+    stat = {'time': f'00:00:{i:02d}', 'timestamp': 1000.0 + i, 'cpu': cpu, 'ram': 50.0, 'disk': 10.0,
+            'net_sent': 1000 * i, 'net_recv': 2000 * i}
+    domains = {'time': stat['time'], 'socket': {0: {'cpu': cpu, 'cpu_max': cpu}},
+               'node': {0: {'cpu': cpu, 'cpu_max': cpu, 'total_kb': 100, 'used_kb': 25,
+                            'local_pages': 10 * i, 'remote_pages': i}}}
+    return stat, domains
+
+
+class TestSoak(unittest.TestCase):
+    """Checkpoint, crash and resume of the monitor's samples and totals"""
+
+    def setUp(self):
+        self.tmp = tempfile.TemporaryDirectory()
+        self.checkpoint = os.path.join(self.tmp.name, 'run.ckpt')
+
+    def tearDown(self):
+        self.tmp.cleanup()
+
+    def test_checkpoint_round_trip(self):
+        write_checkpoint(self.checkpoint, {'duration': 60}, {'segment': 2, 'elapsed_s': 12.5}, {'totals': {}},
+                         {'disk': {'summary': 'x'}})
+        state = load_checkpoint(self.checkpoint)
+        self.assertEqual(state['position'], {'segment': 2, 'elapsed_s': 12.5})
+        self.assertEqual(state['args'], {'duration': 60})
+        self.assertFalse(os.path.exists(self.checkpoint + '.tmp'))
+
+    def test_merges_results_across_segments(self):
+        carried = {
+            'disk': {'rounds': [{'round': 1, 'iops': 100}, {'round': 2, 'iops': 90}], 'summary': 'first'},
+            'ipc': {'points': [{'size': 64}], 'summary': 'ipc'},
+            'sched_latency': {'samples': 10, 'summary': 'old'},
+        }
+        current = {
+            'disk': {'rounds': [{'round': 1, 'iops': 80}], 'summary': 'second'},
+            'sched_latency': {'samples': 25, 'summary': 'total'},
+        }
+        merged = merge_results(carried, current)
+        self.assertEqual([r['round'] for r in merged['disk']['rounds']], [1, 2, 3])
+        self.assertEqual(merged['disk']['summary'], 'segment 1: first; segment 2: second')
+        self.assertEqual(merged['ipc'], carried['ipc'])
+        self.assertEqual(merged['sched_latency']['samples'], 25)
+        third = merge_results(merged, {'disk': {'rounds': [], 'summary': 'third'}})
+        self.assertEqual(third['disk']['segment_summaries'], ['first', 'second', 'third'])
+
+    def test_rejects_other_versions(self):
+        for version in (0, 1):
+            with open(self.checkpoint, 'w') as f:
+                json.dump({'version': version}, f)
+            with self.assertRaises(ValueError):
+                load_checkpoint(self.checkpoint)
+
+    def test_spill_keeps_memory_flat(self):
+        monitor = Monitor(spill_path=spill_path(self.checkpoint))
+        for i in range(5):
+            monitor._record(*sample(i, 50.0))
+        monitor.spill()
+        self.assertEqual(monitor.stats, [])
+        self.assertEqual(len(list(monitor.iter_samples())), 5)
+        self.assertEqual(monitor.totals['samples'], 5)
+        self.assertEqual(monitor.totals['net_sent'], 4000)
+
+    def test_resume_after_crash(self):
+        monitor = Monitor(spill_path=spill_path(self.checkpoint))
+        for i in range(3):
+            monitor._record(*sample(i, 100.0))
+        state = json.loads(json.dumps(monitor.checkpoint_state()))
+        monitor._record(*sample(3, 0.0))
+        monitor.spill()  # spilled after the checkpoint, then the host went down
+
+        resumed = Monitor(spill_path=spill_path(self.checkpoint))
+        resumed.restore_state(state, gap_seconds=30.0)
+        resumed._record(*sample(0, 0.0))
+        samples = [stat for stat, _ in resumed.iter_samples()]
+        self.assertEqual(len(samples), 5)
+        self.assertEqual(samples[3]['gap_s'], 30.0)
+        self.assertIsNone(samples[3]['cpu'])
+        self.assertEqual(resumed.totals['samples'], 4)
+        self.assertAlmostEqual(resumed.totals['sum']['cpu'], 300.0)
+        # Counters restart after the gap instead of producing a negative delta
+        self.assertEqual(resumed.totals['net_sent'], 2000)
+        node = resumed.domain_summary()['node']['0']
+        self.assertAlmostEqual(node['cpu_avg'], 75.0)
+        self.assertAlmostEqual(node['remote_alloc_percent'], 100.0 / 11)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -0,0 +1,150 @@
+"""
+Unit tests for disk benchmarking helpers
+"""
+
+import unittest
+import sys
+import os
+import tempfile
+
+# Add parent directory to path
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+from payloads import PayloadGenerator
+from storage import (RandomWriter, check_io_size, detect_steady_state, device_in_use, logical_block_size, open_target,
+                     sequential_fill)
+
+
+class TestSteadyState(unittest.TestCase):
+    """Unit tests for SNIA-style steady-state detection"""
+
+    def test_needs_full_window(self):
+        self.assertIsNone(detect_steady_state([100, 100, 100, 100]))
+
+    def test_flat_series_is_steady(self):
+        average = detect_steady_state([500, 90000, 100, 102, 98, 101, 99])
+        self.assertAlmostEqual(average, 100.0)
+
+    def test_falling_series_is_not_steady(self):
+        """An SSD falling off its SLC cache cliff must not count as steady"""
+        self.assertIsNone(detect_steady_state([120, 115, 110, 105, 100]))
+
+    def test_noisy_series_is_not_steady(self):
+        self.assertIsNone(detect_steady_state([100, 130, 100, 130, 100]))
+
+
+class TestRandomWriter(unittest.TestCase):
+    """Unit tests for the random-write round driver"""
+
+    def test_round_stays_within_region(self):
+        size = 1024 * 1024
+        generator = PayloadGenerator('random', block_size=64 * 1024)
+        with tempfile.NamedTemporaryFile() as f:
+            sequential_fill(f.fileno(), size, generator)
+            writer = RandomWriter(f.fileno(), size, generator)
+            ios, elapsed = writer.run_round(0.1)
+            self.assertGreater(ios, 0)
+            self.assertGreater(elapsed, 0.0)
+            self.assertEqual(os.fstat(f.fileno()).st_size, size)
+
+
+class TestDiskTarget(unittest.TestCase):
+    """Unit tests for target preallocation and reuse"""
+
+    def setUp(self):
+        self.tmpdir = tempfile.TemporaryDirectory()
+        self.path = os.path.join(self.tmpdir.name, 'target.bin')
+
+    def tearDown(self):
+        self.tmpdir.cleanup()
+
+    def test_preallocates_without_writing(self):
+        target = open_target(self.path, 64 * 1024 * 1024)
+        try:
+            self.assertFalse(target.reused)
+            self.assertEqual(os.fstat(target.fd).st_size, 64 * 1024 * 1024)
+        finally:
+            target.close()
+
+    def test_reuses_existing_target(self):
+        open_target(self.path, 1024 * 1024).close()
+        target = open_target(self.path, 1024 * 1024)
+        target.close()
+        self.assertTrue(target.reused)
+        whole = open_target(self.path, 0)
+        whole.close()
+        self.assertEqual(whole.size_bytes, 1024 * 1024)
+
+    def test_io_size_must_match_block_size(self):
+        block = logical_block_size(self.path)
+        check_io_size(self.path, block, 4 * 1024 * 1024)
+        for io_size in (0, 6000, block + block // 2):
+            with self.assertRaises(ValueError):
+                check_io_size(self.path, io_size, 4 * 1024 * 1024)
+        with self.assertRaises(ValueError):
+            check_io_size(self.path, 3 * block, 4 * 1024 * 1024)
+
+    def test_block_size_of_backing_device(self):
+        st = os.stat(self.tmpdir.name)  # the target does not exist yet
+        sys_dev = os.path.join(self.tmpdir.name, 'dev')
+        self.assertEqual(logical_block_size(self.path, sys_dev), 512)
+        disk = os.path.join(sys_dev, 'disk')
+        os.makedirs(os.path.join(disk, 'queue'))
+        with open(os.path.join(disk, 'queue', 'logical_block_size'), 'w') as f:
+            f.write('4096\n')
+        # The file lives on a partition, whose queue is its disk's
+        os.makedirs(os.path.join(disk, 'part'))
+        os.symlink(os.path.join(disk, 'part'), os.path.join(sys_dev, f'{os.major(st.st_dev)}:{os.minor(st.st_dev)}'))
+        self.assertEqual(logical_block_size(self.path, sys_dev), 4096)
+
+    def test_raw_device_requires_confirmation(self):
+        devices = [os.path.join('/dev', d) for d in ('loop0', 'sda', 'vda', 'nvme0n1')]
+        devices = [d for d in devices if os.path.exists(d)]
+        if not devices:
+            self.skipTest("No block device available")
+        with self.assertRaises(PermissionError):
+            open_target(devices[0], 1024 * 1024)
+
+
+class TestDeviceInUse(unittest.TestCase):
+    """Unit tests for the raw-device safety check against fake sysfs/procfs trees"""
+
+    def setUp(self):
+        self.tmpdir = tempfile.TemporaryDirectory()
+        self.sys_block = os.path.join(self.tmpdir.name, 'block')
+        self.proc = os.path.join(self.tmpdir.name, 'proc')
+        for d in ('sdz/holders', 'sdz/sdz1/holders', 'sdz1/holders'):
+            os.makedirs(os.path.join(self.sys_block, d))
+        open(os.path.join(self.sys_block, 'sdz', 'sdz1', 'partition'), 'w').close()
+        os.makedirs(self.proc)
+        self.write_proc('mounts', 'proc /proc proc rw 0 0\n')
+        self.write_proc('swaps', 'Filename Type Size Used Priority\n')
+
+    def tearDown(self):
+        self.tmpdir.cleanup()
+
+    def write_proc(self, name, text):
+        with open(os.path.join(self.proc, name), 'w') as f:
+            f.write(text)
+
+    def check(self):
+        return device_in_use('/dev/sdz', self.sys_block, self.proc)
+
+    def test_free_device(self):
+        self.assertIsNone(self.check())
+
+    def test_mounted_partition(self):
+        self.write_proc('mounts', '/dev/sdz1 /mnt ext4 rw 0 0\n')
+        self.assertIn('mounted', self.check())
+
+    def test_swap_partition(self):
+        self.write_proc('swaps', 'Filename Type Size Used Priority\n/dev/sdz1 partition 1024 0 -2\n')
+        self.assertIn('swap', self.check())
+
+    def test_held_partition(self):
+        os.makedirs(os.path.join(self.sys_block, 'sdz1', 'holders', 'dm-0'))
+        self.assertIn('dm-0', self.check())
+
+
+if __name__ == '__main__':
+    unittest.main()
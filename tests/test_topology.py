@@ -0,0 +1,93 @@
+"""
+Unit tests for topology parsing and per-domain aggregation
+"""
+
+import unittest
+import sys
+import os
+import tempfile
+from collections import namedtuple
+
+# Add parent directory to path
+sys.path.insert(0, os.path.dirname(os.path.dirname(os.path.abspath(__file__))))
+
+from topology import (Topology, aggregate_per_cpu, format_cpulist, parse_cpulist,
+                      read_node_memory, read_socket_temperatures)
+
+Sensor = namedtuple('Sensor', 'label current')
+
+
+def write(path, text):
+    os.makedirs(os.path.dirname(path), exist_ok=True)
+    with open(path, 'w') as f:
+        f.write(text)
+
+
+class TestTopology(unittest.TestCase):
+    """Unit tests against a fake two-socket, two-node sysfs tree"""
+
+    def setUp(self):
+        self.tmp = tempfile.TemporaryDirectory()
+        root = self.root = self.tmp.name
+        write(os.path.join(root, 'cpu', 'online'), '0-3\n')
+        for cpu in range(4):
+            write(os.path.join(root, 'cpu', f'cpu{cpu}', 'topology', 'physical_package_id'), f'{cpu // 2}\n')
+        for node, cpus in ((0, '0-1'), (1, '2-3')):
+            write(os.path.join(root, 'node', f'node{node}', 'cpulist'), cpus + '\n')
+            write(os.path.join(root, 'node', f'node{node}', 'meminfo'),
+                  f'Node {node} MemTotal:        1000 kB\nNode {node} MemFree:          750 kB\n'
+                  f'Node {node} MemUsed:          250 kB\n')
+            write(os.path.join(root, 'node', f'node{node}', 'numastat'),
+                  'numa_hit 10\nnuma_miss 0\nlocal_node 90\nother_node 10\n')
+        write(os.path.join(root, 'node', 'online'), '0-1\n')
+
+    def tearDown(self):
+        self.tmp.cleanup()
+
+    def test_cpulist_round_trip(self):
+        self.assertEqual(parse_cpulist('0-3,8,10-11\n'), [0, 1, 2, 3, 8, 10, 11])
+        self.assertEqual(format_cpulist([11, 0, 1, 2, 3, 8, 10]), '0-3,8,10-11')
+
+    def test_domains(self):
+        topology = Topology.from_sysfs(self.root)
+        self.assertEqual(topology.domains('socket'), {0: [0, 1], 1: [2, 3]})
+        self.assertEqual(topology.domains('node'), {0: [0, 1], 1: [2, 3]})
+
+    def test_missing_numa_is_node_zero(self):
+        write(os.path.join(self.root, 'cpu', 'online'), '0-3\n')
+        for node in (0, 1):
+            os.remove(os.path.join(self.root, 'node', f'node{node}', 'cpulist'))
+        topology = Topology.from_sysfs(self.root)
+        self.assertEqual(topology.domains('node'), {0: [0, 1, 2, 3]})
+
+    def test_aggregate_per_cpu(self):
+        topology = Topology.from_sysfs(self.root)
+        per_cpu = {str(cpu): {'samples': 100, 'max_ns': 1000.0 * (cpu + 1), 'histogram_us': {}}
+                   for cpu in range(4)}
+        aggregated = aggregate_per_cpu(per_cpu, topology, 'socket')
+        self.assertEqual(aggregated['1'], {'cpus': 2, 'samples': 200, 'max_ns': 4000.0})
+
+    def test_aggregate_per_cpu_minima_and_means(self):
+        topology = Topology.from_sysfs(self.root)
+        per_cpu = {
+            '2': {'samples': 100, 'min_ns': 500.0, 'avg_ns': 1000.0, 'p99_ns': 3000.0, 'realtime': 1},
+            '3': {'samples': 300, 'min_ns': 700.0, 'avg_ns': 2000.0, 'p99_ns': 2000.0, 'realtime': 0},
+        }
+        aggregated = aggregate_per_cpu(per_cpu, topology, 'socket')['1']
+        self.assertEqual(aggregated['min_ns'], 500.0)
+        self.assertEqual(aggregated['avg_ns'], 1750.0)
+        self.assertEqual(aggregated['p99_ns'], 3000.0)
+        self.assertEqual(aggregated['realtime'], 0)
+
+    def test_node_memory(self):
+        memory = read_node_memory(self.root)
+        self.assertEqual(memory[1], {'total_kb': 1000, 'used_kb': 250, 'local_pages': 90, 'remote_pages': 10})
+
+    def test_socket_temperatures(self):
+        sensors = {'coretemp': [Sensor('Package id 0', 60.0), Sensor('Core 0', 65.0),
+                                Sensor('Package id 1', 80.0), Sensor('Core 0', 70.0)]}
+        self.assertEqual(read_socket_temperatures(sensors), {0: 65.0, 1: 80.0})
+
+
+if __name__ == '__main__':
+    unittest.main()
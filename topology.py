@@ -0,0 +1,189 @@
+"""
+CPU topology and per-domain aggregation
+Parses sockets and NUMA nodes from sysfs so monitoring samples and per-CPU
+stressor results can be summarized per socket and per node instead of only
+as host totals
+"""
+
+import os
+
+SYSFS_ROOT = '/sys/devices/system'
+DOMAIN_KINDS = ('socket', 'node')
+
+# Per-CPU result fields that are counts (summed across a domain); every other
+# numeric field is a latency or rate and reports the domain's worst CPU
+SUMMED_FIELDS = ('samples', 'overflows')
+MIN_FIELDS = ('min_ns', 'realtime')  # realtime: only if every CPU got SCHED_FIFO
+MEAN_FIELDS = ('avg_ns',)            # weighted by 'samples'
+
+
+def parse_cpulist(text):
+    """Parse a sysfs CPU list such as '0-3,8,10-11' into a sorted list of ints"""
+    cpus = []
+    for part in text.strip().split(','):
+        if not part:
+            continue
+        if '-' in part:
+            first, last = part.split('-')
+            cpus.extend(range(int(first), int(last) + 1))
+        else:
+            cpus.append(int(part))
+    return sorted(cpus)
+
+
+def format_cpulist(cpus):
+    """Inverse of parse_cpulist: [0, 1, 2, 3, 8] -> '0-3,8'"""
+    ranges = []
+    for cpu in sorted(cpus):
+        if ranges and cpu == ranges[-1][1] + 1:
+            ranges[-1][1] = cpu
+        else:
+            ranges.append([cpu, cpu])
+    return ','.join(str(a) if a == b else f'{a}-{b}' for a, b in ranges)
+
+
+def _read(path):
+    with open(path) as f:
+        return f.read().strip()
+
+
+class Topology:
+    """Mapping of CPUs to their socket (physical package) and NUMA node"""
+
+    def __init__(self, cpus):
+        """cpus: {cpu: {'socket': id, 'node': id}}"""
+        self.cpus = cpus
+
+    @classmethod
+    def from_sysfs(cls, root=SYSFS_ROOT):
+        """
+        Read the topology of the online CPUs
+        Machines without NUMA support in sysfs are reported as a single node 0
+        """
+        try:
+            online = parse_cpulist(_read(os.path.join(root, 'cpu', 'online')))
+        except OSError:
+            online = list(range(os.cpu_count() or 1))
+        node_of = {}
+        node_dir = os.path.join(root, 'node')
+        if os.path.isdir(node_dir):
+            for entry in os.listdir(node_dir):
+                if entry.startswith('node') and entry[4:].isdigit():
+                    try:
+                        for cpu in parse_cpulist(_read(os.path.join(node_dir, entry, 'cpulist'))):
+                            node_of[cpu] = int(entry[4:])
+                    except OSError:
+                        pass
+        cpus = {}
+        for cpu in online:
+            try:
+                socket = int(_read(os.path.join(root, 'cpu', f'cpu{cpu}', 'topology', 'physical_package_id')))
+            except (OSError, ValueError):
+                socket = 0
+            cpus[cpu] = {'socket': max(socket, 0), 'node': node_of.get(cpu, 0)}
+        return cls(cpus)
+
+    def domains(self, kind):
+        """{domain id: sorted CPU list} for kind 'socket' or 'node'"""
+        grouped = {}
+        for cpu, ids in sorted(self.cpus.items()):
+            grouped.setdefault(ids[kind], []).append(cpu)
+        return grouped
+
+    def group(self, per_cpu, kind):
+        """Split {cpu: value} into {domain id: [values]}; CPUs outside the topology are dropped"""
+        grouped = {}
+        for cpu, value in per_cpu.items():
+            ids = self.cpus.get(int(cpu))
+            if ids is not None:
+                grouped.setdefault(ids[kind], []).append(value)
+        return grouped
+
+    def to_dict(self):
+        return {f'{kind}s': {str(d): cpus for d, cpus in self.domains(kind).items()}
+                for kind in DOMAIN_KINDS}
+
+
+def aggregate_per_cpu(per_cpu, topology, kind):
+    """
+    Aggregate a stressor's per-CPU result dicts by domain
+    Count fields are summed, minima (and the realtime flag) take the smallest
+    value, averages are weighted by each CPU's sample count, and the remaining
+    numeric fields (maxima, percentile tails) keep the worst (largest) value
+    Returns: {domain id (str): aggregated dict with a 'cpus' count}
+    """
+    aggregated = {}
+    for domain, entries in topology.group(per_cpu, kind).items():
+        combined = {'cpus': len(entries)}
+        weighted = {}  # key -> [sum of value * weight, sum of weights]
+        for entry in entries:
+            for key, value in entry.items():
+                if not isinstance(value, (int, float)) or (isinstance(value, bool) and key not in MIN_FIELDS):
+                    continue
+                if key in SUMMED_FIELDS:
+                    combined[key] = combined.get(key, 0) + value
+                elif key in MIN_FIELDS:
+                    combined[key] = min(combined.get(key, value), value)
+                elif key in MEAN_FIELDS:
+                    weight = entry.get('samples') or 1
+                    total = weighted.setdefault(key, [0.0, 0])
+                    total[0] += value * weight
+                    total[1] += weight
+                else:
+                    combined[key] = max(combined.get(key, value), value)
+        for key, (value_sum, weight) in weighted.items():
+            combined[key] = value_sum / weight
+        aggregated[str(domain)] = combined
+    return aggregated
+
+
+def read_node_memory(root=SYSFS_ROOT):
+    """
+    Per-node memory use and NUMA allocation counters
+    Returns: {node: {'total_kb', 'used_kb', 'local_pages', 'remote_pages'}}; empty without NUMA sysfs
+    """
+    nodes = {}
+    node_dir = os.path.join(root, 'node')
+    if not os.path.isdir(node_dir):
+        return nodes
+    for entry in os.listdir(node_dir):
+        if not (entry.startswith('node') and entry[4:].isdigit()):
+            continue
+        stats = {}
+        try:
+            # Lines look like "Node 0 MemTotal:  5603064 kB"
+            for line in _read(os.path.join(node_dir, entry, 'meminfo')).splitlines():
+                fields = line.split()
+                if len(fields) >= 4 and fields[2] in ('MemTotal:', 'MemUsed:'):
+                    stats['total_kb' if fields[2] == 'MemTotal:' else 'used_kb'] = int(fields[3])
+            for line in _read(os.path.join(node_dir, entry, 'numastat')).splitlines():
+                name, value = line.split()
+                if name == 'local_node':
+                    stats['local_pages'] = int(value)
+                elif name == 'other_node':
+                    stats['remote_pages'] = int(value)
+        except (OSError, ValueError):
+            continue
+        nodes[int(entry[4:])] = stats
+    return nodes
+
+
+def read_socket_temperatures(sensors):
+    """
+    Hottest reading per socket from psutil.sensors_temperatures() output
+    coretemp lists each package's 'Package id N' entry before that package's
+    cores; other drivers report one device per socket in order
+    Returns: {socket: degrees C}
+    """
+    temps = {}
+    for driver, entries in sensors.items():
+        if driver == 'coretemp':
+            socket = 0
+            for entry in entries:
+                if entry.label.startswith('Package id'):
+                    socket = int(entry.label.split()[-1])
+                temps[socket] = max(temps.get(socket, entry.current), entry.current)
+        elif driver in ('k10temp', 'zenpower'):
+            for socket, entry in enumerate(e for e in entries if e.label in ('Tctl', '')):
+                temps[socket] = entry.current
+    return temps